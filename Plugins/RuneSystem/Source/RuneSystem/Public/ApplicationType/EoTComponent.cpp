@@ -3,6 +3,7 @@
 
 #include "EoTComponent.h"
 #include "RuneEffect.h"
+#include "RuneFilterCache.h"
 #include "TimerManager.h"
 
 
@@ -37,6 +38,7 @@ void UEoTComponent::BeginPlay()
 	{
 		UActorComponent* component = GetOwner()->AddComponentByClass(runeEffectClass, false, FTransform::Identity, false);
 		runeEffect = Cast<URuneEffect>(component);
+		FRuneFilterCache::Get().InvalidateActor(*GetOwner());
 	}
 
 	if (runeEffect == nullptr)
@@ -65,6 +67,37 @@ void UEoTComponent::BeginPlay()
 	GetOwner()->GetWorldTimerManager().SetTimer(_timeHandle, this, &UEoTComponent::ApplyTickEffect, _timePerTick, true, inicialDelay);
 }
 
+void UEoTComponent::OnRegister()
+{
+	Super::OnRegister();
+
+	if (AActor* owner = GetOwner())
+	{
+		FRuneFilterCache::Get().InvalidateActor(*owner);
+	}
+}
+
+void UEoTComponent::OnUnregister()
+{
+	if (AActor* owner = GetOwner())
+	{
+		FRuneFilterCache::Get().InvalidateActor(*owner);
+	}
+
+	Super::OnUnregister();
+}
+
+void UEoTComponent::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+
+	// the applied effect is a copy owned by the component
+	if (CumulativeResourceSize.GetResourceSizeMode() == EResourceSizeMode::EstimatedTotal && runeEffect != nullptr && runeEffect->GetOuter() == this)
+	{
+		runeEffect->GetResourceSizeEx(CumulativeResourceSize);
+	}
+}
+
 //void UEoTComponent::Configure(const TSubclassOf<URuneEffect>& inEffectClass, AActor* instigator, uint32 inTicks, float inDuration, bool inTrimTickDistribution, float inTickRate)
 //{
 //	if (_timeHandle.IsValid())
@@ -93,7 +126,7 @@ void UEoTComponent::Configure(URuneEffect* inEffect, AController* instigator, ui
 	runeEffectClass = nullptr;
 	_instigator = instigator;
 	// Copy rune effect instance so that it stays alive all duration
-	runeEffect = DuplicateObject<URuneEffect>(inEffect, this);
+	runeEffect = inEffect != nullptr ? inEffect->DuplicateEffect(this) : nullptr;
 	ticks = inTicks;
 	duration = inDuration;
 	trimTickDistribution = inTrimTickDistribution;
@@ -124,7 +157,10 @@ void UEoTComponent::ApplyTickEffect()
 	}
 
 	//UE_LOG(LogTemp, Display, TEXT("[EoTComponent] EoT effect applied"));
-	runeEffect->ApplyEffectInstant(_instigator, _instigator, actor);
+	{
+		RUNE_SCOPE_COST(runeEffect->costOwner, EFFECT_APPLY);
+		runeEffect->ApplyEffectInstant(_instigator, _instigator, actor);
+	}
 	--_remainingTicks;
 
 	// check if it is the last tick
@@ -9,6 +9,11 @@
 
 class URuneEffect;
 
+/**
+ * Applies an effect over time to its owner.
+ * Rune effects use the UEoTSubsystem instead, this component is
+ * kept for effects over time set up by hand.
+ */
 UCLASS(ClassGroup = (Custom), Blueprintable, meta = (BlueprintSpawnableComponent, DisplayName = "EoT Component"))
 class RUNESYSTEM_API UEoTComponent : public UActorComponent
 {
@@ -22,7 +27,14 @@ protected:
 	// Called when the game starts
 	virtual void BeginPlay() override;
 
+	// Called when the component gets registered/unregistered, invalidating owner's cached filter verdicts
+	virtual void OnRegister() override;
+	virtual void OnUnregister() override;
+
 public:
+	// Adds the memory of the applied effect copy when estimating the total
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+
 	//void Configure(const TSubclassOf<URuneEffect>& effectClass, AActor* instigator, uint32 ticks = 5, float duration = 5.0f, bool trimTickDistribution = true, float tickRate = 0.5f);
 	void Configure(URuneEffect* effect, AController* instigator, uint32 ticks = 5, float duration = 5.0f, bool trimTickDistribution = true, float tickRate = 0.5f);
 	UFUNCTION()
@@ -0,0 +1,230 @@
+
+
+#include "EoTSubsystem.h"
+#include "RuneEffect.h"
+#include "RuneSharedEffectsSubsystem.h"
+#include "Utils/RuneStats.h"
+#include "Engine/World.h"
+#include "GameFramework/Controller.h"
+
+
+UEoTSubsystem::UEoTSubsystem() :
+	targets(),
+	effects(),
+	sourceEffects(),
+	instigators(),
+	causers(),
+	remainingTicks(),
+	nextFireTimes(),
+	timePerTicks(),
+	pendingRemovals(0),
+	isTicking(false)
+{
+}
+
+bool UEoTSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UEoTSubsystem::Deinitialize()
+{
+	targets.Empty();
+	effects.Empty();
+	sourceEffects.Empty();
+	instigators.Empty();
+	causers.Empty();
+	remainingTicks.Empty();
+	nextFireTimes.Empty();
+	timePerTicks.Empty();
+	pendingRemovals = 0;
+
+	Super::Deinitialize();
+}
+
+void UEoTSubsystem::Tick(float DeltaTime)
+{
+	RUNE_SCOPE_CYCLE_COUNTER(STAT_RuneEoTTick, "UEoTSubsystem::Tick");
+	RUNE_SCOPE_PROFILE_PHASE(EOT_TICK);
+
+	Super::Tick(DeltaTime);
+
+	const double now = GetWorld()->GetTimeSeconds();
+
+	// applications added while ticking will fire from the next tick on
+	isTicking = true;
+	const int32 num = targets.Num();
+	for (int32 i = 0; i < num; ++i)
+	{
+		if (remainingTicks[i] == 0 || nextFireTimes[i] > now) continue;
+
+		AActor* target = targets[i].Get();
+		URuneEffect* effect = effects[i];
+		if (target == nullptr || effect == nullptr)
+		{
+			MarkForRemoval(i);
+			continue;
+		}
+
+		// fire as many times as a looping timer would
+		AController* instigator = instigators[i].Get();
+		AActor* causer = causers[i].Get();
+		RUNE_SCOPE_COST(effect->costOwner, EFFECT_APPLY);
+		while (remainingTicks[i] != 0 && nextFireTimes[i] <= now)
+		{
+			effect->ApplyEffectInstant(instigator, causer, target);
+			--remainingTicks[i];
+			nextFireTimes[i] += timePerTicks[i];
+		}
+
+		// last tick, application has ended
+		if (remainingTicks[i] == 0)
+		{
+			MarkForRemoval(i);
+		}
+	}
+	isTicking = false;
+
+	Compact();
+}
+
+TStatId UEoTSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEoTSubsystem, STATGROUP_Tickables);
+}
+
+void UEoTSubsystem::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(
+		targets.GetAllocatedSize() + effects.GetAllocatedSize() + sourceEffects.GetAllocatedSize() + instigators.GetAllocatedSize() +
+		causers.GetAllocatedSize() + remainingTicks.GetAllocatedSize() + nextFireTimes.GetAllocatedSize() + timePerTicks.GetAllocatedSize());
+}
+
+bool UEoTSubsystem::AddEffectOverTime(URuneEffect& effect, AController* instigator, AActor* causer, AActor& target, uint32 ticks, float duration, bool trimTickDistribution, float tickRate)
+{
+	LLM_SCOPE_BYTAG(RuneSystem);
+
+	// If duration is set to a negative number the number of tick will be indefinite
+	float timePerTick = tickRate;
+	int32 ticksToApply = -1;
+	if (duration >= 0)
+	{
+		timePerTick = trimTickDistribution ? duration / (ticks - 1.0f) : duration / (ticks + 1.0f);
+		ticksToApply = ticks;
+	}
+
+	// a timer would never fire with a non positive rate
+	if (!(timePerTick > 0.0f) || ticksToApply == 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[EoTSubsystem] AddEffectOverTime(): '%s' has an invalid tick distribution."), *effect.GetName());
+		return false;
+	}
+
+	URuneSharedEffectsSubsystem* sharedEffectsSubsystem = GetWorld()->GetSubsystem<URuneSharedEffectsSubsystem>();
+	URuneEffect* sharedEffect = sharedEffectsSubsystem != nullptr ? sharedEffectsSubsystem->AcquireEffect(effect) : nullptr;
+	if (sharedEffect == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[EoTSubsystem] AddEffectOverTime(): '%s' could not be copied."), *effect.GetName());
+		return false;
+	}
+
+	const double initialDelay = trimTickDistribution ? 0.0 : timePerTick;
+	targets.Add(&target);
+	effects.Add(sharedEffect);
+	sourceEffects.Add(&effect);
+	instigators.Add(instigator);
+	causers.Add(causer);
+	remainingTicks.Add(ticksToApply);
+	nextFireTimes.Add(GetWorld()->GetTimeSeconds() + initialDelay);
+	timePerTicks.Add(timePerTick);
+
+	return true;
+}
+
+int32 UEoTSubsystem::RemoveEffectOverTime(const URuneEffect& effect, const AActor& target)
+{
+	const TObjectKey<URuneEffect> sourceEffect(&effect);
+	int32 removed = 0;
+	for (int32 i = 0; i < targets.Num(); ++i)
+	{
+		if (remainingTicks[i] == 0 || sourceEffects[i] != sourceEffect || targets[i].Get() != &target) continue;
+
+		MarkForRemoval(i);
+		++removed;
+	}
+
+	if (!isTicking)
+	{
+		Compact();
+	}
+
+	return removed;
+}
+
+int32 UEoTSubsystem::RemoveAllEffectsOverTime(const AActor& target)
+{
+	int32 removed = 0;
+	for (int32 i = 0; i < targets.Num(); ++i)
+	{
+		if (remainingTicks[i] == 0 || targets[i].Get() != &target) continue;
+
+		MarkForRemoval(i);
+		++removed;
+	}
+
+	if (!isTicking)
+	{
+		Compact();
+	}
+
+	return removed;
+}
+
+int32 UEoTSubsystem::GetNumEffectsOverTime() const
+{
+	return targets.Num() - pendingRemovals;
+}
+
+void UEoTSubsystem::MarkForRemoval(int32 index)
+{
+	if (remainingTicks[index] == 0 && targets[index] == nullptr)
+	{
+		return;
+	}
+
+	remainingTicks[index] = 0;
+	targets[index] = nullptr;
+	++pendingRemovals;
+}
+
+void UEoTSubsystem::Compact()
+{
+	if (pendingRemovals == 0)
+	{
+		return;
+	}
+
+	URuneSharedEffectsSubsystem* sharedEffectsSubsystem = GetWorld()->GetSubsystem<URuneSharedEffectsSubsystem>();
+	for (int32 i = targets.Num() - 1; i >= 0; --i)
+	{
+		if (remainingTicks[i] != 0 || targets[i] != nullptr) continue;
+
+		if (sharedEffectsSubsystem != nullptr)
+		{
+			sharedEffectsSubsystem->ReleaseEffect(sourceEffects[i], effects[i]);
+		}
+
+		targets.RemoveAtSwap(i, 1, false);
+		effects.RemoveAtSwap(i, 1, false);
+		sourceEffects.RemoveAtSwap(i, 1, false);
+		instigators.RemoveAtSwap(i, 1, false);
+		causers.RemoveAtSwap(i, 1, false);
+		remainingTicks.RemoveAtSwap(i, 1, false);
+		nextFireTimes.RemoveAtSwap(i, 1, false);
+		timePerTicks.RemoveAtSwap(i, 1, false);
+	}
+
+	pendingRemovals = 0;
+}
@@ -0,0 +1,119 @@
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "EoTSubsystem.generated.h"
+
+
+class URuneEffect;
+
+/**
+ * Owns every active effect over time (EoT) application of its world.
+ * 
+ * Applications are stored as a structure of arrays and advanced in a single
+ * batched tick, instead of adding an UEoTComponent and a timer per target.
+ * Effects follow FRuneSharedEffects: applications share the world's copy of
+ * their source effect, so that it stays alive all duration, and keep their own instigator and causer.
+ */
+UCLASS()
+class RUNESYSTEM_API UEoTSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this subsystem's properties
+	UEoTSubsystem();
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Deinitialize() override;
+
+	// Called every frame
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Adds the memory of the applications
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+
+public:
+	/**
+	 * Starts applying an effect over time to a target.
+	 * Follows the same tick distribution as UEoTComponent.
+	 *
+	 * @param effect Applied effect. It does not need to outlive the application.
+	 * @param instigator Controller that applied the effect
+	 * @param causer Actor which applied the effect
+	 * @param target Actor which will recieve the effect applications.
+	 * @param ticks How many times should the effect be applied. Only used with positive duration.
+	 * @param duration How much time - in seconds - should the effect last. If negative it will last until revertion.
+	 * @param trimTickDistribution Whether the ticks should be adjusted to the duration start-end interval.
+	 * @param tickRate Time window - in seconds - between ticks. Only used with negative duration.
+	 * @return If true, the application has been added
+	 */
+	bool AddEffectOverTime(URuneEffect& effect, AController* instigator, AActor* causer, AActor& target, uint32 ticks = 5, float duration = 5.0f, bool trimTickDistribution = true, float tickRate = 0.5f);
+
+	/**
+	 * Stops every application of an effect on a target.
+	 *
+	 * @param effect Effect that was applied
+	 * @param target Actor receiving the effect applications
+	 * @return Number of stopped applications
+	 */
+	int32 RemoveEffectOverTime(const URuneEffect& effect, const AActor& target);
+
+	/**
+	 * Stops every application on a target.
+	 *
+	 * @param target Actor receiving the effect applications
+	 * @return Number of stopped applications
+	 */
+	int32 RemoveAllEffectsOverTime(const AActor& target);
+
+	/**
+	 * Gets the number of active applications.
+	 *
+	 * @return Active applications
+	 */
+	int32 GetNumEffectsOverTime() const;
+
+private:
+	/** Flags an application to be removed in the next compaction */
+	void MarkForRemoval(int32 index);
+
+	/** Removes all flagged applications */
+	void Compact();
+
+private:
+	/** Target of each application. Null once removed */
+	TArray<TWeakObjectPtr<AActor>> targets;
+
+	/** Applied effect of each application, acquired from the world's URuneSharedEffectsSubsystem */
+	UPROPERTY()
+	TArray<TObjectPtr<URuneEffect>> effects;
+
+	/** Source effect of each application, used for revertion and for releasing the applied effect */
+	TArray<TObjectKey<URuneEffect>> sourceEffects;
+
+	/** Instigator of each application */
+	TArray<TWeakObjectPtr<AController>> instigators;
+
+	/** Causer of each application */
+	TArray<TWeakObjectPtr<AActor>> causers;
+
+	/** Remaining ticks of each application. If negative, it will never end on its own */
+	TArray<int32> remainingTicks;
+
+	/** World time - in seconds - at which each application fires next */
+	TArray<double> nextFireTimes;
+
+	/** Time window - in seconds - between ticks of each application */
+	TArray<float> timePerTicks;
+
+	/** Number of applications flagged for removal */
+	int32 pendingRemovals;
+
+	/** Whether applications are being ticked */
+	bool isTicking;
+};
@@ -0,0 +1,78 @@
+
+
+#include "RuneSharedEffects.h"
+#include "RuneEffect.h"
+
+
+URuneEffect* FRuneSharedEffects::Acquire(URuneEffect& effect, UObject* outer)
+{
+	// stateful effects are not shared, every application keeps its own state
+	if (effect.isStateful)
+	{
+		URuneEffect* copy = effect.DuplicateEffect(outer);
+		if (copy != nullptr)
+		{
+			copies.Add(copy);
+		}
+		return copy;
+	}
+
+	FSharedEffect* sharedEffect = sharedEffects.Find(&effect);
+	if (sharedEffect != nullptr && sharedEffect->effect != nullptr)
+	{
+		++sharedEffect->refCount;
+		return sharedEffect->effect;
+	}
+
+	// Copy rune effect instance so that it stays alive all duration
+	URuneEffect* copy = effect.DuplicateEffect(outer);
+	if (copy == nullptr)
+	{
+		return nullptr;
+	}
+
+	sharedEffects.Add(&effect, { copy, 1 });
+	copies.Add(copy);
+	return copy;
+}
+
+void FRuneSharedEffects::Release(const TObjectKey<URuneEffect>& sourceEffect, URuneEffect* acquiredEffect)
+{
+	FSharedEffect* sharedEffect = sharedEffects.Find(sourceEffect);
+	if (sharedEffect == nullptr || sharedEffect->effect != acquiredEffect)
+	{
+		// not shared, the copy was only used by its application
+		copies.Remove(acquiredEffect);
+		return;
+	}
+
+	if (--sharedEffect->refCount <= 0)
+	{
+		// GC will handle the destroy state of the copy
+		copies.Remove(sharedEffect->effect);
+		sharedEffects.Remove(sourceEffect);
+	}
+}
+
+void FRuneSharedEffects::Empty()
+{
+	sharedEffects.Empty();
+	copies.Empty();
+}
+
+void FRuneSharedEffects::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) const
+{
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(sharedEffects.GetAllocatedSize() + copies.GetAllocatedSize());
+
+	// copies are owned by the outer they were acquired with
+	if (CumulativeResourceSize.GetResourceSizeMode() == EResourceSizeMode::EstimatedTotal)
+	{
+		for (const TObjectPtr<URuneEffect>& copy : copies)
+		{
+			if (copy != nullptr)
+			{
+				copy->GetResourceSizeEx(CumulativeResourceSize);
+			}
+		}
+	}
+}
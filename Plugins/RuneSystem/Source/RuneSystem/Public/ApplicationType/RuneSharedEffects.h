@@ -0,0 +1,76 @@
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+#include "UObject/ResourceSize.h"
+#include "RuneSharedEffects.generated.h"
+
+
+class URuneEffect;
+
+/**
+ * Rune effects used by applications that may outlive the effect that was applied.
+ *
+ * Every application of a source effect shares a read-only template: a copy made the first time,
+ * owned by the outer given on acquisition (never by the caster) and kept alive until the last
+ * application releases it. Per-application data (instigator, causer...) is kept by the application.
+ * Effects with URuneEffect::isStateful set opt out: each acquisition gets its own copy.
+ *
+ * This is the single ownership policy of applied effects: tangible agents, effects over time
+ * (UEoTSubsystem) and statuses (UStatusSubsystem) all acquire their effects from the world's
+ * URuneSharedEffectsSubsystem.
+ */
+USTRUCT()
+struct RUNESYSTEM_API FRuneSharedEffects
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Gets the shared copy of an effect, creating it if needed.
+	 * Stateful effects get a new copy instead.
+	 *
+	 * @param effect Source effect
+	 * @param outer Outer of the created copy
+	 * @return Acquired copy. Must be released once per acquisition.
+	 */
+	URuneEffect* Acquire(URuneEffect& effect, UObject* outer);
+
+	/**
+	 * Releases an acquired copy of an effect, once no one uses it GC will destroy it.
+	 *
+	 * @param sourceEffect Source effect used to acquire the copy
+	 * @param acquiredEffect Copy returned on acquisition
+	 */
+	void Release(const TObjectKey<URuneEffect>& sourceEffect, URuneEffect* acquiredEffect);
+
+	/** Releases all copies */
+	void Empty();
+
+	/** Number of live copies */
+	int32 Num() const { return copies.Num(); }
+
+	/**
+	 * Adds the memory used to track the copies, and the memory of the copies when estimating the total.
+	 *
+	 * @param CumulativeResourceSize Resource size of the owner
+	 */
+	void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) const;
+
+private:
+	/** Shared copy of an effect and the number of applications using it */
+	struct FSharedEffect
+	{
+		URuneEffect* effect;
+		int32 refCount;
+	};
+
+	/** Shared copies per source effect */
+	TMap<TObjectKey<URuneEffect>, FSharedEffect> sharedEffects;
+
+	/** Keeps the copies alive */
+	UPROPERTY()
+	TSet<TObjectPtr<URuneEffect>> copies;
+};
@@ -0,0 +1,47 @@
+
+
+#include "RuneSharedEffectsSubsystem.h"
+#include "RuneEffect.h"
+#include "Utils/RuneStats.h"
+
+
+URuneSharedEffectsSubsystem::URuneSharedEffectsSubsystem() :
+	sharedEffects()
+{
+}
+
+bool URuneSharedEffectsSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void URuneSharedEffectsSubsystem::Deinitialize()
+{
+	sharedEffects.Empty();
+
+	Super::Deinitialize();
+}
+
+void URuneSharedEffectsSubsystem::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+
+	sharedEffects.GetResourceSizeEx(CumulativeResourceSize);
+}
+
+URuneEffect* URuneSharedEffectsSubsystem::AcquireEffect(URuneEffect& effect)
+{
+	LLM_SCOPE_BYTAG(RuneSystem);
+
+	return sharedEffects.Acquire(effect, this);
+}
+
+void URuneSharedEffectsSubsystem::ReleaseEffect(const TObjectKey<URuneEffect>& sourceEffect, URuneEffect* acquiredEffect)
+{
+	sharedEffects.Release(sourceEffect, acquiredEffect);
+}
+
+int32 URuneSharedEffectsSubsystem::GetNumEffects() const
+{
+	return sharedEffects.Num();
+}
@@ -0,0 +1,61 @@
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "RuneSharedEffects.h"
+#include "RuneSharedEffectsSubsystem.generated.h"
+
+
+class URuneEffect;
+
+/**
+ * Owns the effect copies used by the applications of its world
+ * that may outlive the applied effect, following FRuneSharedEffects.
+ */
+UCLASS()
+class RUNESYSTEM_API URuneSharedEffectsSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this subsystem's properties
+	URuneSharedEffectsSubsystem();
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Deinitialize() override;
+
+	// Adds the memory of the shared effects, and of the effect copies when estimating the total
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+
+public:
+	/**
+	 * Gets the copy of an effect used by a new application.
+	 *
+	 * @param effect Source effect. It does not need to outlive the application.
+	 * @return Acquired copy, owned by the subsystem. Must be released once the application ends.
+	 */
+	URuneEffect* AcquireEffect(URuneEffect& effect);
+
+	/**
+	 * Releases the copy of an effect used by an ended application.
+	 *
+	 * @param sourceEffect Source effect used to acquire the copy
+	 * @param acquiredEffect Copy returned on acquisition
+	 */
+	void ReleaseEffect(const TObjectKey<URuneEffect>& sourceEffect, URuneEffect* acquiredEffect);
+
+	/**
+	 * Gets the number of live effect copies.
+	 *
+	 * @return Live copies
+	 */
+	int32 GetNumEffects() const;
+
+private:
+	/** Effect copies per source effect */
+	UPROPERTY()
+	FRuneSharedEffects sharedEffects;
+};
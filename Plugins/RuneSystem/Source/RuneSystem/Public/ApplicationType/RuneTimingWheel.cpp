@@ -0,0 +1,189 @@
+
+
+#include "RuneTimingWheel.h"
+
+
+FRuneTimingWheel::FRuneTimingWheel() :
+	nodes(),
+	currentTick(0),
+	numScheduled(0)
+{
+	Reset();
+}
+
+void FRuneTimingWheel::Reset(uint64 tick)
+{
+	for (int32 slot = 0; slot < NumLevels * NumSlots; ++slot)
+	{
+		heads[slot] = INDEX_NONE;
+		tails[slot] = INDEX_NONE;
+	}
+	nodes.Reset();
+	currentTick = tick;
+	numScheduled = 0;
+}
+
+void FRuneTimingWheel::Schedule(int32 id, uint64 expireTick)
+{
+	check(id >= 0);
+
+	if (id >= nodes.Num())
+	{
+		nodes.SetNum(id + 1);
+	}
+
+	if (nodes[id].slot != INDEX_NONE)
+	{
+		Unlink(id);
+	}
+	else
+	{
+		++numScheduled;
+	}
+
+	// the current tick has already been processed
+	nodes[id].expireTick = FMath::Max(expireTick, currentTick + 1);
+	Insert(id);
+}
+
+void FRuneTimingWheel::Cancel(int32 id)
+{
+	if (!IsScheduled(id))
+	{
+		return;
+	}
+
+	Unlink(id);
+	--numScheduled;
+}
+
+bool FRuneTimingWheel::IsScheduled(int32 id) const
+{
+	return nodes.IsValidIndex(id) && nodes[id].slot != INDEX_NONE;
+}
+
+void FRuneTimingWheel::Advance(uint64 tick, TArray<int32>& outExpired)
+{
+	while (currentTick < tick)
+	{
+		// nothing to expire, jump straight to the target tick
+		if (numScheduled == 0)
+		{
+			currentTick = tick;
+			break;
+		}
+
+		++currentTick;
+
+		// refill lower levels from the upper ones, highest first
+		for (int32 level = NumLevels - 1; level > 0; --level)
+		{
+			const uint64 levelMask = (uint64(1) << (SlotBits * level)) - 1;
+			if ((currentTick & levelMask) == 0)
+			{
+				Cascade(level);
+			}
+		}
+
+		// expire the current slot of the lowest level
+		int32 id = Detach(static_cast<int32>(currentTick & (NumSlots - 1)));
+		while (id != INDEX_NONE)
+		{
+			const int32 next = nodes[id].next;
+			nodes[id].slot = INDEX_NONE;
+
+			// overflowed the upper level, still has to wait
+			if (nodes[id].expireTick > currentTick)
+			{
+				Insert(id);
+			}
+			else
+			{
+				--numScheduled;
+				outExpired.Add(id);
+			}
+			id = next;
+		}
+	}
+}
+
+void FRuneTimingWheel::Insert(int32 id)
+{
+	const uint64 expireTick = nodes[id].expireTick;
+	const uint64 delta = expireTick > currentTick ? expireTick - currentTick : 0;
+
+	int32 level = 0;
+	while (level < NumLevels - 1 && delta >= (uint64(1) << (SlotBits * (level + 1))))
+	{
+		++level;
+	}
+
+	const int32 slot = static_cast<int32>((expireTick >> (SlotBits * level)) & (NumSlots - 1));
+	Link(id, level * NumSlots + slot);
+}
+
+void FRuneTimingWheel::Link(int32 id, int32 slot)
+{
+	FNode& node = nodes[id];
+	node.slot = slot;
+	node.next = INDEX_NONE;
+	node.prev = tails[slot];
+
+	if (tails[slot] != INDEX_NONE)
+	{
+		nodes[tails[slot]].next = id;
+	}
+	else
+	{
+		heads[slot] = id;
+	}
+	tails[slot] = id;
+}
+
+void FRuneTimingWheel::Unlink(int32 id)
+{
+	FNode& node = nodes[id];
+	if (node.prev != INDEX_NONE)
+	{
+		nodes[node.prev].next = node.next;
+	}
+	else
+	{
+		heads[node.slot] = node.next;
+	}
+
+	if (node.next != INDEX_NONE)
+	{
+		nodes[node.next].prev = node.prev;
+	}
+	else
+	{
+		tails[node.slot] = node.prev;
+	}
+
+	node.prev = INDEX_NONE;
+	node.next = INDEX_NONE;
+	node.slot = INDEX_NONE;
+}
+
+void FRuneTimingWheel::Cascade(int32 level)
+{
+	const int32 slot = level * NumSlots + static_cast<int32>((currentTick >> (SlotBits * level)) & (NumSlots - 1));
+
+	int32 id = Detach(slot);
+	while (id != INDEX_NONE)
+	{
+		const int32 next = nodes[id].next;
+		Insert(id);
+		id = next;
+	}
+}
+
+int32 FRuneTimingWheel::Detach(int32 slot)
+{
+	// nodes keep their links until re-linked, so the chain can still be walked
+	const int32 head = heads[slot];
+	heads[slot] = INDEX_NONE;
+	tails[slot] = INDEX_NONE;
+	return head;
+}
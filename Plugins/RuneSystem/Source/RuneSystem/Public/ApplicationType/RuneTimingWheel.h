@@ -0,0 +1,113 @@
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+/**
+ * Hierarchical timing wheel of integer ids.
+ * 
+ * Time is measured in ticks (e.g. world time divided by a resolution).
+ * Each level has NumSlots slots, every slot of a level covering NumSlots slots
+ * of the level below, so scheduling and canceling are O(1) and advancing costs
+ * one slot per elapsed tick plus the cascading of upper levels.
+ * Ids are expected to be small and dense (e.g. indices of a pool).
+ */
+class RUNESYSTEM_API FRuneTimingWheel
+{
+public:
+	static constexpr int32 SlotBits = 6;
+	static constexpr int32 NumSlots = 1 << SlotBits;
+	static constexpr int32 NumLevels = 4;
+
+	FRuneTimingWheel();
+
+	/**
+	 * Unschedules every id and moves the wheel to a given tick.
+	 *
+	 * @param tick Current tick
+	 */
+	void Reset(uint64 tick = 0);
+
+	/**
+	 * Schedules an id, rescheduling it if it already was.
+	 * Ticks not after the current one expire on the next advance.
+	 *
+	 * @param id Scheduled id
+	 * @param expireTick Tick at which the id expires
+	 */
+	void Schedule(int32 id, uint64 expireTick);
+
+	/**
+	 * Unschedules an id.
+	 *
+	 * @param id Scheduled id
+	 */
+	void Cancel(int32 id);
+
+	/**
+	 * Whether or not an id is scheduled.
+	 *
+	 * @param id Queried id
+	 * @return If true, it is scheduled
+	 */
+	bool IsScheduled(int32 id) const;
+
+	/**
+	 * Advances the wheel up to a given tick, collecting the expired ids.
+	 * Ids are appended by expiration tick, in schedule order within the same tick.
+	 *
+	 * @param tick Tick to advance to
+	 * @param outExpired Expired ids
+	 */
+	void Advance(uint64 tick, TArray<int32>& outExpired);
+
+	/** Gets the current tick */
+	uint64 GetCurrentTick() const { return currentTick; }
+
+	/** Gets the number of scheduled ids */
+	int32 Num() const { return numScheduled; }
+
+	/** Heap memory used by the nodes */
+	SIZE_T GetAllocatedSize() const { return nodes.GetAllocatedSize(); }
+
+private:
+	/** Places a node in the slot matching its expire tick */
+	void Insert(int32 id);
+
+	/** Appends a node to the tail of a slot */
+	void Link(int32 id, int32 slot);
+
+	/** Removes a node from its slot */
+	void Unlink(int32 id);
+
+	/** Moves every node of a slot to the lower levels */
+	void Cascade(int32 level);
+
+	/** Empties a slot, returning the head of its former chain */
+	int32 Detach(int32 slot);
+
+private:
+	/** Intrusive list node, one per id */
+	struct FNode
+	{
+		int32 prev = INDEX_NONE;
+		int32 next = INDEX_NONE;
+		int32 slot = INDEX_NONE;
+		uint64 expireTick = 0;
+	};
+
+	/** Nodes by id */
+	TArray<FNode> nodes;
+
+	/** First and last node of each slot, level by level */
+	int32 heads[NumLevels * NumSlots];
+	int32 tails[NumLevels * NumSlots];
+
+	/** Last advanced tick */
+	uint64 currentTick;
+
+	/** Number of scheduled ids */
+	int32 numScheduled;
+};
@@ -3,6 +3,7 @@
 
 #include "StatusComponent.h"
 #include "RuneEffect.h"
+#include "RuneFilterCache.h"
 #include "TimerManager.h"
 
 
@@ -34,6 +35,7 @@ void UStatusComponent::BeginPlay()
 	{
 		UActorComponent* component = GetOwner()->AddComponentByClass(runeEffectClass, false, FTransform::Identity, false);
 		runeEffect = Cast<URuneEffect>(component);
+		FRuneFilterCache::Get().InvalidateActor(*GetOwner());
 	}
 
 	if (runeEffect == nullptr)
@@ -50,6 +52,37 @@ void UStatusComponent::BeginPlay()
 	GetOwner()->GetWorldTimerManager().SetTimer(_timeHandle, this, &UStatusComponent::EndStatusEffect, duration, false);
 }
 
+void UStatusComponent::OnRegister()
+{
+	Super::OnRegister();
+
+	if (AActor* owner = GetOwner())
+	{
+		FRuneFilterCache::Get().InvalidateActor(*owner);
+	}
+}
+
+void UStatusComponent::OnUnregister()
+{
+	if (AActor* owner = GetOwner())
+	{
+		FRuneFilterCache::Get().InvalidateActor(*owner);
+	}
+
+	Super::OnUnregister();
+}
+
+void UStatusComponent::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+
+	// the applied effect is a copy owned by the component
+	if (CumulativeResourceSize.GetResourceSizeMode() == EResourceSizeMode::EstimatedTotal && runeEffect != nullptr && runeEffect->GetOuter() == this)
+	{
+		runeEffect->GetResourceSizeEx(CumulativeResourceSize);
+	}
+}
+
 //void UStatusComponent::Configure(const TSubclassOf<URuneEffect>& inEffectClass, float inDuration)
 //{
 //	if (_timeHandle.IsValid())
@@ -74,7 +107,7 @@ void UStatusComponent::Configure(URuneEffect* inEffect, AController* instigator,
 	this->runeEffectClass = nullptr;
 	_instigator = instigator;
 	// Copy rune effect instance so that it stays alive all duration
-	runeEffect = DuplicateObject<URuneEffect>(inEffect, this);
+	runeEffect = inEffect != nullptr ? inEffect->DuplicateEffect(this) : nullptr;
 	this->duration = inDuration;
 }
 
@@ -93,7 +126,6 @@ void UStatusComponent::BeginStatusEffect()
 		return;
 	}
 
-	UE_LOG(LogTemp, Display, TEXT("[StatusComponent] Status effect applied"));
 	runeEffect->ApplyEffectInstant(_instigator, _instigator, actor);
 }
 
@@ -112,8 +144,6 @@ void UStatusComponent::EndStatusEffect()
 		return;
 	}
 
-	UE_LOG(LogTemp, Display, TEXT("[StatusComponent] Status effect reverted"));
-	
 	runeEffect->RevertEffectInstant(actor);
 	runeEffect->DestroyComponent();
 	_timeHandle.Invalidate();
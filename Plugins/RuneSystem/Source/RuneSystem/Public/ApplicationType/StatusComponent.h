@@ -9,6 +9,11 @@
 
 class URuneEffect;
 
+/**
+ * Applies an effect to its owner for a given duration.
+ * Rune effects use the UStatusSubsystem instead, this component is
+ * kept for statuses set up by hand.
+ */
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class RUNESYSTEM_API UStatusComponent : public UActorComponent
 {
@@ -22,7 +27,14 @@ protected:
 	// Called when the game starts
 	virtual void BeginPlay() override;
 
+	// Called when the component gets registered/unregistered, invalidating owner's cached filter verdicts
+	virtual void OnRegister() override;
+	virtual void OnUnregister() override;
+
 public:
+	// Adds the memory of the applied effect copy when estimating the total
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+
 	//void Configure(const TSubclassOf<URuneEffect>& effectClass, float duration = 5.0f);
 	void Configure(URuneEffect* effect, AController* _instigator, float duration = 5.0f);
 
@@ -0,0 +1,300 @@
+
+
+#include "StatusSubsystem.h"
+#include "RuneEffect.h"
+#include "RuneSharedEffectsSubsystem.h"
+#include "Utils/RuneStats.h"
+#include "Engine/World.h"
+#include "GameFramework/Controller.h"
+
+
+UStatusSubsystem::UStatusSubsystem() :
+	statuses(),
+	freeIds(),
+	targetStatuses(),
+	timingWheel(),
+	expiredIds(),
+	lastSequence(0)
+{
+}
+
+bool UStatusSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UStatusSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	timingWheel.Reset(ToWheelTick(InWorld.GetTimeSeconds()));
+}
+
+void UStatusSubsystem::Deinitialize()
+{
+	statuses.Empty();
+	freeIds.Empty();
+	targetStatuses.Empty();
+	timingWheel.Reset();
+
+	Super::Deinitialize();
+}
+
+void UStatusSubsystem::Tick(float DeltaTime)
+{
+	RUNE_SCOPE_CYCLE_COUNTER(STAT_RuneStatusTick, "UStatusSubsystem::Tick");
+	RUNE_SCOPE_PROFILE_PHASE(STATUS_TICK);
+
+	Super::Tick(DeltaTime);
+
+	// the tick matching the current time might not have been fully reached yet
+	const double now = GetWorld()->GetTimeSeconds();
+	const uint64 currentTick = FMath::FloorToInt64(now / WheelResolution);
+	if (currentTick <= timingWheel.GetCurrentTick())
+	{
+		return;
+	}
+
+	expiredIds.Reset();
+	timingWheel.Advance(currentTick, expiredIds);
+	if (expiredIds.Num() == 0)
+	{
+		return;
+	}
+
+	// statuses sharing a wheel tick end in the same order timers would
+	TArray<TPair<int32, uint64>, TInlineAllocator<64>> expired;
+	expired.Reserve(expiredIds.Num());
+	for (int32 id : expiredIds)
+	{
+		expired.Emplace(id, statuses[id].sequence);
+	}
+	expired.Sort([this](const TPair<int32, uint64>& a, const TPair<int32, uint64>& b)
+	{
+		const double aEndTime = statuses[a.Key].endTime;
+		const double bEndTime = statuses[b.Key].endTime;
+		return aEndTime != bEndTime ? aEndTime < bEndTime : a.Value < b.Value;
+	});
+
+	for (const TPair<int32, uint64>& pair : expired)
+	{
+		// reverting may have removed, or even reused, the status
+		if (statuses[pair.Key].sequence != pair.Value) continue;
+
+		EndStatusEffect(pair.Key, true);
+	}
+}
+
+TStatId UStatusSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UStatusSubsystem, STATGROUP_Tickables);
+}
+
+void UStatusSubsystem::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+
+	SIZE_T allocatedSize = statuses.GetAllocatedSize() + freeIds.GetAllocatedSize() + targetStatuses.GetAllocatedSize() + timingWheel.GetAllocatedSize() + expiredIds.GetAllocatedSize();
+	for (const TPair<TObjectKey<AActor>, TArray<int32, TInlineAllocator<4>>>& pair : targetStatuses)
+	{
+		allocatedSize += pair.Value.GetAllocatedSize();
+	}
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(allocatedSize);
+}
+
+bool UStatusSubsystem::AddStatusEffect(URuneEffect& effect, AController* instigator, AActor* causer, AActor& target, float duration)
+{
+	LLM_SCOPE_BYTAG(RuneSystem);
+
+	URuneSharedEffectsSubsystem* sharedEffectsSubsystem = GetWorld()->GetSubsystem<URuneSharedEffectsSubsystem>();
+	URuneEffect* sharedEffect = sharedEffectsSubsystem != nullptr ? sharedEffectsSubsystem->AcquireEffect(effect) : nullptr;
+	if (sharedEffect == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[StatusSubsystem] AddStatusEffect(): '%s' could not be copied."), *effect.GetName());
+		return false;
+	}
+
+	const int32 id = freeIds.Num() > 0 ? freeIds.Pop(false) : statuses.AddDefaulted();
+	FStatus& status = statuses[id];
+	status.target = &target;
+	status.targetKey = &target;
+	status.effect = sharedEffect;
+	status.sourceEffect = &effect;
+	status.instigator = instigator;
+	status.causer = causer;
+	status.endTime = GetWorld()->GetTimeSeconds() + duration;
+	status.sequence = ++lastSequence;
+
+	TArray<int32, TInlineAllocator<4>>& ids = targetStatuses.FindOrAdd(&target);
+	if (ids.Num() == 0)
+	{
+		target.OnDestroyed.AddUniqueDynamic(this, &UStatusSubsystem::OnTargetDestroyed);
+	}
+	ids.Add(id);
+
+	// revert effect after duration seconds
+	if (duration > 0.0f)
+	{
+		timingWheel.Schedule(id, ToWheelTick(status.endTime));
+	}
+
+	// apply effect
+	sharedEffect->ApplyEffectInstant(instigator, causer, &target);
+
+	return true;
+}
+
+int32 UStatusSubsystem::RefreshStatusEffect(const URuneEffect& effect, const AActor& target, float duration)
+{
+	const TArray<int32, TInlineAllocator<4>>* ids = targetStatuses.Find(&target);
+	if (ids == nullptr)
+	{
+		return 0;
+	}
+
+	const TObjectKey<URuneEffect> sourceEffect(&effect);
+	const double endTime = GetWorld()->GetTimeSeconds() + duration;
+	int32 refreshed = 0;
+	for (int32 id : *ids)
+	{
+		FStatus& status = statuses[id];
+		if (status.sourceEffect != sourceEffect) continue;
+
+		status.endTime = endTime;
+		if (duration > 0.0f)
+		{
+			timingWheel.Schedule(id, ToWheelTick(endTime));
+		}
+		else
+		{
+			timingWheel.Cancel(id);
+		}
+		++refreshed;
+	}
+
+	return refreshed;
+}
+
+int32 UStatusSubsystem::RemoveStatusEffect(const URuneEffect& effect, const AActor& target)
+{
+	const TArray<int32, TInlineAllocator<4>>* ids = targetStatuses.Find(&target);
+	if (ids == nullptr)
+	{
+		return 0;
+	}
+
+	// reverting may modify the target statuses
+	const TObjectKey<URuneEffect> sourceEffect(&effect);
+	TArray<TPair<int32, uint64>, TInlineAllocator<4>> removed;
+	for (int32 id : *ids)
+	{
+		if (statuses[id].sourceEffect != sourceEffect) continue;
+
+		removed.Emplace(id, statuses[id].sequence);
+	}
+
+	for (const TPair<int32, uint64>& pair : removed)
+	{
+		if (statuses[pair.Key].sequence != pair.Value) continue;
+
+		EndStatusEffect(pair.Key, true);
+	}
+
+	return removed.Num();
+}
+
+int32 UStatusSubsystem::GetActiveStatusEffects(const AActor* target, TArray<URuneEffect*>& outEffects) const
+{
+	outEffects.Reset();
+
+	const TArray<int32, TInlineAllocator<4>>* ids = target != nullptr ? targetStatuses.Find(target) : nullptr;
+	if (ids == nullptr)
+	{
+		return 0;
+	}
+
+	outEffects.Reserve(ids->Num());
+	for (int32 id : *ids)
+	{
+		outEffects.Add(statuses[id].effect);
+	}
+
+	return outEffects.Num();
+}
+
+bool UStatusSubsystem::HasStatusEffect(const AActor* target, TSubclassOf<URuneEffect> effectClass) const
+{
+	const TArray<int32, TInlineAllocator<4>>* ids = target != nullptr ? targetStatuses.Find(target) : nullptr;
+	if (ids == nullptr)
+	{
+		return false;
+	}
+
+	for (int32 id : *ids)
+	{
+		const URuneEffect* effect = statuses[id].effect;
+		if (effect != nullptr && (effectClass == nullptr || effect->IsA(effectClass)))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+int32 UStatusSubsystem::GetNumStatusEffects() const
+{
+	return statuses.Num() - freeIds.Num();
+}
+
+uint64 UStatusSubsystem::ToWheelTick(double time)
+{
+	return static_cast<uint64>(FMath::Max<int64>(FMath::CeilToInt64(time / WheelResolution), 0));
+}
+
+void UStatusSubsystem::EndStatusEffect(int32 id, bool revert)
+{
+	// release the status before reverting, reverting may add new statuses
+	FStatus status = MoveTemp(statuses[id]);
+	statuses[id] = FStatus();
+	freeIds.Add(id);
+	timingWheel.Cancel(id);
+
+	if (TArray<int32, TInlineAllocator<4>>* ids = targetStatuses.Find(status.targetKey))
+	{
+		ids->RemoveSingleSwap(id, false);
+		if (ids->Num() == 0)
+		{
+			targetStatuses.Remove(status.targetKey);
+		}
+	}
+
+	AActor* target = status.target.Get();
+	if (revert && target != nullptr && status.effect != nullptr)
+	{
+		status.effect->RevertEffectInstant(target);
+	}
+
+	if (URuneSharedEffectsSubsystem* sharedEffectsSubsystem = GetWorld()->GetSubsystem<URuneSharedEffectsSubsystem>())
+	{
+		sharedEffectsSubsystem->ReleaseEffect(status.sourceEffect, status.effect);
+	}
+}
+
+void UStatusSubsystem::OnTargetDestroyed(AActor* target)
+{
+	TArray<int32, TInlineAllocator<4>>* ids = targetStatuses.Find(target);
+	if (ids == nullptr)
+	{
+		return;
+	}
+
+	// destroyed targets are not reverted
+	TArray<int32, TInlineAllocator<4>> removed = *ids;
+	for (int32 id : removed)
+	{
+		if (statuses[id].sequence == 0) continue;
+
+		EndStatusEffect(id, false);
+	}
+}
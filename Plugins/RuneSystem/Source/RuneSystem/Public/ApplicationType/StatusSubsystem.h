@@ -0,0 +1,163 @@
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "RuneTimingWheel.h"
+#include "StatusSubsystem.generated.h"
+
+
+class URuneEffect;
+
+/**
+ * Owns every active status of its world.
+ * 
+ * Statuses are pooled and indexed per target, and they expire through a
+ * hierarchical timing wheel, so applying, refreshing or removing a status
+ * is O(1) and does not create any component nor timer.
+ * Effects applied as status follow FRuneSharedEffects: statuses share the
+ * world's copy of their source effect, and keep their own instigator and causer.
+ */
+UCLASS()
+class RUNESYSTEM_API UStatusSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Time - in seconds - covered by a tick of the timing wheel */
+	static constexpr double WheelResolution = 1.0 / 60.0;
+
+	// Sets default values for this subsystem's properties
+	UStatusSubsystem();
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	// Called every frame
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Adds the memory of the statuses and their expiration wheel
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+
+public:
+	/**
+	 * Applies an effect to a target and reverts it after a given duration.
+	 * Statuses stack, each application gets its own status.
+	 *
+	 * @param effect Applied effect. It does not need to outlive the status.
+	 * @param instigator Controller that applied the effect
+	 * @param causer Actor which applied the effect
+	 * @param target Actor which will recieve the effect application.
+	 * @param duration Time - in seconds - before reverting. If not positive, it will last until removed.
+	 * @return If true, the status has been added
+	 */
+	bool AddStatusEffect(URuneEffect& effect, AController* instigator, AActor* causer, AActor& target, float duration = 5.0f);
+
+	/**
+	 * Restarts the duration of every status of an effect on a target.
+	 *
+	 * @param effect Effect that was applied
+	 * @param target Actor receiving the effect
+	 * @param duration New time - in seconds - before reverting. If not positive, it will last until removed.
+	 * @return Number of refreshed statuses
+	 */
+	int32 RefreshStatusEffect(const URuneEffect& effect, const AActor& target, float duration);
+
+	/**
+	 * Reverts and removes every status of an effect on a target.
+	 *
+	 * @param effect Effect that was applied
+	 * @param target Actor receiving the effect
+	 * @return Number of removed statuses
+	 */
+	int32 RemoveStatusEffect(const URuneEffect& effect, const AActor& target);
+
+	/**
+	 * Gets the effects of every active status on a target.
+	 *
+	 * @param target Actor receiving the effects
+	 * @param outEffects Applied effects, one per active status
+	 * @return Number of active statuses
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Rune System|Status")
+	int32 GetActiveStatusEffects(const AActor* target, TArray<URuneEffect*>& outEffects) const;
+
+	/**
+	 * Whether or not a target has an active status of a given effect class.
+	 *
+	 * @param target Actor receiving the effects
+	 * @param effectClass Effect class
+	 * @return If true, there is at least one active status
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Rune System|Status")
+	bool HasStatusEffect(const AActor* target, TSubclassOf<URuneEffect> effectClass) const;
+
+	/**
+	 * Gets the number of active statuses.
+	 *
+	 * @return Active statuses
+	 */
+	int32 GetNumStatusEffects() const;
+
+private:
+	/** Converts a world time into a wheel tick, rounding up so statuses never end early */
+	static uint64 ToWheelTick(double time);
+
+	/** Reverts (if needed) and releases a status */
+	void EndStatusEffect(int32 id, bool revert);
+
+	/** Invoked when a target with statuses has been destroyed */
+	UFUNCTION()
+	void OnTargetDestroyed(AActor* target);
+
+private:
+	/** Pooled status data */
+	struct FStatus
+	{
+		/** Target receiving the effect */
+		TWeakObjectPtr<AActor> target;
+
+		/** Key of the target, valid even once destroyed */
+		TObjectKey<AActor> targetKey;
+
+		/** Applied effect, acquired from the world's URuneSharedEffectsSubsystem */
+		URuneEffect* effect = nullptr;
+
+		/** Source effect, used for refreshing, removing and releasing the applied effect */
+		TObjectKey<URuneEffect> sourceEffect;
+
+		/** Controller that applied the effect */
+		TWeakObjectPtr<AController> instigator;
+
+		/** Actor that applied the effect */
+		TWeakObjectPtr<AActor> causer;
+
+		/** World time - in seconds - at which the status ends */
+		double endTime = 0.0;
+
+		/** Application order, also used to detect reused ids. 0 if not in use */
+		uint64 sequence = 0;
+	};
+
+	/** Status pool, indexed by id */
+	TArray<FStatus> statuses;
+
+	/** Unused ids of the pool */
+	TArray<int32> freeIds;
+
+	/** Active status ids per target */
+	TMap<TObjectKey<AActor>, TArray<int32, TInlineAllocator<4>>> targetStatuses;
+
+	/** Timing wheel driving the statuses expiration */
+	FRuneTimingWheel timingWheel;
+
+	/** Scratch array for the expired ids */
+	TArray<int32> expiredIds;
+
+	/** Last given sequence */
+	uint64 lastSequence;
+};
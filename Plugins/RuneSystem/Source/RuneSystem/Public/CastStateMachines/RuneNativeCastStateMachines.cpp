@@ -0,0 +1,248 @@
+
+
+#include "RuneNativeCastStateMachines.h"
+
+
+// ----------------------------
+// Instant cast
+// ----------------------------
+
+void FRuneInstantCastTraits::OnEnter(MachineType& machine, EState state)
+{
+	if (state == EState::CAST)
+	{
+		machine.ActivateBehaviourSlots();
+	}
+}
+
+void URuneInstantCastStateMachine::StartStaticMachine()
+{
+	staticMachine.Start(*this);
+}
+
+void URuneInstantCastStateMachine::TickStaticMachine(float DeltaTime)
+{
+	staticMachine.Tick(*this, DeltaTime, isPressed, wasPressedSinceTick, wasReleasedSinceTick);
+}
+
+bool URuneInstantCastStateMachine::IsStaticMachineInEntryState() const
+{
+	return staticMachine.IsInEntryState();
+}
+
+bool URuneInstantCastStateMachine::StaticMachineNeedsTick() const
+{
+	return staticMachine.NeedsTick();
+}
+
+float URuneInstantCastStateMachine::GetStaticMachineTimeInState() const
+{
+	return staticMachine.GetTimeInState();
+}
+
+// ----------------------------
+// Charge and release cast
+// ----------------------------
+
+bool FRuneChargeCastTraits::HasCharged(const MachineType& machine, float timeInState)
+{
+	return timeInState >= machine.minChargeTime;
+}
+
+bool FRuneChargeCastTraits::IsFullyCharged(const MachineType& machine, float timeInState)
+{
+	return machine.maxChargeTime > 0.0f && timeInState >= machine.maxChargeTime;
+}
+
+void FRuneChargeCastTraits::OnEnter(MachineType& machine, EState state)
+{
+	switch (state)
+	{
+	case EState::CHARGING:
+		machine.chargeTime = 0.0f;
+		machine.ShowBehaviourSlotPreviews();
+		break;
+	case EState::CAST:
+		machine.ActivateBehaviourSlots();
+		break;
+	default:
+		break;
+	}
+}
+
+void FRuneChargeCastTraits::OnExit(MachineType& machine, EState state)
+{
+	if (state == EState::CHARGING)
+	{
+		machine.chargeTime = machine.staticMachine.GetTimeInState();
+		machine.HideBehaviourSlotPreviews();
+	}
+}
+
+URuneChargeCastStateMachine::URuneChargeCastStateMachine() :
+	minChargeTime(0.0f),
+	maxChargeTime(0.0f),
+	staticMachine(),
+	chargeTime(0.0f)
+{
+}
+
+float URuneChargeCastStateMachine::GetChargeRatio() const
+{
+	const float charged = staticMachine.GetState() == FRuneChargeCastTraits::EState::CHARGING ? staticMachine.GetTimeInState() : chargeTime;
+	if (maxChargeTime <= 0.0f)
+	{
+		return charged > 0.0f ? 1.0f : 0.0f;
+	}
+
+	return FMath::Clamp(charged / maxChargeTime, 0.0f, 1.0f);
+}
+
+void URuneChargeCastStateMachine::StartStaticMachine()
+{
+	staticMachine.Start(*this);
+}
+
+void URuneChargeCastStateMachine::TickStaticMachine(float DeltaTime)
+{
+	staticMachine.Tick(*this, DeltaTime, isPressed, wasPressedSinceTick, wasReleasedSinceTick);
+}
+
+bool URuneChargeCastStateMachine::IsStaticMachineInEntryState() const
+{
+	return staticMachine.IsInEntryState();
+}
+
+bool URuneChargeCastStateMachine::StaticMachineNeedsTick() const
+{
+	return staticMachine.NeedsTick();
+}
+
+float URuneChargeCastStateMachine::GetStaticMachineTimeInState() const
+{
+	return staticMachine.GetTimeInState();
+}
+
+// ----------------------------
+// Channel cast
+// ----------------------------
+
+bool FRuneChannelCastTraits::HasChannelEnded(const MachineType& machine, float timeInState)
+{
+	return machine.maxChannelTime > 0.0f && timeInState >= machine.maxChannelTime;
+}
+
+void FRuneChannelCastTraits::OnEnter(MachineType& machine, EState state)
+{
+	if (state == EState::CHANNELING)
+	{
+		machine.ActivateBehaviourSlots();
+	}
+}
+
+void FRuneChannelCastTraits::OnExit(MachineType& machine, EState state)
+{
+	if (state == EState::CHANNELING)
+	{
+		machine.DeactivateBehaviourSlots();
+	}
+}
+
+URuneChannelCastStateMachine::URuneChannelCastStateMachine() :
+	maxChannelTime(0.0f),
+	staticMachine()
+{
+}
+
+void URuneChannelCastStateMachine::StartStaticMachine()
+{
+	staticMachine.Start(*this);
+}
+
+void URuneChannelCastStateMachine::TickStaticMachine(float DeltaTime)
+{
+	staticMachine.Tick(*this, DeltaTime, isPressed, wasPressedSinceTick, wasReleasedSinceTick);
+}
+
+bool URuneChannelCastStateMachine::IsStaticMachineInEntryState() const
+{
+	return staticMachine.IsInEntryState();
+}
+
+bool URuneChannelCastStateMachine::StaticMachineNeedsTick() const
+{
+	return staticMachine.NeedsTick();
+}
+
+float URuneChannelCastStateMachine::GetStaticMachineTimeInState() const
+{
+	return staticMachine.GetTimeInState();
+}
+
+// ----------------------------
+// Combo cast
+// ----------------------------
+
+bool FRuneComboCastTraits::HasNextStep(const MachineType& machine, float timeInState)
+{
+	return machine.comboStep < machine.GetNumLinkedSlots();
+}
+
+bool FRuneComboCastTraits::HasComboEnded(const MachineType& machine, float timeInState)
+{
+	return timeInState >= machine.comboWindow || !HasNextStep(machine, timeInState);
+}
+
+void FRuneComboCastTraits::OnEnter(MachineType& machine, EState state)
+{
+	switch (state)
+	{
+	case EState::IDLE:
+		machine.comboStep = 0;
+		break;
+	case EState::STEP:
+		if (machine.comboStep < machine.GetNumLinkedSlots())
+		{
+			machine.ActivateBehaviourSlot(machine.comboStep);
+		}
+		++machine.comboStep;
+		break;
+	default:
+		break;
+	}
+}
+
+URuneComboCastStateMachine::URuneComboCastStateMachine() :
+	comboWindow(0.5f),
+	staticMachine(),
+	comboStep(0)
+{
+	// one slot per combo step
+	hasMultipleSlots = true;
+	slots = 3;
+}
+
+void URuneComboCastStateMachine::StartStaticMachine()
+{
+	staticMachine.Start(*this);
+}
+
+void URuneComboCastStateMachine::TickStaticMachine(float DeltaTime)
+{
+	staticMachine.Tick(*this, DeltaTime, isPressed, wasPressedSinceTick, wasReleasedSinceTick);
+}
+
+bool URuneComboCastStateMachine::IsStaticMachineInEntryState() const
+{
+	return staticMachine.IsInEntryState();
+}
+
+bool URuneComboCastStateMachine::StaticMachineNeedsTick() const
+{
+	return staticMachine.NeedsTick();
+}
+
+float URuneComboCastStateMachine::GetStaticMachineTimeInState() const
+{
+	return staticMachine.GetTimeInState();
+}
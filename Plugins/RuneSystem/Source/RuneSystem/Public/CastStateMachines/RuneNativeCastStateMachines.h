@@ -0,0 +1,264 @@
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RuneStaticCastStateMachine.h"
+#include "RuneNativeCastStateMachines.generated.h"
+
+
+class URuneInstantCastStateMachine;
+class URuneChargeCastStateMachine;
+class URuneChannelCastStateMachine;
+class URuneComboCastStateMachine;
+
+// ----------------------------
+// Instant cast
+// ----------------------------
+
+/** Casts every behaviour slot when pressed, then waits for the release */
+struct FRuneInstantCastTraits
+{
+	enum class EState : uint8 { IDLE, CAST };
+
+	using StateType = EState;
+	using MachineType = URuneInstantCastStateMachine;
+
+	static constexpr int32 NumStates = 2;
+	static constexpr EState EntryState = EState::IDLE;
+	static constexpr TRuneStaticTransition<EState, MachineType> Transitions[] =
+	{
+		{ EState::IDLE, EState::CAST, ERuneTransitionCondition::PRESSED },
+		{ EState::CAST, EState::IDLE, ERuneTransitionCondition::RELEASED }
+	};
+
+	static constexpr bool TicksState(EState state) { return false; }
+	static void OnEnter(MachineType& machine, EState state);
+	static void OnExit(MachineType& machine, EState state) {}
+	static void OnTick(MachineType& machine, EState state, float deltaTime) {}
+};
+
+UCLASS(meta = (DisplayName = "Instant Cast (Native)"))
+class RUNESYSTEM_API URuneInstantCastStateMachine : public URuneStaticCastStateMachine
+{
+	GENERATED_BODY()
+
+protected:
+	virtual void StartStaticMachine() override;
+	virtual void TickStaticMachine(float DeltaTime) override;
+	virtual bool IsStaticMachineInEntryState() const override;
+	virtual bool StaticMachineNeedsTick() const override;
+	virtual float GetStaticMachineTimeInState() const override;
+
+private:
+	TRuneStaticStateMachine<FRuneInstantCastTraits> staticMachine;
+};
+
+// ----------------------------
+// Charge and release cast
+// ----------------------------
+
+/**
+ * Shows the previews while pressed and casts every behaviour slot once released,
+ * if charged long enough. Fully charged runes are cast without waiting for the release.
+ */
+struct FRuneChargeCastTraits
+{
+	enum class EState : uint8 { IDLE, CHARGING, CAST };
+
+	using StateType = EState;
+	using MachineType = URuneChargeCastStateMachine;
+
+	static constexpr int32 NumStates = 3;
+	static constexpr EState EntryState = EState::IDLE;
+
+	static bool HasCharged(const MachineType& machine, float timeInState);
+	static bool IsFullyCharged(const MachineType& machine, float timeInState);
+
+	static constexpr TRuneStaticTransition<EState, MachineType> Transitions[] =
+	{
+		{ EState::IDLE, EState::CHARGING, ERuneTransitionCondition::PRESSED },
+		{ EState::CHARGING, EState::CAST, ERuneTransitionCondition::RELEASED, 0.0f, &HasCharged },
+		{ EState::CHARGING, EState::IDLE, ERuneTransitionCondition::RELEASED },
+		{ EState::CHARGING, EState::CAST, ERuneTransitionCondition::ALWAYS, 0.0f, &IsFullyCharged },
+		{ EState::CAST, EState::IDLE, ERuneTransitionCondition::RELEASED }
+	};
+
+	static constexpr bool TicksState(EState state) { return false; }
+	static void OnEnter(MachineType& machine, EState state);
+	static void OnExit(MachineType& machine, EState state);
+	static void OnTick(MachineType& machine, EState state, float deltaTime) {}
+};
+
+UCLASS(meta = (DisplayName = "Charge Cast (Native)"))
+class RUNESYSTEM_API URuneChargeCastStateMachine : public URuneStaticCastStateMachine
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	URuneChargeCastStateMachine();
+
+	/**
+	 * Gets how charged the rune is, 1 being fully charged.
+	 *
+	 * @return Charge ratio in [0, 1]. Kept after casting, until charging again.
+	 */
+	UFUNCTION(BlueprintCallable)
+	float GetChargeRatio() const;
+
+protected:
+	virtual void StartStaticMachine() override;
+	virtual void TickStaticMachine(float DeltaTime) override;
+	virtual bool IsStaticMachineInEntryState() const override;
+	virtual bool StaticMachineNeedsTick() const override;
+	virtual float GetStaticMachineTimeInState() const override;
+
+public:
+	/** Time - in seconds - the rune has to be charged before being released to be cast */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "RuneCastStateMachine: General Settings", meta = (ClampMin = "0.0", Units = "s"))
+	float minChargeTime;
+
+	/** Time - in seconds - after which the rune is fully charged and cast. If 0, it charges until released */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "RuneCastStateMachine: General Settings", meta = (ClampMin = "0.0", Units = "s"))
+	float maxChargeTime;
+
+private:
+	TRuneStaticStateMachine<FRuneChargeCastTraits> staticMachine;
+
+	/** Time - in seconds - charged in the last charge */
+	float chargeTime;
+
+	friend struct FRuneChargeCastTraits;
+};
+
+// ----------------------------
+// Channel cast
+// ----------------------------
+
+/**
+ * Keeps every behaviour slot active while pressed, up to a maximum channel time.
+ */
+struct FRuneChannelCastTraits
+{
+	enum class EState : uint8 { IDLE, CHANNELING, RECOVER };
+
+	using StateType = EState;
+	using MachineType = URuneChannelCastStateMachine;
+
+	static constexpr int32 NumStates = 3;
+	static constexpr EState EntryState = EState::IDLE;
+
+	static bool HasChannelEnded(const MachineType& machine, float timeInState);
+
+	static constexpr TRuneStaticTransition<EState, MachineType> Transitions[] =
+	{
+		{ EState::IDLE, EState::CHANNELING, ERuneTransitionCondition::PRESSED },
+		{ EState::CHANNELING, EState::IDLE, ERuneTransitionCondition::RELEASED },
+		{ EState::CHANNELING, EState::RECOVER, ERuneTransitionCondition::ALWAYS, 0.0f, &HasChannelEnded },
+		{ EState::RECOVER, EState::IDLE, ERuneTransitionCondition::RELEASED }
+	};
+
+	static constexpr bool TicksState(EState state) { return false; }
+	static void OnEnter(MachineType& machine, EState state);
+	static void OnExit(MachineType& machine, EState state);
+	static void OnTick(MachineType& machine, EState state, float deltaTime) {}
+};
+
+UCLASS(meta = (DisplayName = "Channel Cast (Native)"))
+class RUNESYSTEM_API URuneChannelCastStateMachine : public URuneStaticCastStateMachine
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	URuneChannelCastStateMachine();
+
+protected:
+	virtual void StartStaticMachine() override;
+	virtual void TickStaticMachine(float DeltaTime) override;
+	virtual bool IsStaticMachineInEntryState() const override;
+	virtual bool StaticMachineNeedsTick() const override;
+	virtual float GetStaticMachineTimeInState() const override;
+
+public:
+	/** Time - in seconds - after which the channel ends even if still pressed. If 0, it lasts until released */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "RuneCastStateMachine: General Settings", meta = (ClampMin = "0.0", Units = "s"))
+	float maxChannelTime;
+
+private:
+	TRuneStaticStateMachine<FRuneChannelCastTraits> staticMachine;
+};
+
+// ----------------------------
+// Combo cast
+// ----------------------------
+
+/**
+ * Casts one behaviour slot per press, in slot order, as long as
+ * every press comes within a time window after the previous release.
+ */
+struct FRuneComboCastTraits
+{
+	enum class EState : uint8 { IDLE, STEP, WINDOW };
+
+	using StateType = EState;
+	using MachineType = URuneComboCastStateMachine;
+
+	static constexpr int32 NumStates = 3;
+	static constexpr EState EntryState = EState::IDLE;
+
+	static bool HasNextStep(const MachineType& machine, float timeInState);
+	static bool HasComboEnded(const MachineType& machine, float timeInState);
+
+	static constexpr TRuneStaticTransition<EState, MachineType> Transitions[] =
+	{
+		{ EState::IDLE, EState::STEP, ERuneTransitionCondition::PRESSED },
+		{ EState::STEP, EState::WINDOW, ERuneTransitionCondition::RELEASED },
+		{ EState::WINDOW, EState::IDLE, ERuneTransitionCondition::ALWAYS, 0.0f, &HasComboEnded },
+		{ EState::WINDOW, EState::STEP, ERuneTransitionCondition::PRESSED, 0.0f, &HasNextStep }
+	};
+
+	static constexpr bool TicksState(EState state) { return false; }
+	static void OnEnter(MachineType& machine, EState state);
+	static void OnExit(MachineType& machine, EState state) {}
+	static void OnTick(MachineType& machine, EState state, float deltaTime) {}
+};
+
+UCLASS(meta = (DisplayName = "Combo Cast (Native)"))
+class RUNESYSTEM_API URuneComboCastStateMachine : public URuneStaticCastStateMachine
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	URuneComboCastStateMachine();
+
+	/**
+	 * Gets the slot cast by the next step of the combo.
+	 *
+	 * @return Slot index, 0 when the combo has ended
+	 */
+	UFUNCTION(BlueprintCallable)
+	int32 GetComboStep() const { return comboStep; };
+
+protected:
+	virtual void StartStaticMachine() override;
+	virtual void TickStaticMachine(float DeltaTime) override;
+	virtual bool IsStaticMachineInEntryState() const override;
+	virtual bool StaticMachineNeedsTick() const override;
+	virtual float GetStaticMachineTimeInState() const override;
+
+public:
+	/** Time - in seconds - after a release in which the next press continues the combo */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "RuneCastStateMachine: General Settings", meta = (ClampMin = "0.0", Units = "s"))
+	float comboWindow;
+
+private:
+	TRuneStaticStateMachine<FRuneComboCastTraits> staticMachine;
+
+	/** Slot cast by the next step */
+	int32 comboStep;
+
+	friend struct FRuneComboCastTraits;
+};
@@ -0,0 +1,277 @@
+
+
+#include "RuneNativeInternalSchedulers.h"
+#include "RuneTask.h"
+
+
+// ----------------------------
+// Native scheduler
+// ----------------------------
+
+URuneNativeInternalScheduler::URuneNativeInternalScheduler() :
+	defaultAction(ERuneSchedulerAction::CONTINUE),
+	rulesTable(nullptr),
+	rules(),
+	actionTable(),
+	isWaitingRuneConfig(false)
+{
+}
+
+void URuneNativeInternalScheduler::Configure(int inMaxRuneConfigIndex)
+{
+	Super::Configure(inMaxRuneConfigIndex);
+
+	CompileRules();
+
+	isWaitingRuneConfig = false;
+	ScheduleRuneConfig(SelectFirstRuneConfig());
+}
+
+bool URuneNativeInternalScheduler::ScheduledRuneConfig(const URuneTask* activeRuneTask)
+{
+	// nothing could be scheduled last time, so the task of the scheduled configuration is stale
+	if (isWaitingRuneConfig) return ScheduleRuneConfig(SelectNextRuneConfig());
+
+	if (!IsValid()) return false;
+	if (activeRuneTask == nullptr) return true;
+
+	switch (GetAction(activeRuneTask->taskValue.Get()))
+	{
+	case ERuneSchedulerAction::HOLD:
+		return false;
+	case ERuneSchedulerAction::RESET:
+		OnRuneConfigLeft(scheduledRuneConfigIndex);
+		return ScheduleRuneConfig(SelectFirstRuneConfig());
+	case ERuneSchedulerAction::ADVANCE:
+		OnRuneConfigLeft(scheduledRuneConfigIndex);
+		return ScheduleRuneConfig(SelectNextRuneConfig());
+	default:
+		return true;
+	}
+}
+
+bool URuneNativeInternalScheduler::ScheduleRuneConfig(int32 index)
+{
+	isWaitingRuneConfig = index == INDEX_NONE;
+	if (isWaitingRuneConfig) return false;
+
+	scheduledRuneConfigIndex = index;
+	return IsValid();
+}
+
+void URuneNativeInternalScheduler::CompileRules()
+{
+	for (ERuneSchedulerAction& action : actionTable)
+	{
+		action = defaultAction;
+	}
+
+	if (rulesTable != nullptr)
+	{
+		const UScriptStruct* rowStruct = rulesTable->GetRowStruct();
+		if (rowStruct != nullptr && rowStruct->IsChildOf(FRuneSchedulerRule::StaticStruct()))
+		{
+			rulesTable->ForeachRow<FRuneSchedulerRule>(TEXT("URuneNativeInternalScheduler::CompileRules"), [this](const FName& key, const FRuneSchedulerRule& rule)
+			{
+				actionTable[rule.taskValue] = rule.action;
+			});
+		}
+		else
+		{
+			UE_LOG(LogTemp, Warning, TEXT("[URuneNativeInternalScheduler] CompileRules(): %s rows are not FRuneSchedulerRule, ignoring it"), *rulesTable->GetName());
+		}
+	}
+
+	// inline rules override the ones of the table
+	for (const FRuneSchedulerRule& rule : rules)
+	{
+		actionTable[rule.taskValue] = rule.action;
+	}
+}
+
+// ----------------------------
+// Sequential scheduler
+// ----------------------------
+
+URuneSequentialScheduler::URuneSequentialScheduler() :
+	loop(true)
+{
+	rules =
+	{
+		FRuneSchedulerRule(to_underlying(ERuneTaskValue::SUCCESS), ERuneSchedulerAction::ADVANCE),
+		FRuneSchedulerRule(to_underlying(ERuneTaskValue::HOLD), ERuneSchedulerAction::HOLD)
+	};
+}
+
+int32 URuneSequentialScheduler::SelectNextRuneConfig()
+{
+	const int32 nextIndex = scheduledRuneConfigIndex + 1;
+	if (nextIndex < maxRuneConfigIndex) return nextIndex;
+
+	return loop ? 0 : scheduledRuneConfigIndex;
+}
+
+// ----------------------------
+// Reset on failure scheduler
+// ----------------------------
+
+URuneResetOnFailureScheduler::URuneResetOnFailureScheduler()
+{
+	rules.Add(FRuneSchedulerRule(to_underlying(ERuneTaskValue::FAILURE), ERuneSchedulerAction::RESET));
+}
+
+// ----------------------------
+// Weighted scheduler
+// ----------------------------
+
+URuneWeightedScheduler::URuneWeightedScheduler() :
+	selection(ERuneWeightedSelection::RANDOM),
+	weights(),
+	allowRepeat(false),
+	totalWeight(0.0f)
+{
+	rules =
+	{
+		FRuneSchedulerRule(to_underlying(ERuneTaskValue::SUCCESS), ERuneSchedulerAction::ADVANCE),
+		FRuneSchedulerRule(to_underlying(ERuneTaskValue::FAILURE), ERuneSchedulerAction::ADVANCE),
+		FRuneSchedulerRule(to_underlying(ERuneTaskValue::HOLD), ERuneSchedulerAction::HOLD)
+	};
+}
+
+void URuneWeightedScheduler::Configure(int inMaxRuneConfigIndex)
+{
+	// weights are needed to select the first configuration
+	totalWeight = 0.0f;
+	for (int32 i = 0; i < inMaxRuneConfigIndex; ++i)
+	{
+		totalWeight += GetWeight(i);
+	}
+
+	Super::Configure(inMaxRuneConfigIndex);
+}
+
+int32 URuneWeightedScheduler::SelectFirstRuneConfig()
+{
+	return selection == ERuneWeightedSelection::PRIORITY ? FindPriorityRuneConfig(INDEX_NONE) : DrawRuneConfig(INDEX_NONE);
+}
+
+int32 URuneWeightedScheduler::SelectNextRuneConfig()
+{
+	const int32 excludedIndex = selection == ERuneWeightedSelection::RANDOM && allowRepeat ? INDEX_NONE : scheduledRuneConfigIndex;
+	const int32 index = selection == ERuneWeightedSelection::PRIORITY ? FindPriorityRuneConfig(excludedIndex) : DrawRuneConfig(excludedIndex);
+
+	// the scheduled configuration is kept if it is the only one that can be chosen
+	if (index == INDEX_NONE && excludedIndex != INDEX_NONE && GetWeight(excludedIndex) > 0.0f) return excludedIndex;
+
+	return index;
+}
+
+float URuneWeightedScheduler::GetWeight(int32 index) const
+{
+	return weights.IsValidIndex(index) ? FMath::Max(weights[index], 0.0f) : 1.0f;
+}
+
+int32 URuneWeightedScheduler::DrawRuneConfig(int32 excludedIndex) const
+{
+	const float candidatesWeight = totalWeight - (excludedIndex != INDEX_NONE ? GetWeight(excludedIndex) : 0.0f);
+	if (candidatesWeight <= 0.0f) return INDEX_NONE;
+
+	float draw = FMath::FRand() * candidatesWeight;
+	int32 lastCandidate = INDEX_NONE;
+	for (int32 i = 0; i < maxRuneConfigIndex; ++i)
+	{
+		const float weight = GetWeight(i);
+		if (i == excludedIndex || weight <= 0.0f) continue;
+
+		if (draw < weight) return i;
+
+		draw -= weight;
+		lastCandidate = i;
+	}
+
+	// floating point errors can leave a remainder after the last candidate
+	return lastCandidate;
+}
+
+int32 URuneWeightedScheduler::FindPriorityRuneConfig(int32 excludedIndex) const
+{
+	int32 bestIndex = INDEX_NONE;
+	float bestWeight = 0.0f;
+	for (int32 i = 0; i < maxRuneConfigIndex; ++i)
+	{
+		const float weight = GetWeight(i);
+		if (i == excludedIndex || weight <= bestWeight) continue;
+
+		bestIndex = i;
+		bestWeight = weight;
+	}
+	return bestIndex;
+}
+
+// ----------------------------
+// Round robin scheduler
+// ----------------------------
+
+URuneRoundRobinScheduler::URuneRoundRobinScheduler() :
+	cooldown(0.0f),
+	cooldowns(),
+	readyTimes()
+{
+	rules =
+	{
+		FRuneSchedulerRule(to_underlying(ERuneTaskValue::SUCCESS), ERuneSchedulerAction::ADVANCE),
+		FRuneSchedulerRule(to_underlying(ERuneTaskValue::FAILURE), ERuneSchedulerAction::ADVANCE),
+		FRuneSchedulerRule(to_underlying(ERuneTaskValue::HOLD), ERuneSchedulerAction::HOLD)
+	};
+}
+
+void URuneRoundRobinScheduler::Configure(int inMaxRuneConfigIndex)
+{
+	// cooldowns are needed to select the first configuration
+	readyTimes.Init(0.0, inMaxRuneConfigIndex);
+
+	Super::Configure(inMaxRuneConfigIndex);
+}
+
+float URuneRoundRobinScheduler::GetRemainingCooldown(int32 index) const
+{
+	if (!readyTimes.IsValidIndex(index)) return 0.0f;
+
+	return FMath::Max(static_cast<float>(readyTimes[index] - GetCurrentTime()), 0.0f);
+}
+
+int32 URuneRoundRobinScheduler::SelectFirstRuneConfig()
+{
+	return FindReadyRuneConfig(0);
+}
+
+int32 URuneRoundRobinScheduler::SelectNextRuneConfig()
+{
+	return FindReadyRuneConfig(scheduledRuneConfigIndex + 1);
+}
+
+void URuneRoundRobinScheduler::OnRuneConfigLeft(int32 index)
+{
+	if (!readyTimes.IsValidIndex(index)) return;
+
+	const float configCooldown = cooldowns.IsValidIndex(index) && cooldowns[index] >= 0.0f ? cooldowns[index] : cooldown;
+	readyTimes[index] = GetCurrentTime() + configCooldown;
+}
+
+int32 URuneRoundRobinScheduler::FindReadyRuneConfig(int32 startIndex) const
+{
+	const int32 numConfigs = readyTimes.Num();
+	const double currentTime = GetCurrentTime();
+	for (int32 i = 0; i < numConfigs; ++i)
+	{
+		const int32 index = (startIndex + i) % numConfigs;
+		if (readyTimes[index] <= currentTime) return index;
+	}
+	return INDEX_NONE;
+}
+
+double URuneRoundRobinScheduler::GetCurrentTime() const
+{
+	const UWorld* world = GetWorld();
+	return world != nullptr ? world->GetTimeSeconds() : 0.0;
+}
@@ -0,0 +1,292 @@
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StaticArray.h"
+#include "Engine/DataTable.h"
+#include "RuneInternalScheduler.h"
+#include "RuneNativeInternalSchedulers.generated.h"
+
+
+UENUM(BlueprintType)
+enum class ERuneSchedulerAction : uint8
+{
+	/** Tick the scheduled configuration */
+	CONTINUE = 0,
+
+	/** Do not tick the scheduled configuration */
+	HOLD,
+
+	/** Schedule the first configuration, then tick it */
+	RESET,
+
+	/** Schedule the next configuration chosen by the scheduler, then tick it */
+	ADVANCE
+};
+
+/**
+ * Maps a task value to the action taken by a native scheduler.
+ * Can be used as the row of a data table.
+ */
+USTRUCT(BlueprintType)
+struct RUNESYSTEM_API FRuneSchedulerRule : public FTableRowBase
+{
+	GENERATED_BODY()
+
+	FRuneSchedulerRule() : taskValue(0), action(ERuneSchedulerAction::CONTINUE) {};
+	FRuneSchedulerRule(uint8 inTaskValue, ERuneSchedulerAction inAction) : taskValue(inTaskValue), action(inAction) {};
+
+	/** Underlying value of the task value, extended ones included (i.e. 1 for ERuneTaskValue::SUCCESS) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	uint8 taskValue;
+
+	/** Action taken when the active task has the task value */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	ERuneSchedulerAction action;
+};
+
+/**
+ * Base of the schedulers that run natively instead of through ReceiveScheduledRuneConfig.
+ *
+ * Task values are mapped to actions by rules, read from a data table and an inline list,
+ * which are compiled into a lookup table indexed by task value when configured.
+ * Scheduling a configuration is then a single lookup, with no Blueprint VM involved.
+ * Subclasses only choose which configuration comes next.
+ */
+UCLASS(Abstract)
+class RUNESYSTEM_API URuneNativeInternalScheduler : public URuneInternalScheduler
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	URuneNativeInternalScheduler();
+
+	virtual void Configure(int maxRuneConfigIndex) override;
+	virtual bool ScheduledRuneConfig(const URuneTask* activeRuneTask) override;
+
+	/**
+	 * Gets the action taken for a task value.
+	 *
+	 * @param taskValue Underlying value of the task value
+	 * @return Action mapped to the task value, defaultAction if there is none
+	 */
+	ERuneSchedulerAction GetAction(uint8 taskValue) const { return actionTable[taskValue]; };
+
+protected:
+	/**
+	 * Chooses the first configuration, scheduled when the scheduler is configured and on RESET.
+	 *
+	 * @return Index of the configuration, INDEX_NONE to not tick any configuration
+	 */
+	virtual int32 SelectFirstRuneConfig() { return 0; };
+
+	/**
+	 * Chooses the configuration scheduled on ADVANCE.
+	 *
+	 * @return Index of the configuration, INDEX_NONE to not tick any configuration
+	 */
+	virtual int32 SelectNextRuneConfig() { return scheduledRuneConfigIndex; };
+
+	/**
+	 * Called when the scheduled configuration is left by a RESET or an ADVANCE,
+	 * before choosing the configuration that follows.
+	 *
+	 * @param index Index of the configuration left
+	 */
+	virtual void OnRuneConfigLeft(int32 index) {};
+
+private:
+	/**
+	 * Schedules a configuration.
+	 *
+	 * @param index Index of the configuration, INDEX_NONE if none could be chosen
+	 * @return If true, the configuration can be ticked
+	 */
+	bool ScheduleRuneConfig(int32 index);
+
+	/** Fills the lookup table from the data table, then from the inline rules */
+	void CompileRules();
+
+public:
+	/** Action taken for task values without a rule */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "RuneInternalScheduler: General Settings")
+	ERuneSchedulerAction defaultAction;
+
+	/** Optional table of rules (rows of FRuneSchedulerRule), overridden by the inline rules */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "RuneInternalScheduler: General Settings", meta = (RequiredAssetDataTags = "RowStructure=/Script/RuneSystem.RuneSchedulerRule"))
+	TObjectPtr<UDataTable> rulesTable;
+
+	/** Rules mapping task values to actions */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "RuneInternalScheduler: General Settings")
+	TArray<FRuneSchedulerRule> rules;
+
+private:
+	/** Action of every possible task value, indexed by task value */
+	TStaticArray<ERuneSchedulerAction, 256> actionTable;
+
+	/** Whether no configuration could be scheduled, so a new one is chosen every time */
+	bool isWaitingRuneConfig;
+};
+
+/**
+ * Schedules the configurations in order, advancing on success and wrapping around after the last one.
+ */
+UCLASS(meta = (DisplayName = "Sequential Scheduler (Native)"))
+class RUNESYSTEM_API URuneSequentialScheduler : public URuneNativeInternalScheduler
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	URuneSequentialScheduler();
+
+protected:
+	virtual int32 SelectNextRuneConfig() override;
+
+public:
+	/** Whether the first configuration follows the last one. If false, the last configuration is kept */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "RuneInternalScheduler: General Settings")
+	bool loop;
+};
+
+/**
+ * Schedules the configurations in order, advancing on success and going back to the first one on failure.
+ */
+UCLASS(meta = (DisplayName = "Reset On Failure Scheduler (Native)"))
+class RUNESYSTEM_API URuneResetOnFailureScheduler : public URuneSequentialScheduler
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	URuneResetOnFailureScheduler();
+};
+
+UENUM()
+enum class ERuneWeightedSelection
+{
+	/** Draw a configuration at random, proportionally to its weight */
+	RANDOM = 0,
+
+	/** Choose the configuration with the highest weight, other than the scheduled one */
+	PRIORITY
+};
+
+/**
+ * Chooses the next configuration by weight, either at random or by priority.
+ */
+UCLASS(meta = (DisplayName = "Weighted Scheduler (Native)"))
+class RUNESYSTEM_API URuneWeightedScheduler : public URuneNativeInternalScheduler
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	URuneWeightedScheduler();
+
+	virtual void Configure(int maxRuneConfigIndex) override;
+
+protected:
+	virtual int32 SelectFirstRuneConfig() override;
+	virtual int32 SelectNextRuneConfig() override;
+
+private:
+	/**
+	 * Gets the weight of a configuration.
+	 *
+	 * @param index Index of the configuration
+	 * @return Weight, 1 for configurations without one
+	 */
+	float GetWeight(int32 index) const;
+
+	/**
+	 * Draws a configuration at random, proportionally to its weight.
+	 *
+	 * @param excludedIndex Index of a configuration that can not be drawn, INDEX_NONE for none
+	 * @return Index of the configuration, INDEX_NONE if every weight is 0
+	 */
+	int32 DrawRuneConfig(int32 excludedIndex) const;
+
+	/**
+	 * Finds the configuration with the highest weight, the first one on ties.
+	 *
+	 * @param excludedIndex Index of a configuration that can not be chosen, INDEX_NONE for none
+	 * @return Index of the configuration, INDEX_NONE if every weight is 0
+	 */
+	int32 FindPriorityRuneConfig(int32 excludedIndex) const;
+
+public:
+	/** How the next configuration is chosen */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "RuneInternalScheduler: General Settings")
+	ERuneWeightedSelection selection;
+
+	/** Weight of each configuration, by index. Missing weights are 1, and configurations weighing 0 are never chosen */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "RuneInternalScheduler: General Settings", meta = (ClampMin = "0.0"))
+	TArray<float> weights;
+
+	/** Whether the scheduled configuration can be drawn again by a random selection */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "RuneInternalScheduler: General Settings", meta = (EditCondition = "selection==ERuneWeightedSelection::RANDOM", EditConditionHides))
+	bool allowRepeat;
+
+private:
+	/** Sum of the weights of every configuration */
+	float totalWeight;
+};
+
+/**
+ * Schedules the configurations in order, advancing on success.
+ * Configurations cool down once left, and the ones cooling down are skipped.
+ * Nothing is ticked while every configuration is cooling down.
+ */
+UCLASS(meta = (DisplayName = "Round Robin Scheduler (Native)"))
+class RUNESYSTEM_API URuneRoundRobinScheduler : public URuneNativeInternalScheduler
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	URuneRoundRobinScheduler();
+
+	virtual void Configure(int maxRuneConfigIndex) override;
+
+	/**
+	 * Gets the time left for a configuration to cool down.
+	 *
+	 * @param index Index of the configuration
+	 * @return Time - in seconds - left, 0 if not cooling down
+	 */
+	UFUNCTION(BlueprintCallable)
+	float GetRemainingCooldown(int32 index) const;
+
+protected:
+	virtual int32 SelectFirstRuneConfig() override;
+	virtual int32 SelectNextRuneConfig() override;
+	virtual void OnRuneConfigLeft(int32 index) override;
+
+private:
+	/**
+	 * Finds the first configuration not cooling down, in order.
+	 *
+	 * @param startIndex Index of the first configuration to check
+	 * @return Index of the configuration, INDEX_NONE if all are cooling down
+	 */
+	int32 FindReadyRuneConfig(int32 startIndex) const;
+
+	/** Current time of the world, in seconds */
+	double GetCurrentTime() const;
+
+public:
+	/** Time - in seconds - a configuration cools down once left */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "RuneInternalScheduler: General Settings", meta = (ClampMin = "0.0", Units = "s"))
+	float cooldown;
+
+	/** Cooldown of each configuration, by index, overriding cooldown. Negative values are ignored */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "RuneInternalScheduler: General Settings")
+	TArray<float> cooldowns;
+
+private:
+	/** World time at which each configuration is ready again */
+	TArray<double> readyTimes;
+};
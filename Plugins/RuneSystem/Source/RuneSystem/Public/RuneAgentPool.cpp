@@ -0,0 +1,262 @@
+
+
+#include "RuneAgentPool.h"
+#include "RuneTangibleAgent.h"
+#include "RunePreviewAgent.h"
+#include "RuneBehaviour.h"
+#include "Utils/RuneTypes.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+
+static TAutoConsoleVariable<bool> CVarRuneAgentPoolEnabled(
+	TEXT("rune.AgentPool.Enabled"),
+	true,
+	TEXT("Whether poolable tangible agents are reused instead of spawned and destroyed."));
+
+static TAutoConsoleVariable<int32> CVarRuneAgentPoolMaxPerPool(
+	TEXT("rune.AgentPool.MaxPerPool"),
+	128,
+	TEXT("Number of inactive tangible agents kept per agent class and template. Released agents beyond it are destroyed."));
+
+
+URuneAgentPool::URuneAgentPool() :
+	pools(),
+	previewAgents()
+{
+}
+
+bool URuneAgentPool::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void URuneAgentPool::Deinitialize()
+{
+	// pooled agents are destroyed along with the world
+	pools.Empty();
+	previewAgents.Empty();
+
+	Super::Deinitialize();
+}
+
+ARuneTangibleAgent* URuneAgentPool::AcquireTangibleAgent(UClass* agentClass, uint32 templateHash)
+{
+	if (!CVarRuneAgentPoolEnabled.GetValueOnGameThread()) return nullptr;
+
+	TArray<TWeakObjectPtr<ARuneTangibleAgent>>* pool = pools.Find({ agentClass, templateHash });
+	if (pool == nullptr)
+	{
+		return nullptr;
+	}
+
+	// pooled agents could have been destroyed by someone else (e.g. level unload)
+	while (pool->Num() > 0)
+	{
+		ARuneTangibleAgent* agent = pool->Pop(false).Get();
+		if (IsValid(agent))
+		{
+			agent->isInPool = false;
+			return agent;
+		}
+	}
+
+	return nullptr;
+}
+
+void URuneAgentPool::ReleaseTangibleAgent(ARuneTangibleAgent& agent)
+{
+	if (agent.isInPool) return;
+
+	UWorld* world = GetWorld();
+	const bool canPool = CVarRuneAgentPoolEnabled.GetValueOnGameThread()
+		&& IsPoolable(agent.GetClass())
+		&& world != nullptr && !world->bIsTearingDown
+		&& agent.GetWorld() == world;
+
+	TArray<TWeakObjectPtr<ARuneTangibleAgent>>* pool = canPool ? &pools.FindOrAdd({ agent.GetClass(), agent.templateHash }) : nullptr;
+	if (pool == nullptr || pool->Num() >= CVarRuneAgentPoolMaxPerPool.GetValueOnGameThread())
+	{
+		agent.Destroy();
+		return;
+	}
+
+	agent.DeactivateAgent();
+	agent.isInPool = true;
+	pool->Add(&agent);
+}
+
+int32 URuneAgentPool::PrewarmTangibleAgents(TSubclassOf<ARuneTangibleAgent> agentClass, int32 count)
+{
+	// agents spawned from their class alone are pooled as a template without properties
+	FRuneTangibleAgentTemplate agentTemplate;
+	agentTemplate.agentClass = agentClass;
+	return PrewarmTangibleAgentsWithTemplate(agentTemplate, count);
+}
+
+int32 URuneAgentPool::PrewarmTangibleAgentsWithTemplate(const FRuneTangibleAgentTemplate& agentTemplate, int32 count)
+{
+	UWorld* world = GetWorld();
+	if (world == nullptr || count <= 0) return 0;
+
+	if (!IsPoolable(agentTemplate.agentClass))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[RuneAgentPool] PrewarmTangibleAgentsWithTemplate(): '%s' is not poolable."), *GetNameSafe(agentTemplate.agentClass));
+		return 0;
+	}
+
+	// same key the spawned agents are acquired with
+	const uint32 templateHash = GetTemplateHash(agentTemplate);
+	TArray<TWeakObjectPtr<ARuneTangibleAgent>>& pool = pools.FindOrAdd({ agentTemplate.agentClass.Get(), templateHash });
+	count = FMath::Min(count, CVarRuneAgentPoolMaxPerPool.GetValueOnGameThread() - pool.Num());
+
+	FActorSpawnParameters spawnInfo;
+	spawnInfo.bDeferConstruction = true;
+	spawnInfo.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	int32 prewarmed = 0;
+	for (; prewarmed < count; ++prewarmed)
+	{
+		ARuneTangibleAgent* agent = world->SpawnActor<ARuneTangibleAgent>(agentTemplate.agentClass, FTransform::Identity, spawnInfo);
+		if (agent == nullptr) break;
+
+		agent->templateHash = templateHash;
+		agentTemplate.ApplyProperties(*agent);
+		agent->FinishSpawning(FTransform::Identity);
+
+		ReleaseTangibleAgent(*agent);
+	}
+
+	return prewarmed;
+}
+
+ARunePreviewAgent* URuneAgentPool::AcquirePreviewAgent(const URuneBehaviour& behaviour, UClass* previewClass)
+{
+	if (!CVarRuneAgentPoolEnabled.GetValueOnGameThread()) return nullptr;
+
+	FPreviewAgents* agents = previewAgents.Find(&behaviour);
+	if (agents == nullptr)
+	{
+		return nullptr;
+	}
+
+	// behaviours use a handful of preview agents, linear search is fine
+	for (int32 i = agents->released.Num() - 1; i >= 0; --i)
+	{
+		ARunePreviewAgent* previewAgent = agents->released[i].Get();
+		if (!IsValid(previewAgent))
+		{
+			agents->released.RemoveAtSwap(i, 1, false);
+			continue;
+		}
+
+		if (previewAgent->GetClass() == previewClass)
+		{
+			agents->released.RemoveAtSwap(i, 1, false);
+			return previewAgent;
+		}
+	}
+
+	return nullptr;
+}
+
+void URuneAgentPool::TrackPreviewAgent(const URuneBehaviour& behaviour, ARunePreviewAgent& previewAgent)
+{
+	previewAgents.FindOrAdd(&behaviour).active.AddUnique(&previewAgent);
+}
+
+void URuneAgentPool::ReleasePreviewAgents(const URuneBehaviour& behaviour)
+{
+	FPreviewAgents* agents = previewAgents.Find(&behaviour);
+	if (agents == nullptr)
+	{
+		return;
+	}
+
+	const int32 maxPerPool = CVarRuneAgentPoolMaxPerPool.GetValueOnGameThread();
+	for (const TWeakObjectPtr<ARunePreviewAgent>& agent : agents->active)
+	{
+		ARunePreviewAgent* previewAgent = agent.Get();
+		if (!IsValid(previewAgent)) continue;
+
+		if (!CVarRuneAgentPoolEnabled.GetValueOnGameThread() || agents->released.Num() >= maxPerPool)
+		{
+			previewAgent->Destroy();
+			continue;
+		}
+
+		previewAgent->Hide();
+		previewAgent->ResetAgent();
+		agents->released.Add(previewAgent);
+	}
+	agents->active.Reset();
+}
+
+void URuneAgentPool::DestroyPreviewAgents(const URuneBehaviour& behaviour)
+{
+	FPreviewAgents agents;
+	if (!previewAgents.RemoveAndCopyValue(&behaviour, agents))
+	{
+		return;
+	}
+
+	// active ones could still be used by someone else, only destroy unused ones
+	for (const TWeakObjectPtr<ARunePreviewAgent>& agent : agents.released)
+	{
+		if (agent.IsValid())
+		{
+			agent->Destroy();
+		}
+	}
+}
+
+void URuneAgentPool::EmptyPools()
+{
+	for (TPair<FPoolKey, TArray<TWeakObjectPtr<ARuneTangibleAgent>>>& pair : pools)
+	{
+		for (const TWeakObjectPtr<ARuneTangibleAgent>& agent : pair.Value)
+		{
+			if (agent.IsValid())
+			{
+				agent->Destroy();
+			}
+		}
+	}
+	pools.Empty();
+
+	for (TPair<TObjectKey<URuneBehaviour>, FPreviewAgents>& pair : previewAgents)
+	{
+		for (const TWeakObjectPtr<ARunePreviewAgent>& agent : pair.Value.released)
+		{
+			if (agent.IsValid())
+			{
+				agent->Destroy();
+			}
+		}
+		pair.Value.released.Reset();
+	}
+}
+
+int32 URuneAgentPool::GetNumPooledTangibleAgents(TSubclassOf<ARuneTangibleAgent> agentClass) const
+{
+	int32 num = 0;
+	for (const TPair<FPoolKey, TArray<TWeakObjectPtr<ARuneTangibleAgent>>>& pair : pools)
+	{
+		if (agentClass == nullptr || pair.Key.agentClass == agentClass.Get())
+		{
+			num += pair.Value.Num();
+		}
+	}
+	return num;
+}
+
+uint32 URuneAgentPool::GetTemplateHash(const FRuneTangibleAgentTemplate& agentTemplate)
+{
+	return agentTemplate.GetPropertiesHash();
+}
+
+bool URuneAgentPool::IsPoolable(const UClass* agentClass)
+{
+	const ARuneTangibleAgent* defaultAgent = agentClass != nullptr ? Cast<ARuneTangibleAgent>(agentClass->GetDefaultObject()) : nullptr;
+	return defaultAgent != nullptr && defaultAgent->isPoolable;
+}
@@ -0,0 +1,171 @@
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "Utils/RuneTypes.h"
+#include "RuneAgentPool.generated.h"
+
+
+class ARuneTangibleAgent;
+class ARunePreviewAgent;
+class URuneBehaviour;
+
+/**
+ * Keeps inactive agents of its world so they can be reused
+ * instead of being spawned and destroyed over and over.
+ *
+ * Tangible agents are pooled per agent class and template properties, and only
+ * if their class is poolable (ARuneTangibleAgent::isPoolable).
+ * Preview agents are pooled per behaviour and preview class: once a behaviour
+ * hides its preview, the preview agents it spawned are reused the next time.
+ */
+UCLASS()
+class RUNESYSTEM_API URuneAgentPool : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this subsystem's properties
+	URuneAgentPool();
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Deinitialize() override;
+
+public:
+	/**
+	 * Gets a pooled agent, already reset but not activated yet.
+	 *
+	 * @param agentClass Class of the agent
+	 * @param templateHash Hash of the template properties used to initialize the agent, 0 if none
+	 * @return Pooled agent. If nullptr, a new agent should be spawned.
+	 */
+	ARuneTangibleAgent* AcquireTangibleAgent(UClass* agentClass, uint32 templateHash);
+
+	/**
+	 * Resets an agent and returns it to its pool.
+	 * If the agent can not be pooled, it is destroyed instead.
+	 *
+	 * @param agent Released agent
+	 */
+	void ReleaseTangibleAgent(ARuneTangibleAgent& agent);
+
+	/**
+	 * Spawns inactive agents in advance, reused by agents spawned from their class alone.
+	 *
+	 * @param agentClass Class of the agents. Must be poolable.
+	 * @param count Number of spawned agents
+	 * @return Number of agents added to the pool
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Rune System|Agent Pool")
+	int32 PrewarmTangibleAgents(TSubclassOf<ARuneTangibleAgent> agentClass, int32 count);
+
+	/**
+	 * Spawns inactive agents in advance, reused by agents spawned from an equivalent template.
+	 *
+	 * @param agentTemplate Template of the agents. Its class must be poolable.
+	 * @param count Number of spawned agents
+	 * @return Number of agents added to the pool
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Rune System|Agent Pool")
+	int32 PrewarmTangibleAgentsWithTemplate(const FRuneTangibleAgentTemplate& agentTemplate, int32 count);
+
+	/**
+	 * Gets a hidden preview agent previously spawned by a behaviour.
+	 *
+	 * @param behaviour Behaviour showing the preview
+	 * @param previewClass Class of the preview agent
+	 * @return Reused preview agent. If nullptr, a new preview agent should be spawned.
+	 */
+	ARunePreviewAgent* AcquirePreviewAgent(const URuneBehaviour& behaviour, UClass* previewClass);
+
+	/**
+	 * Registers a preview agent as being used by a behaviour,
+	 * so that it is released when the behaviour hides its preview.
+	 *
+	 * @param behaviour Behaviour showing the preview
+	 * @param previewAgent Spawned or reused preview agent
+	 */
+	void TrackPreviewAgent(const URuneBehaviour& behaviour, ARunePreviewAgent& previewAgent);
+
+	/**
+	 * Hides and resets all the preview agents used by a behaviour, making them reusable.
+	 *
+	 * @param behaviour Behaviour that has hidden its preview
+	 */
+	void ReleasePreviewAgents(const URuneBehaviour& behaviour);
+
+	/**
+	 * Destroys all the preview agents of a behaviour.
+	 *
+	 * @param behaviour Behaviour that is being destroyed
+	 */
+	void DestroyPreviewAgents(const URuneBehaviour& behaviour);
+
+	/**
+	 * Destroys every pooled agent.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Rune System|Agent Pool")
+	void EmptyPools();
+
+	/**
+	 * Gets the number of pooled agents of a given class.
+	 *
+	 * @param agentClass Class of the agents. If nullptr, all agents are counted.
+	 * @return Pooled agents
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Rune System|Agent Pool")
+	int32 GetNumPooledTangibleAgents(TSubclassOf<ARuneTangibleAgent> agentClass) const;
+
+	/**
+	 * Gets the (cached) hash of the properties of a template, used as part of the pool key.
+	 *
+	 * @param agentTemplate Agent template
+	 * @return Hash of the template properties, 0 if it has none
+	 */
+	static uint32 GetTemplateHash(const FRuneTangibleAgentTemplate& agentTemplate);
+
+	/**
+	 * Whether or not agents of a given class can be pooled.
+	 *
+	 * @param agentClass Class of the agents
+	 * @return If true, agents can be pooled
+	 */
+	static bool IsPoolable(const UClass* agentClass);
+
+private:
+	/** Pooled agents are indexed by class and template properties */
+	struct FPoolKey
+	{
+		TObjectKey<UClass> agentClass;
+		uint32 templateHash = 0;
+
+		bool operator==(const FPoolKey& other) const
+		{
+			return agentClass == other.agentClass && templateHash == other.templateHash;
+		}
+
+		friend uint32 GetTypeHash(const FPoolKey& key)
+		{
+			return HashCombine(GetTypeHash(key.agentClass), key.templateHash);
+		}
+	};
+
+	/** Preview agents of a behaviour */
+	struct FPreviewAgents
+	{
+		/** Spawned since the preview was last hidden */
+		TArray<TWeakObjectPtr<ARunePreviewAgent>> active;
+
+		/** Hidden, waiting to be reused */
+		TArray<TWeakObjectPtr<ARunePreviewAgent>> released;
+	};
+
+	/** Inactive agents per pool */
+	TMap<FPoolKey, TArray<TWeakObjectPtr<ARuneTangibleAgent>>> pools;
+
+	/** Preview agents per behaviour */
+	TMap<TObjectKey<URuneBehaviour>, FPreviewAgents> previewAgents;
+};
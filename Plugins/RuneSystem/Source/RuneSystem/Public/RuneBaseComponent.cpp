@@ -8,12 +8,28 @@
 #include "RuneEffect.h"
 #include "RuneInternalScheduler.h"
 #include "RuneTask.h"
+#include "RuneAgentPool.h"
+#include "RuneTangibleAgent.h"
+#include "RuneTickSubsystem.h"
+#include "Utils/RuneStats.h"
+#include "Engine/World.h"
 
 
-URuneBaseComponent::URuneBaseComponent()
+URuneBaseComponent::URuneBaseComponent() :
+	runeConfigurations(),
+	runeInternalScheduler(nullptr),
+	runeTasks(),
+	tickInterval(0.0f),
+	skipTickWhenIdle(false),
+	frameBudget(0.0f),
+	tickIndex(INDEX_NONE),
+	isTickBatched(false),
+	isSleeping(false),
+	isDeactivated(false),
+	validity(ERuneValidity::UNKNOWN)
 {
-	// do not tick, this component does only configuration stuff
-	// it does not contain behaviour by itself (at least for now)
+	// ticks the scheduled cast state machine, either by itself
+	// or batched with every other rune by URuneTickSubsystem
 	PrimaryComponentTick.bCanEverTick = true;
 }
 
@@ -23,10 +39,127 @@ void URuneBaseComponent::BeginPlay()
 
 	// configure all relationships between components
 	Configure();
+
+	PrewarmAgents();
+
+	// let the tick subsystem tick this rune along with the rest
+	UWorld* world = GetWorld();
+	URuneTickSubsystem* tickSubsystem = world != nullptr && URuneTickSubsystem::IsEnabled() ? world->GetSubsystem<URuneTickSubsystem>() : nullptr;
+	if (tickSubsystem != nullptr && tickSubsystem->RegisterRune(*this))
+	{
+		isTickBatched = true;
+		SetComponentTickEnabled(false);
+	}
+
+	// sleeping runes are woken up by their cast state machines
+	for (const FRuneConfiguration& rc : runeConfigurations)
+	{
+		if (rc.runeCastStateMachine == nullptr) continue;
+
+		rc.runeCastStateMachine->onWakeUp.AddUObject(this, &URuneBaseComponent::WakeUp);
+	}
+}
+
+void URuneBaseComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UWorld* world = GetWorld();
+	URuneTickSubsystem* tickSubsystem = world != nullptr ? world->GetSubsystem<URuneTickSubsystem>() : nullptr;
+	if (tickSubsystem != nullptr)
+	{
+		tickSubsystem->UnregisterRune(*this);
+	}
+	isTickBatched = false;
+	isSleeping = false;
+
+	for (const FRuneConfiguration& rc : runeConfigurations)
+	{
+		if (rc.runeCastStateMachine == nullptr) continue;
+
+		rc.runeCastStateMachine->onWakeUp.RemoveAll(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void URuneBaseComponent::OnComponentDestroyed(bool bDestroyingHierarchy)
+{
+	Super::OnComponentDestroyed(bDestroyingHierarchy);
+
+	// a destroyed rune can not be pressed nor ticked anymore
+	validity = ERuneValidity::DESTROYED;
 }
 
 void URuneBaseComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
+	// batched runes are ticked by URuneTickSubsystem, even if their own tick got enabled again
+	if (isTickBatched)
+	{
+		SetComponentTickEnabled(false);
+		return;
+	}
+
+	TickRune(DeltaTime);
+}
+
+void URuneBaseComponent::Activate(bool bReset)
+{
+	const bool wasActive = IsActive();
+	Super::Activate(bReset);
+	if (wasActive || !IsActive()) return;
+
+	isDeactivated = false;
+	if (!isTickBatched) return;
+
+	// activating enables the own tick, batched runes go back to the subsystem instead
+	SetComponentTickEnabled(false);
+	if (isSleeping) return;
+
+	UWorld* world = GetWorld();
+	URuneTickSubsystem* tickSubsystem = world != nullptr ? world->GetSubsystem<URuneTickSubsystem>() : nullptr;
+	if (tickSubsystem != nullptr)
+	{
+		tickSubsystem->RegisterRune(*this);
+	}
+}
+
+void URuneBaseComponent::Deactivate()
+{
+	const bool wasActive = IsActive();
+	Super::Deactivate();
+	if (!wasActive || IsActive()) return;
+
+	isDeactivated = true;
+	if (!isTickBatched) return;
+
+	UWorld* world = GetWorld();
+	URuneTickSubsystem* tickSubsystem = world != nullptr ? world->GetSubsystem<URuneTickSubsystem>() : nullptr;
+	if (tickSubsystem != nullptr)
+	{
+		tickSubsystem->UnregisterRune(*this);
+	}
+}
+
+void URuneBaseComponent::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+
+	SIZE_T allocatedSize = runeConfigurations.GetAllocatedSize() + runeTasks.GetAllocatedSize();
+	for (const FRuneConfiguration& rc : runeConfigurations)
+	{
+		allocatedSize += rc.runeBehavioursWithEffects.GetAllocatedSize() + rc.prewarmedAgents.GetAllocatedSize();
+		for (const FRuneBehaviourWithEffects& rb : rc.runeBehavioursWithEffects)
+		{
+			allocatedSize += rb.runeEffects.GetAllocatedSize();
+		}
+	}
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(allocatedSize);
+}
+
+void URuneBaseComponent::TickRune(float DeltaTime)
+{
+	RUNE_SCOPE_CYCLE_COUNTER(STAT_RuneTick, "URuneBaseComponent::TickRune");
+	RUNE_SCOPE_PROFILE_PHASE(RUNE_TICK);
+
 	if (IsValid())
 	{
 		if (runeInternalScheduler != nullptr)
@@ -40,7 +173,8 @@ void URuneBaseComponent::TickComponent(float DeltaTime, ELevelTick TickType, FAc
 				scheduledRuneConfigIndex = runeInternalScheduler->GetScheduledRuneConfigIndex();
 				if (scheduledRuneConfigIndex >= 0 && scheduledRuneConfigIndex < runeConfigurations.Num()) 
 				{
-					runeConfigurations[scheduledRuneConfigIndex].runeCastStateMachine->TickCastStateMachine(DeltaTime, TickType, ThisTickFunction);
+					RUNE_SCOPE_COST(FRuneCostOwner(this, scheduledRuneConfigIndex), CAST_TICK);
+					runeConfigurations[scheduledRuneConfigIndex].runeCastStateMachine->TickCastStateMachine(DeltaTime, LEVELTICK_All, nullptr);
 				}
 			}
 				
@@ -52,9 +186,12 @@ void URuneBaseComponent::TickComponent(float DeltaTime, ELevelTick TickType, FAc
 		else
 		{
 			// A valid rune always has, at least, one configuration, making this call safe
-			runeConfigurations[0].runeCastStateMachine->TickCastStateMachine(DeltaTime, TickType, ThisTickFunction);
+			RUNE_SCOPE_COST(FRuneCostOwner(this, 0), CAST_TICK);
+			runeConfigurations[0].runeCastStateMachine->TickCastStateMachine(DeltaTime, LEVELTICK_All, nullptr);
 		}
-	}	
+	}
+
+	TrySleep();
 }
 
 
@@ -78,16 +215,77 @@ void URuneBaseComponent::Release()
 
 bool URuneBaseComponent::IsValid() const
 {
-	bool isValid = runeConfigurations.Num() > 0;
-	for (int i = 0; i < runeConfigurations.Num() && isValid; i++)
+	return GetValidity() == ERuneValidity::VALID;
+}
+
+ERuneValidity URuneBaseComponent::GetValidity() const
+{
+	if (validity == ERuneValidity::UNKNOWN)
+	{
+		validity = ComputeValidity();
+	}
+	return validity;
+}
+
+void URuneBaseComponent::InvalidateValidity()
+{
+	OnLinkedBehavioursChanged();
+}
+
+bool URuneBaseComponent::IsIdle() const
+{
+	if (!IsValid()) return true;
+
+	for (const FRuneConfiguration& rc : runeConfigurations)
 	{
-		isValid &= runeConfigurations[i].isValid();
+		if (!rc.runeCastStateMachine->IsIdle()) return false;
 	}
-	if (isValid && runeInternalScheduler != nullptr)
+
+	return true;
+}
+
+void URuneBaseComponent::TrySleep()
+{
+	if (isSleeping || !URuneTickSubsystem::IsSleepAllowed()) return;
+	if (runeInternalScheduler != nullptr || !IsValid()) return;
+	if (runeConfigurations[0].runeCastStateMachine->NeedsTick()) return;
+
+	isSleeping = true;
+	if (!isTickBatched)
+	{
+		SetComponentTickEnabled(false);
+		return;
+	}
+
+	UWorld* world = GetWorld();
+	URuneTickSubsystem* tickSubsystem = world != nullptr ? world->GetSubsystem<URuneTickSubsystem>() : nullptr;
+	if (tickSubsystem != nullptr)
 	{
-		isValid &= runeConfigurations.Num() == runeTasks.Num();
+		tickSubsystem->UnregisterRune(*this);
+	}
+}
+
+void URuneBaseComponent::WakeUp()
+{
+	if (!isSleeping) return;
+
+	isSleeping = false;
+
+	// deactivated runes start ticking once activated again
+	if (isDeactivated) return;
+
+	if (!isTickBatched)
+	{
+		SetComponentTickEnabled(true);
+		return;
+	}
+
+	UWorld* world = GetWorld();
+	URuneTickSubsystem* tickSubsystem = world != nullptr ? world->GetSubsystem<URuneTickSubsystem>() : nullptr;
+	if (tickSubsystem != nullptr)
+	{
+		tickSubsystem->RegisterRune(*this);
 	}
-	return isValid;
 }
 
 void URuneBaseComponent::SetOwner(IRuneCompatible* owner)
@@ -125,17 +323,25 @@ void URuneBaseComponent::Configure() const
 	int index = 0;
 	for (const FRuneConfiguration& rc : runeConfigurations)
 	{
+		const FRuneCostOwner costOwner(this, index);
 		TArray<URuneBehaviour*> behaviours;
 		for (const FRuneBehaviourWithEffects& rb : rc.runeBehavioursWithEffects)
 		{
 			behaviours.Add(rb.runeBehaviour);
+			rb.runeBehaviour->SetLinkedEffects(rb.runeEffects);
+			rb.runeBehaviour->costOwner = costOwner;
 			for (URuneEffect* effect : rb.runeEffects)
 			{
-				rb.runeBehaviour->onApplyPulse.AddDynamic(effect, &URuneEffect::InternalApply);
-				rb.runeBehaviour->onRevertPulse.AddDynamic(effect, &URuneEffect::InternalRevert);
+				effect->costOwner = costOwner;
 			}
 		}
 		rc.runeCastStateMachine->SetLinkedBehaviour(behaviours);
+
+		// behaviours unlinked later on are destroyed, which invalidates the rune
+		if (!rc.runeCastStateMachine->onLinkedBehavioursChanged.IsBoundToObject(this))
+		{
+			rc.runeCastStateMachine->onLinkedBehavioursChanged.AddUObject(this, &URuneBaseComponent::OnLinkedBehavioursChanged);
+		}
 		if (runeTasks[index] != nullptr)
 		{
 			runeTasks[index]->Configure(rc);
@@ -148,22 +354,78 @@ void URuneBaseComponent::Configure() const
 	}
 }
 
+void URuneBaseComponent::PrewarmAgents() const
+{
+	UWorld* world = GetWorld();
+	URuneAgentPool* agentPool = world != nullptr ? world->GetSubsystem<URuneAgentPool>() : nullptr;
+	if (agentPool == nullptr)
+	{
+		return;
+	}
+
+	for (const FRuneConfiguration& rc : runeConfigurations)
+	{
+		for (const FRunePrewarmedAgents& prewarmed : rc.prewarmedAgents)
+		{
+			agentPool->PrewarmTangibleAgentsWithTemplate(prewarmed.agentTemplate, prewarmed.count);
+		}
+	}
+}
+
 bool URuneBaseComponent::Validate() const
 {
-	// log everything that is wrong, then return if it is valid or not.
-	bool valid = IsValid();
-	if (!valid)
+	validity = ComputeValidity();
+	if (validity != ERuneValidity::VALID)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[RuneBaseComponent] Validate(): '%s' in '%s' is not valid (%s)."),
+			*GetName(), *GetNameSafe(GetOwner()), *UEnum::GetDisplayValueAsText(validity).ToString());
+	}
+
+	return validity == ERuneValidity::VALID;
+}
+
+ERuneValidity URuneBaseComponent::ComputeValidity() const
+{
+	if (validity == ERuneValidity::DESTROYED) return ERuneValidity::DESTROYED;
+	if (runeConfigurations.Num() <= 0) return ERuneValidity::NO_CONFIGURATIONS;
+
+	for (const FRuneConfiguration& rc : runeConfigurations)
+	{
+		if (!::IsValid(rc.runeCastStateMachine)) return ERuneValidity::MISSING_CAST_STATE_MACHINE;
+
+		for (const FRuneBehaviourWithEffects& rb : rc.runeBehavioursWithEffects)
+		{
+			if (!::IsValid(rb.runeBehaviour)) return ERuneValidity::MISSING_BEHAVIOUR;
+			if (rb.runeEffects.Num() <= 0) return ERuneValidity::MISSING_EFFECT;
+
+			for (const URuneEffect* runeEffect : rb.runeEffects)
+			{
+				if (!::IsValid(runeEffect)) return ERuneValidity::MISSING_EFFECT;
+			}
+		}
+	}
+
+	if (runeInternalScheduler != nullptr && runeConfigurations.Num() != runeTasks.Num())
 	{
-		//LOG_WARNING("Error while validating '%s', one or more runeBehaviours are not properly set", *GetOwner()->GetName());
+		return ERuneValidity::MISSING_TASKS;
 	}
 
-	return valid;
+	return ERuneValidity::VALID;
+}
+
+void URuneBaseComponent::OnLinkedBehavioursChanged() const
+{
+	// destruction is final
+	if (validity == ERuneValidity::DESTROYED) return;
+
+	validity = ERuneValidity::UNKNOWN;
 }
 
 #if WITH_EDITOR
 void URuneBaseComponent::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
 {
 	Super::PostEditChangeProperty(PropertyChangedEvent);
+	InvalidateValidity();
 	if (PropertyChangedEvent.GetPropertyName() == GET_MEMBER_NAME_CHECKED(URuneBaseComponent, runeConfigurations))
 	{
 		if (runeConfigurations.Num() <= 0)
@@ -188,6 +450,7 @@ void URuneBaseComponent::PostEditChangeProperty(FPropertyChangedEvent& PropertyC
 void URuneBaseComponent::PostEditChangeChainProperty(FPropertyChangedChainEvent& PropertyChangedChainEvent)
 {
 	Super::PostEditChangeChainProperty(PropertyChangedChainEvent);
+	InvalidateValidity();
 	if (PropertyChangedChainEvent.GetPropertyName() == GET_MEMBER_NAME_CHECKED(FRuneConfiguration, runeCastStateMachine))
 	{
 		int32 index = PropertyChangedChainEvent.GetArrayIndex(GET_MEMBER_NAME_CHECKED(URuneBaseComponent, runeConfigurations).ToString());
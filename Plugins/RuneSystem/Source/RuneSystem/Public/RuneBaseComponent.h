@@ -11,6 +11,35 @@
 class IRuneCompatible;
 class URuneInternalScheduler;
 class URuneTask;
+class URuneTickSubsystem;
+
+UENUM(BlueprintType)
+enum class ERuneValidity : uint8
+{
+	/** Not validated since it was last invalidated */
+	UNKNOWN = 0			UMETA(Hidden),
+
+	/** The rune can be formed */
+	VALID,
+
+	/** There are no rune configurations */
+	NO_CONFIGURATIONS,
+
+	/** A rune configuration has no cast state machine */
+	MISSING_CAST_STATE_MACHINE,
+
+	/** A rune configuration has a missing or destroyed behaviour */
+	MISSING_BEHAVIOUR,
+
+	/** A behaviour has no effects or a missing or destroyed one */
+	MISSING_EFFECT,
+
+	/** There is an internal scheduler but not a rune task per configuration */
+	MISSING_TASKS,
+
+	/** The rune component has been destroyed */
+	DESTROYED
+};
 
 USTRUCT(Blueprintable, BlueprintType)
 struct FRuneBehaviourWithEffects
@@ -59,6 +88,21 @@ struct FRuneBehaviourWithEffects
 	}
 };
 
+/** Poolable tangible agents spawned in advance, see URuneAgentPool::PrewarmTangibleAgentsWithTemplate() */
+USTRUCT(BlueprintType)
+struct FRunePrewarmedAgents
+{
+	GENERATED_BODY()
+
+	/** Template the agents are spawned with, pooled along with its properties */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	FRuneTangibleAgentTemplate agentTemplate;
+
+	/** Number of agents spawned */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta = (ClampMin = "0"))
+	int32 count = 0;
+};
+
 USTRUCT(Blueprintable, BlueprintType)
 struct FRuneConfiguration
 {
@@ -72,6 +116,14 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "RuneBase: General Settings", EditFixedSize, meta = (ShowOnlyInnerProperties))
 	TArray<FRuneBehaviourWithEffects> runeBehavioursWithEffects;
 
+	/**
+	 * Poolable tangible agents spawned in advance when the game starts, per agent template.
+	 * Avoids spawning agents during the first casts of projectile-heavy runes.
+	 * Templates should match the ones the behaviours spawn, since agents are pooled per template properties.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "RuneBase: Advanced Settings")
+	TArray<FRunePrewarmedAgents> prewarmedAgents;
+
 	bool isValid() const
 	{
 		bool isValid = true;
@@ -97,10 +149,28 @@ public:
 protected:
 	// Called when the game starts
 	virtual void BeginPlay() override;
+	// Called when the game ends or the component is destroyed
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	// Called when the component is destroyed
+	virtual void OnComponentDestroyed(bool bDestroyingHierarchy) override;
 
 public:
-	// Called every frame
+	// Called every frame, unless ticked by URuneTickSubsystem
 	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	// Called when the rune is activated, batched runes go back to URuneTickSubsystem
+	virtual void Activate(bool bReset = false) override;
+	// Called when the rune is deactivated, batched runes leave URuneTickSubsystem
+	virtual void Deactivate() override;
+
+	// Adds the memory of the configurations and tasks
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+
+	/**
+	 * Ticks the internal scheduler and the scheduled cast state machine.
+	 *
+	 * @param DeltaTime Time - in seconds - since the rune last ticked
+	 */
+	void TickRune(float DeltaTime);
 	/**
 	 * Sets cast state machine internal variable to pressed,
 	 * potentially altering state
@@ -116,12 +186,47 @@ public:
 
 	/**
 	 * Checks for the integrity of the rune.
+	 * The result is cached until the rune is invalidated.
 	 *
 	 * @return If true, the rune is valid
 	 */
 	UFUNCTION(BlueprintCallable)
 	bool IsValid() const;
 
+	/**
+	 * Gets the cached integrity of the rune, validating it if needed.
+	 *
+	 * @return VALID, or the reason why the rune is not valid
+	 */
+	UFUNCTION(BlueprintCallable)
+	ERuneValidity GetValidity() const;
+
+	/**
+	 * Discards the cached integrity of the rune, so that it is validated again
+	 * the next time it is queried. Call it after changing the rune configurations at runtime.
+	 * Linked behaviours and effects call it when destroyed.
+	 */
+	UFUNCTION(BlueprintCallable)
+	void InvalidateValidity();
+
+	/**
+	 * Whether every cast state machine of the rune is idle,
+	 * waiting in its entry state to be pressed.
+	 *
+	 * @return If true, the rune can skip its tick
+	 */
+	UFUNCTION(BlueprintCallable)
+	bool IsIdle() const;
+
+	/**
+	 * Whether the rune has stopped ticking until one of its
+	 * cast state machines is woken up.
+	 *
+	 * @return If true, the rune is not ticking
+	 */
+	UFUNCTION(BlueprintCallable)
+	bool IsSleeping() const { return isSleeping; };
+
 	/**
 	 * Configures the owner that controls the current rune.
 	 *
@@ -136,14 +241,40 @@ private:
 	 */
 	void Configure() const;
 
+	/**
+	 * Fills the agent pools with the prewarmed agents
+	 * of every rune configuration.
+	 */
+	void PrewarmAgents() const;
+
 	/**
 	 * Validates the integrity of the components and
-	 * that it is possible to form the rune.
+	 * that it is possible to form the rune, caching the result.
+	 * Logs why the rune is not valid otherwise.
 	 *
 	 * @return If true, validation ended succesfully
 	 */
 	bool Validate() const;
 
+	/**
+	 * Walks every rune configuration looking for missing components.
+	 *
+	 * @return VALID, or the first reason found why the rune is not valid
+	 */
+	ERuneValidity ComputeValidity() const;
+
+	/** Invalidates the rune when a cast state machine changes its linked behaviours */
+	void OnLinkedBehavioursChanged() const;
+
+	/**
+	 * Stops ticking the rune if none of its cast state machines needs to tick.
+	 * Runes with an internal scheduler never sleep, since it has to be evaluated every tick.
+	 */
+	void TrySleep();
+
+	/** Starts ticking the rune again when one of its cast state machines is woken up */
+	void WakeUp();
+
 public:
 
 	/**
@@ -168,6 +299,46 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "RuneBase: Advanced Settings", Instanced, EditFixedSize, meta = (ShowOnlyInnerProperties, EditCondition = "runeInternalScheduler!=nullptr", EditConditionHides))
 	TArray<URuneTask*> runeTasks;
 
+	/**
+	 * Minimum time - in seconds - between ticks of the rune when ticked by URuneTickSubsystem.
+	 * If 0, the rune ticks every frame.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "RuneBase: Advanced Settings", meta = (ClampMin = "0.0", Units = "s"))
+	float tickInterval;
+
+	/**
+	 * Whether the rune should not tick while idle (see IsIdle()) when ticked by URuneTickSubsystem.
+	 * Only enable it if the entry states of the cast state machines do nothing on tick,
+	 * since neither they nor the internal scheduler and its tasks are ticked meanwhile.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "RuneBase: Advanced Settings")
+	bool skipTickWhenIdle;
+
+	/**
+	 * Time - in milliseconds - the rune may spend per frame before being logged, while rune.Profile.Enabled is set.
+	 * Includes cast ticks, pulses and effect applications of every configuration. If 0, the rune has no budget.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "RuneBase: Advanced Settings", meta = (ClampMin = "0.0", Units = "ms"))
+	float frameBudget;
+
+private:
+	/** Index of the rune in URuneTickSubsystem, INDEX_NONE if not registered, sleeping or deactivated */
+	int32 tickIndex;
+
+	/** Whether the rune is ticked by URuneTickSubsystem instead of by itself */
+	bool isTickBatched;
+
+	/** Whether the rune has stopped ticking until woken up */
+	bool isSleeping;
+
+	/** Whether the rune has been deactivated, it does not tick until activated again */
+	bool isDeactivated;
+
+	/** Cached integrity of the rune, UNKNOWN until validated */
+	mutable ERuneValidity validity;
+
+	friend class URuneTickSubsystem;
+
 
 protected:
 
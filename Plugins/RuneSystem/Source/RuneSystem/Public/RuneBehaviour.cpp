@@ -2,13 +2,19 @@
 
 
 #include "RuneBehaviour.h"
+#include "RuneBaseComponent.h"
 #include "RuneCompatible.h"
+#include "RuneEffect.h"
 #include "RuneTangibleAgent.h"
 #include "Utils/RuneUtils.h"
+#include "RuneAgentPool.h"
+#include "Utils/RuneStats.h"
 
 
 URuneBehaviour::URuneBehaviour() :
 	runeOwner(nullptr),
+	linkedRuneEffects(),
+	costOwner(),
 	isPreviewShowing(false)
 {
 	// Set this component to be initialized when the game starts, and to be ticked every frame.  You can turn these features
@@ -21,6 +27,28 @@ void URuneBehaviour::BeginPlay()
 	Super::BeginPlay();
 }
 
+void URuneBehaviour::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UWorld* world = GetWorld();
+	if (URuneAgentPool* agentPool = world != nullptr ? world->GetSubsystem<URuneAgentPool>() : nullptr)
+	{
+		agentPool->DestroyPreviewAgents(*this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void URuneBehaviour::OnComponentDestroyed(bool bDestroyingHierarchy)
+{
+	Super::OnComponentDestroyed(bDestroyingHierarchy);
+
+	// the cached validity of the rune no longer holds
+	if (URuneBaseComponent* rune = costOwner.rune.ResolveObjectPtr())
+	{
+		rune->InvalidateValidity();
+	}
+}
+
 void URuneBehaviour::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
@@ -31,6 +59,13 @@ void URuneBehaviour::TickComponent(float DeltaTime, ELevelTick TickType, FActorC
 	}
 }
 
+void URuneBehaviour::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(linkedRuneEffects.GetAllocatedSize());
+}
+
 void URuneBehaviour::ActivateBehaviour()
 {
 	// by default calls the blueprint version
@@ -78,6 +113,23 @@ bool URuneBehaviour::IsPreviewShowing() const
 	return isPreviewShowing;
 }
 
+void URuneBehaviour::SetLinkedEffects(const TArray<URuneEffect*>& runeEffects)
+{
+	linkedRuneEffects.Reset(runeEffects.Num());
+	for (URuneEffect* effect : runeEffects)
+	{
+		if (effect != nullptr)
+		{
+			linkedRuneEffects.Add(effect);
+		}
+	}
+}
+
+const TArray<URuneEffect*>& URuneBehaviour::GetLinkedEffects() const
+{
+	return linkedRuneEffects;
+}
+
 ARuneTangibleAgent* URuneBehaviour::SpawnTangibleAgent(UClass* inClass, const FTransform& transform)
 {
 	//ASSERT(inClass != nullptr, "Tangible agent class has not been properly set");
@@ -134,12 +186,30 @@ ARunePreviewAgent* URuneBehaviour::SpawnPreviewAgentWithTemplate(const FRuneTang
 
 bool URuneBehaviour::BroadcastApplyPulse(AActor* actor) const
 {
+	RUNE_SCOPE_CYCLE_COUNTER(STAT_RuneBroadcastApplyPulse, "URuneBehaviour::BroadcastApplyPulse");
+	RUNE_SCOPE_PROFILE_PHASE(APPLY_PULSE);
+	RUNE_SCOPE_COST(costOwner, PULSE);
+	RUNE_INC_COUNTER(STAT_RunePulses);
+
 	bool success = false;
 	FBooleanPtr successPtr({ &success });
 
-	if (onApplyPulse.IsBound() && runeOwner != nullptr)
+	if (runeOwner != nullptr)
 	{
-		onApplyPulse.Broadcast(runeOwner->GetController(), (AActor*) runeOwner->GetController(), actor, successPtr);
+		AController* controller = runeOwner->GetController();
+
+		// native fast path, no reflection involved
+		for (URuneEffect* effect : linkedRuneEffects)
+		{
+			if (!IsValid(effect)) continue;
+
+			effect->InternalApply(controller, (AActor*) controller, actor, successPtr);
+		}
+
+		if (onApplyPulse.IsBound())
+		{
+			onApplyPulse.Broadcast(controller, (AActor*) controller, actor, successPtr);
+		}
 	}
 	onApplyPulseBroadcast.Broadcast(actor, success);
 
@@ -151,6 +221,14 @@ bool URuneBehaviour::BroadcastRevertPulse(AActor* actor) const
 	bool success = false;
 	FBooleanPtr successPtr({ &success });
 
+	// native fast path, no reflection involved
+	for (URuneEffect* effect : linkedRuneEffects)
+	{
+		if (!IsValid(effect)) continue;
+
+		effect->InternalRevert(actor, successPtr);
+	}
+
 	if (onRevertPulse.IsBound())
 	{
 		onRevertPulse.Broadcast(actor, successPtr);
@@ -193,6 +271,16 @@ bool URuneBehaviour::InternalShowPreview()
 	return false;
 }
 
+void URuneBehaviour::ReleasePreviewAgents()
+{
+	// preview agents spawned while showing are reused next time
+	UWorld* world = GetWorld();
+	if (URuneAgentPool* agentPool = world != nullptr ? world->GetSubsystem<URuneAgentPool>() : nullptr)
+	{
+		agentPool->ReleasePreviewAgents(*this);
+	}
+}
+
 bool URuneBehaviour::InternalHidePreview()
 {
 	if (isPreviewShowing)
@@ -200,6 +288,7 @@ bool URuneBehaviour::InternalHidePreview()
 		onHidePreviewBegin.Broadcast();
 		HidePreview();
 		isPreviewShowing = false;
+		ReleasePreviewAgents();
 		onHidePreviewEnd.Broadcast();
 
 		return true;
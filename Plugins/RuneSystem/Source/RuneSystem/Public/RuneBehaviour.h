@@ -5,10 +5,12 @@
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
 #include "Utils/RuneTypes.h"
+#include "RuneCostAccounting.h"
 #include "RuneBehaviour.generated.h"
 
 
 class IRuneCompatible;
+class URuneEffect;
 class ARuneTangibleAgent;
 class ARunePreviewAgent;
 
@@ -34,10 +36,19 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	// Called when the behaviour is removed from play, destroys its reusable preview agents
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Called when the behaviour is destroyed, invalidates the rune linking it
+	virtual void OnComponentDestroyed(bool bDestroyingHierarchy) override;
+
 public:
 	// Called every frame
 	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 
+	// Adds the memory of the linked effects
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+
 public:
 	/**
 	 * Resets the state of the behaviour that gets modified
@@ -84,6 +95,22 @@ public:
 	UFUNCTION(BlueprintCallable)
 	virtual bool IsPreviewShowing() const;
 
+	/**
+	 * Sets the effects that will receive the pulses of this behaviour.
+	 * Linked effects are invoked natively, without going through onApplyPulse/onRevertPulse.
+	 *
+	 * @param runeEffects Linked effects
+	 */
+	void SetLinkedEffects(const TArray<URuneEffect*>& runeEffects);
+
+	/**
+	 * Gets the effects that receive the pulses of this behaviour.
+	 *
+	 * @return Linked effects
+	 */
+	UFUNCTION(BlueprintCallable)
+	const TArray<URuneEffect*>& GetLinkedEffects() const;
+
 protected:
 	/**
 	 * Manages the activation of the behaviour.
@@ -279,12 +306,21 @@ private:
 	/** Intermediate ShowPreview() method used for delegate broadcasting coherence */
 	bool InternalHidePreview();
 
+	/** Makes the preview agents spawned while showing the preview reusable */
+	void ReleasePreviewAgents();
+
 public:
-	/** Called when a behaviour should send an apply pulse to an actor */
+	/**
+	 * Called when a behaviour should send an apply pulse to an actor.
+	 * Linked effects do NOT listen to it, they are invoked natively beforehand.
+	 */
 	UPROPERTY()
 	FRunePulseDelegate onApplyPulse;
 
-	/** Called when a behaviour should send a revert pulse to an actor */
+	/**
+	 * Called when a behaviour should send a revert pulse to an actor.
+	 * Linked effects do NOT listen to it, they are invoked natively beforehand.
+	 */
 	UPROPERTY()
 	FRuneRevertDelegate onRevertPulse;
 
@@ -344,11 +380,19 @@ protected:
 	friend class URuneBaseComponent;
 	friend class URuneCastStateMachine;
 	friend class URuneUtils;
+	friend class FRuneMemoryReport;
 
 	/** Cached owner. It could be nullptr. */
 	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category = "RuneBehaviour: Debug Variables")
 	TScriptInterface<IRuneCompatible> runeOwner;
 
+	/** Effects receiving the pulses, resolved when the rune is configured */
+	UPROPERTY(VisibleInstanceOnly, Category = "RuneBehaviour: Debug Variables")
+	TArray<URuneEffect*> linkedRuneEffects;
+
+	/** Rune configuration the costs of the behaviour are accounted to, set when the rune is configured */
+	FRuneCostOwner costOwner;
+
 private:
 	bool isPreviewShowing;
 
@@ -3,18 +3,38 @@
 
 #include "RuneCastStateMachine.h"
 #include "RuneBehaviour.h"
+#include "Utils/RuneStats.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
 
 
+void UState::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(onTick.GetAllocatedSize() + onEnter.GetAllocatedSize() + onExit.GetAllocatedSize());
+}
+
 URuneCastStateMachine::URuneCastStateMachine() : 
 	transitionPolicy(ETransitionPolicy::END_TICK),
+	flushPolicy(ETransitionFlushPolicy::ONE_PER_TICK),
+	transitionBudget(2),
 	hasMultipleSlots(false),
 	slots(1),
 	fixedSlotCount(false),
 	currentState(nullptr),
 	isPressed(false),
+	wasPressedSinceTick(false),
+	wasReleasedSinceTick(false),
 	_entryState(nullptr),
 	_states(),
+	_statesByName(),
 	_pendingStates(),
+	_droppedPendingStates(0),
+	_isWokenUp(false),
+	_wakeUpTimerHandle(),
+	_stateGraph(),
+	_timeInState(0.0f),
 	runeBehaviours()
 {
 	// should tick to update the owned states
@@ -54,45 +74,80 @@ void URuneCastStateMachine::BeginPlay()
 	Init();
 }
 
+void URuneCastStateMachine::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+
+	SIZE_T allocatedSize = _states.GetAllocatedSize() + _statesByName.GetAllocatedSize() + _stateGraph.GetAllocatedSize() + runeBehaviours.GetAllocatedSize();
+	for (const TPair<FName, TArray<UState*, TInlineAllocator<1>>>& pair : _statesByName)
+	{
+		allocatedSize += pair.Value.GetAllocatedSize();
+	}
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(allocatedSize);
+
+	// states are owned by the state machine
+	if (CumulativeResourceSize.GetResourceSizeMode() == EResourceSizeMode::EstimatedTotal)
+	{
+		for (UState* state : _states)
+		{
+			if (state != nullptr)
+			{
+				state->GetResourceSizeEx(CumulativeResourceSize);
+			}
+		}
+	}
+}
+
 void URuneCastStateMachine::TickCastStateMachine(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
+	RUNE_SCOPE_CYCLE_COUNTER(STAT_RuneCastStateMachineTick, "URuneCastStateMachine::TickCastStateMachine");
+	RUNE_SCOPE_PROFILE_PHASE(CAST_STATE_MACHINE_TICK);
+
+	// from now on, only pending states or the running state can keep it awake
+	_isWokenUp = false;
+
 	if (!PrimaryComponentTick.bCanEverTick)
 	{
 		return;
 	}
-	// TODO: state machine related policies:
-	// - Allow tick when theres more than one pending state
-	// - Flush all pending states in a single frame or one state per frame
-	// - etc.
-	// For now, we control a state per frame
-
 	// check for pending states if NEXT_FRAME policy is set
-	if (!_pendingStates.IsEmpty() && transitionPolicy == ETransitionPolicy::NEXT_TICK)
+	if (transitionPolicy == ETransitionPolicy::NEXT_TICK)
 	{
-		// change state and invoked all event delegates
-		const UState* pendingState;
-		_pendingStates.Dequeue(pendingState);
-
-		// perform state change
-		PerformTransition(pendingState);
+		FlushPendingStates();
 	}
 
 	// check if it is running (it can be paused in enter/exit)
 	if (currentState != nullptr && IsRunning())
 	{
-		currentState->onTick.Broadcast(DeltaTime);
-		onStateTick.Broadcast(currentState);
+		_timeInState += DeltaTime;
+
+		const UState* tickedState = currentState;
+		tickedState->onTick.Broadcast(DeltaTime);
+		if (const FRuneNativeState* nativeState = _stateGraph.GetNativeState(tickedState->stateIndex))
+		{
+			nativeState->onTick.ExecuteIfBound(DeltaTime);
+		}
+		onStateTick.Broadcast(tickedState);
+
+		// take the first transition met, unless the state has already changed while ticking
+		if (currentState == tickedState && _pendingStates.IsEmpty())
+		{
+			const int32 targetIndex = _stateGraph.FindTransition(tickedState->stateIndex, isPressed, wasPressedSinceTick, wasReleasedSinceTick, _timeInState);
+			if (targetIndex != INDEX_NONE)
+			{
+				ChangeState(_stateGraph.GetState(targetIndex));
+			}
+		}
+
+		// edges are only seen by one tick, the input level is kept
+		wasPressedSinceTick = false;
+		wasReleasedSinceTick = false;
 	}
 
 	// check for pending states if END_FRAME policy is set
-	if (!_pendingStates.IsEmpty() && transitionPolicy == ETransitionPolicy::END_TICK)
+	if (transitionPolicy == ETransitionPolicy::END_TICK)
 	{
-		// change state and invoked all event delegates
-		const UState* pendingState;
-		_pendingStates.Dequeue(pendingState);
-
-		// perform state change
-		PerformTransition(pendingState);
+		FlushPendingStates();
 	}
 }
 
@@ -111,16 +166,23 @@ void URuneCastStateMachine::SetEntryState(UState* state)
 	if (currentState != nullptr) return;
 
 	_entryState = state;
+	_timeInState = 0.0f;
 
 	// broadcast on enter
 	if (state != nullptr)
 	{
 		state->onEnter.Broadcast();
+		if (const FRuneNativeState* nativeState = _stateGraph.GetNativeState(state->stateIndex))
+		{
+			nativeState->onEnter.ExecuteIfBound();
+		}
 		onStateEnter.Broadcast(state);
 	}
 
 	// change state
 	currentState = state;
+
+	WakeUp();
 }
 
 void URuneCastStateMachine::ChangeState(const UState* state)
@@ -128,6 +190,9 @@ void URuneCastStateMachine::ChangeState(const UState* state)
 	//ASSERT(currentState != nullptr, "Cannot change state without a state running or while transitioning");
 	if (currentState == nullptr) return;
 
+	// the new state (or the pending one) has to tick at least once
+	WakeUp();
+
 	// instant policy
 	if (transitionPolicy == ETransitionPolicy::INSTANT)
 	{
@@ -135,19 +200,15 @@ void URuneCastStateMachine::ChangeState(const UState* state)
 		return;
 	}
 
-	// next tick policy
-	if (transitionPolicy == ETransitionPolicy::NEXT_TICK)
+	// next tick and end tick policies
+	if (transitionPolicy == ETransitionPolicy::NEXT_TICK || transitionPolicy == ETransitionPolicy::END_TICK)
 	{
-		// enqueue into the pending states
-		_pendingStates.Enqueue(state);
-		return;
-	}
-
-	// end tick policy
-	if (transitionPolicy == ETransitionPolicy::END_TICK)
-	{
-		// enqueue into the pending states
-		_pendingStates.Enqueue(state);
+		// enqueue into the pending states, dropping the oldest one if full
+		if (!_pendingStates.Push(state))
+		{
+			++_droppedPendingStates;
+			INC_DWORD_STAT(STAT_RunePendingTransitionsDropped);
+		}
 		return;
 	}
 }
@@ -155,12 +216,16 @@ void URuneCastStateMachine::ChangeState(const UState* state)
 void URuneCastStateMachine::SetPressed()
 {
 	isPressed = true;
+	wasPressedSinceTick = true;
+	WakeUp();
 	onPress.Broadcast();
 }
 
 void URuneCastStateMachine::SetReleased()
 {
 	isPressed = false;
+	wasReleasedSinceTick = true;
+	WakeUp();
 	onRelease.Broadcast();
 }
 
@@ -169,6 +234,7 @@ void URuneCastStateMachine::Resume()
 	if (IsComponentTickEnabled()) return;
 
 	SetComponentTickEnabled(true);
+	WakeUp();
 	onResume.Broadcast();
 }
 
@@ -185,6 +251,44 @@ bool URuneCastStateMachine::IsRunning() const
 	return IsComponentTickEnabled();
 }
 
+bool URuneCastStateMachine::IsIdle() const
+{
+	return !isPressed && !wasPressedSinceTick && _pendingStates.IsEmpty() && currentState == _entryState;
+}
+
+bool URuneCastStateMachine::NeedsTick() const
+{
+	if (_isWokenUp || !_pendingStates.IsEmpty()) return true;
+	if (currentState == nullptr || !IsRunning()) return false;
+
+	// transitions that are not triggered by inputs are checked every tick
+	if (_stateGraph.HasPolledTransitions(currentState->stateIndex)) return true;
+
+	// ticking a state nobody listens to does nothing
+	const FRuneNativeState* nativeState = _stateGraph.GetNativeState(currentState->stateIndex);
+	return currentState->needsTick && (currentState->onTick.IsBound() || onStateTick.IsBound() || (nativeState != nullptr && nativeState->onTick.IsBound()));
+}
+
+void URuneCastStateMachine::WakeUp()
+{
+	_isWokenUp = true;
+	onWakeUp.Broadcast();
+}
+
+void URuneCastStateMachine::WakeUpIn(float delay)
+{
+	UWorld* world = GetWorld();
+	if (world == nullptr) return;
+
+	if (delay <= 0.0f)
+	{
+		WakeUp();
+		return;
+	}
+
+	world->GetTimerManager().SetTimer(_wakeUpTimerHandle, this, &URuneCastStateMachine::WakeUp, delay, false);
+}
+
 void URuneCastStateMachine::SetLinkedBehaviour(TArray<URuneBehaviour*> newBehaviours)
 {
 	for (URuneBehaviour* behaviour : runeBehaviours)
@@ -193,17 +297,23 @@ void URuneCastStateMachine::SetLinkedBehaviour(TArray<URuneBehaviour*> newBehavi
 			behaviour->DestroyComponent();
 	}
 	runeBehaviours = newBehaviours;
+
+	onLinkedBehavioursChanged.Broadcast();
 }
 
 UState* URuneCastStateMachine::CreateState(FName name)
 {
+	LLM_SCOPE_BYTAG(RuneSystem);
+
 	UState* state = NewObject<UState>(this, UState::StaticClass());
 	if (state == nullptr)
 	{
 		return nullptr;
 	}
 	state->nameID = name;
+	state->stateIndex = _stateGraph.AddState(*state);
 	_states.Add(state);
+	_statesByName.FindOrAdd(name).Add(state);
 
 	return state;
 }
@@ -222,24 +332,66 @@ void URuneCastStateMachine::DestroyState(UState* state)
 
 	// GC will handle the destroy state of the UObject
 	_states.Remove(state);
+	if (TArray<UState*, TInlineAllocator<1>>* namedStates = _statesByName.Find(state->nameID))
+	{
+		namedStates->Remove(state);
+		if (namedStates->Num() <= 0)
+		{
+			_statesByName.Remove(state->nameID);
+		}
+	}
+	_stateGraph.RemoveState(state->stateIndex);
+	state->stateIndex = INDEX_NONE;
 }
 
-UState* URuneCastStateMachine::GetState(FName name) const
+void URuneCastStateMachine::AddTransition(const UState* source, const UState* target, ERuneTransitionCondition condition, float minTimeInState)
 {
-	UState* const* foundState = _states.FindByPredicate([&name](UState* state) { return state != nullptr && state->nameID == name; });
-	return foundState != nullptr ? *foundState : nullptr;
+	AddGuardedTransition(source, target, FRuneNativeGuardDelegate(), condition, minTimeInState);
 }
 
-TArray<UState*> URuneCastStateMachine::GetStatesByName(FName name) const
+void URuneCastStateMachine::AddGuardedTransition(const UState* source, const UState* target, FRuneNativeGuardDelegate guard, ERuneTransitionCondition condition, float minTimeInState)
 {
-	TArray<UState*> states;
-	for (UState* state : _states)
+	if (source == nullptr || target == nullptr) return;
+
+	// both states must belong to this state machine
+	if (_stateGraph.GetState(source->stateIndex) != source || _stateGraph.GetState(target->stateIndex) != target)
 	{
-		if (state->nameID != name) continue;
-		states.Add(state);
+		UE_LOG(LogTemp, Warning, TEXT("[RuneCastStateMachine] AddTransition(): '%s' -> '%s' does not belong to '%s'."), *source->nameID.ToString(), *target->nameID.ToString(), *GetName());
+		return;
 	}
 
-	return states;
+	_stateGraph.AddTransition(source->stateIndex, target->stateIndex, condition, minTimeInState, MoveTemp(guard));
+}
+
+FRuneNativeState* URuneCastStateMachine::GetNativeState(const UState* state)
+{
+	if (state == nullptr || _stateGraph.GetState(state->stateIndex) != state) return nullptr;
+
+	return _stateGraph.GetNativeState(state->stateIndex);
+}
+
+UState* URuneCastStateMachine::GetState(FName name) const
+{
+	const TArray<UState*, TInlineAllocator<1>>* namedStates = _statesByName.Find(name);
+	return namedStates != nullptr && namedStates->Num() > 0 ? (*namedStates)[0] : nullptr;
+}
+
+TArray<UState*> URuneCastStateMachine::GetStatesByName(FName name) const
+{
+	return TArray<UState*>(GetStatesViewByName(name));
+}
+
+void URuneCastStateMachine::FindStatesByName(FName name, TArray<UState*>& outStates) const
+{
+	const TArrayView<UState* const> states = GetStatesViewByName(name);
+	outStates.Reset();
+	outStates.Append(states.GetData(), states.Num());
+}
+
+TArrayView<UState* const> URuneCastStateMachine::GetStatesViewByName(FName name) const
+{
+	const TArray<UState*, TInlineAllocator<1>>* namedStates = _statesByName.Find(name);
+	return namedStates != nullptr ? TArrayView<UState* const>(*namedStates) : TArrayView<UState* const>();
 }
 
 const TArray<UState*>& URuneCastStateMachine::GetStates() const
@@ -358,8 +510,51 @@ int32 URuneCastStateMachine::GetBehaviourSlotCount() const
 	return hasMultipleSlots ? slots : 1;
 }
 
+void URuneCastStateMachine::FlushPendingStates()
+{
+	if (_pendingStates.IsEmpty()) return;
+
+	// states enqueued while flushing wait for the next flush
+	uint32 count = _pendingStates.Num();
+	switch (flushPolicy)
+	{
+	case ETransitionFlushPolicy::ONE_PER_TICK:
+		count = 1;
+		break;
+	case ETransitionFlushPolicy::FLUSH_UP_TO_BUDGET:
+		count = FMath::Min(count, static_cast<uint32>(FMath::Max(transitionBudget, 1)));
+		break;
+	case ETransitionFlushPolicy::COALESCE_TO_LAST:
+	{
+		// only the last pending state is transitioned to
+		const UState* pendingState = nullptr;
+		for (; count > 0; --count)
+		{
+			_pendingStates.Pop(pendingState);
+		}
+		PerformTransition(pendingState);
+		return;
+	}
+	default:
+		break;
+	}
+
+	for (; count > 0; --count)
+	{
+		// change state and invoked all event delegates
+		const UState* pendingState;
+		if (!_pendingStates.Pop(pendingState)) break;
+
+		// perform state change
+		PerformTransition(pendingState);
+	}
+}
+
 void URuneCastStateMachine::PerformTransition(const UState* state)
 {
+	RUNE_SCOPE_CYCLE_COUNTER(STAT_RunePerformTransition, "URuneCastStateMachine::PerformTransition");
+	RUNE_SCOPE_PROFILE_PHASE(PERFORM_TRANSITION);
+
 	//ASSERT(state != nullptr, "Cannot transition into a null State");
 	if (state == nullptr) return;
 
@@ -370,13 +565,23 @@ void URuneCastStateMachine::PerformTransition(const UState* state)
 	if (prevState != nullptr)
 	{
 		prevState->onExit.Broadcast();
+		if (const FRuneNativeState* nativeState = _stateGraph.GetNativeState(prevState->stateIndex))
+		{
+			nativeState->onExit.ExecuteIfBound();
+		}
 		onStateExit.Broadcast(prevState);
 	}
 
+	_timeInState = 0.0f;
+
 	// broadcast on enter
 	if (state != nullptr)
 	{
 		state->onEnter.Broadcast();
+		if (const FRuneNativeState* nativeState = _stateGraph.GetNativeState(state->stateIndex))
+		{
+			nativeState->onEnter.ExecuteIfBound();
+		}
 		onStateEnter.Broadcast(state);
 	}
 
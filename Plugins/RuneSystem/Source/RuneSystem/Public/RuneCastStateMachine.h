@@ -4,6 +4,8 @@
 
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
+#include "RuneStateGraph.h"
+#include "Utils/RuneRingBuffer.h"
 #include "RuneCastStateMachine.generated.h"
 
 UENUM()
@@ -19,6 +21,22 @@ enum class ETransitionPolicy
 	END_TICK
 };
 
+UENUM()
+enum class ETransitionFlushPolicy
+{
+	/** Transition to one pending state per tick */
+	ONE_PER_TICK = 0,
+
+	/** Transition to every state pending at the beginning of the flush */
+	FLUSH_ALL,
+
+	/** Transition to up to transitionBudget pending states per tick */
+	FLUSH_UP_TO_BUDGET,
+
+	/** Transition only to the last pending state, discarding the rest */
+	COALESCE_TO_LAST
+};
+
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FRuneCastDelegate);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FRuneCastStateDelegate, const UState*, state);
@@ -37,10 +55,26 @@ public:
 	// Sets default values for this object's properties
 	UState() = default;
 
+	// Adds the memory of the delegates bindings
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+
 public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly)
 	FName nameID = NAME_None;
 
+	/**
+	 * Whether the state machine has to keep ticking every frame while in this state.
+	 * If false, the rune stops ticking once this state has ticked, until it is woken up
+	 * by an input, a state change or URuneCastStateMachine::WakeUpIn().
+	 * States with nothing bound to onTick never keep the rune ticking.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool needsTick = true;
+
+	/** Dense ID of the state in the transition table of its state machine */
+	UPROPERTY(BlueprintReadOnly)
+	int32 stateIndex = INDEX_NONE;
+
 	/** Delegate invoked when a state ticks. */
 	UPROPERTY(BlueprintAssignable)
 	FStateTickDelegate onTick;
@@ -81,6 +115,8 @@ protected:
 	virtual void BeginPlay() override;
 
 public:
+	// Adds the memory of the states lookups and transition table, and of the states when estimating the total
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
 
 	virtual void TickCastStateMachine(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction);
 
@@ -112,13 +148,13 @@ public:
 	virtual void ChangeState(const UState* state);
 
 	/**
-	 * Sets IsPressed to true.
+	 * Sets IsPressed to true, latching the press until the next tick.
 	 */
 	UFUNCTION(BlueprintCallable)
 	virtual void SetPressed();
 
 	/**
-	 * Sets IsPressed to false.
+	 * Sets IsPressed to false, latching the release until the next tick.
 	 */
 	UFUNCTION(BlueprintCallable)
 	virtual void SetReleased();
@@ -143,6 +179,40 @@ public:
 	UFUNCTION(BlueprintCallable)
 	virtual bool IsRunning() const;
 
+	/**
+	 * Whether the state machine is waiting in its entry state
+	 * for the rune to be pressed, with no transitions pending.
+	 *
+	 * @return If true, ticking it would only broadcast the entry state tick
+	 */
+	UFUNCTION(BlueprintCallable)
+	virtual bool IsIdle() const;
+
+	/**
+	 * Whether the state machine has to be ticked next frame: there are pending
+	 * transitions, it has been woken up or its running state needs to tick.
+	 *
+	 * @return If false, the rune can stop ticking until the state machine is woken up
+	 */
+	UFUNCTION(BlueprintCallable)
+	virtual bool NeedsTick() const;
+
+	/**
+	 * Makes the rune tick the state machine at least once more.
+	 * Called on inputs, state changes and resumes.
+	 */
+	UFUNCTION(BlueprintCallable)
+	void WakeUp();
+
+	/**
+	 * Wakes the state machine up after some time,
+	 * e.g. to end a state that does not need to tick every frame.
+	 *
+	 * @param delay Time - in seconds - to wait before waking up
+	 */
+	UFUNCTION(BlueprintCallable)
+	void WakeUpIn(float delay);
+
 	/**
 	 * Sets the behaviour controlled by this state machine.
 	 *
@@ -169,8 +239,51 @@ public:
 	UFUNCTION(BlueprintCallable)
 	void DestroyState(UState* state);
 
+	/**
+	 * Declares a transition in the transition table, checked every time the source state ticks.
+	 * Transitions of a state are checked in declaration order, and only when no state is pending.
+	 * Declaring transitions up front (e.g. in Init()) replaces changing states from onTick.
+	 *
+	 * @param source State to transition from
+	 * @param target State to transition to
+	 * @param condition Input condition to meet
+	 * @param minTimeInState Time - in seconds - to spend in the source state before transitioning
+	 */
+	UFUNCTION(BlueprintCallable)
+	void AddTransition(const UState* source, const UState* target, ERuneTransitionCondition condition = ERuneTransitionCondition::ALWAYS, float minTimeInState = 0.0f);
+
+	/**
+	 * Native version of AddTransition() with a guard,
+	 * the transition is only taken if the guard returns true.
+	 *
+	 * @param source State to transition from
+	 * @param target State to transition to
+	 * @param guard Native guard
+	 * @param condition Input condition to meet
+	 * @param minTimeInState Time - in seconds - to spend in the source state before transitioning
+	 */
+	void AddGuardedTransition(const UState* source, const UState* target, FRuneNativeGuardDelegate guard, ERuneTransitionCondition condition = ERuneTransitionCondition::ALWAYS, float minTimeInState = 0.0f);
+
+	/**
+	 * Gets the native enter/tick/exit callbacks of a state,
+	 * run right after its dynamic delegates.
+	 *
+	 * @param state State of this state machine
+	 * @return Native callbacks, nullptr if the state does not belong to this state machine
+	 */
+	FRuneNativeState* GetNativeState(const UState* state);
+
+	/**
+	 * Gets the time spent in the current state.
+	 *
+	 * @return Time - in seconds - since the current state was entered
+	 */
+	UFUNCTION(BlueprintCallable)
+	virtual float GetTimeInState() const { return _timeInState; };
+
 	/**
 	 * Retrieves a state by its name.
+	 * If several states share the name, the first one created is returned.
 	 * 
 	 * @param name Name of the state
 	 * @return State
@@ -180,6 +293,7 @@ public:
 
 	/**
 	 * Retrieves all states with a given name.
+	 * Allocates a new array, prefer FindStatesByName() or GetStatesViewByName() when called often.
 	 *
 	 * @param name Name of the states
 	 * @return Array of states
@@ -187,6 +301,25 @@ public:
 	UFUNCTION(BlueprintCallable)
 	TArray<UState*> GetStatesByName(FName name) const;
 
+	/**
+	 * Retrieves all states with a given name into a caller-provided array,
+	 * which keeps its allocation between calls.
+	 *
+	 * @param name Name of the states
+	 * @param outStates Array emptied and filled with the states
+	 */
+	UFUNCTION(BlueprintCallable)
+	void FindStatesByName(FName name, TArray<UState*>& outStates) const;
+
+	/**
+	 * Retrieves a view of all states with a given name, in creation order.
+	 * The view is invalidated when states are created or destroyed.
+	 *
+	 * @param name Name of the states
+	 * @return View of the states, empty if there are none
+	 */
+	TArrayView<UState* const> GetStatesViewByName(FName name) const;
+
 	/**
 	 * Retrieves all states.
 	 *
@@ -308,6 +441,15 @@ protected:
 	UFUNCTION(BlueprintCallable)
 	bool AreAnyStatesEnqueued() { return !_pendingStates.IsEmpty(); };
 
+	/**
+	 * Gets how many pending states have been dropped because too many
+	 * states were pending at once (see MaxPendingStates).
+	 *
+	 * @return Dropped pending states
+	 */
+	UFUNCTION(BlueprintCallable)
+	int32 GetNumDroppedPendingStates() const { return _droppedPendingStates; };
+
 private:
 	/**
 	 * Performs the transition to the given state.
@@ -317,11 +459,27 @@ private:
 	 */
 	void PerformTransition(const UState* state);
 
+	/**
+	 * Transitions to the pending states following the flush policy.
+	 */
+	void FlushPendingStates();
+
 public:
 	/** What policy should be used when changing states */
 	UPROPERTY(EditAnywhere, Category = "RuneCastStateMachine: General Settings")
 	ETransitionPolicy transitionPolicy;
 
+	/** How many pending states are transitioned to per tick, when not using the INSTANT policy */
+	UPROPERTY(EditAnywhere, Category = "RuneCastStateMachine: General Settings", meta = (EditCondition = "transitionPolicy != ETransitionPolicy::INSTANT"))
+	ETransitionFlushPolicy flushPolicy;
+
+	/** Maximum pending states transitioned to per tick with the FLUSH_UP_TO_BUDGET policy */
+	UPROPERTY(EditAnywhere, Category = "RuneCastStateMachine: General Settings", meta = (EditCondition = "flushPolicy == ETransitionFlushPolicy::FLUSH_UP_TO_BUDGET", EditConditionHides, ClampMin = 1, UIMin = 1))
+	int32 transitionBudget;
+
+	/** Maximum number of pending states. Once reached, the oldest pending state is dropped */
+	static constexpr uint32 MaxPendingStates = 16;
+
 	/** Whether there are multiple slots */
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "RuneCastStateMachine: General Settings")
 	bool hasMultipleSlots;
@@ -362,6 +520,12 @@ public:
 	UPROPERTY(BlueprintAssignable)
 	FRuneCastStateDelegate onStateExit;
 
+	/** Called after the linked behaviours have changed, see SetLinkedBehaviour() */
+	FSimpleMulticastDelegate onLinkedBehavioursChanged;
+
+	/** Called when the state machine has been woken up, see WakeUp() */
+	FSimpleMulticastDelegate onWakeUp;
+
 protected:
 	/** State that is currently ticking */
 	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category = "RuneCastStateMachine: Debug Variables")
@@ -371,6 +535,12 @@ protected:
 	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category = "RuneCastStateMachine: Debug Variables")
 	bool isPressed;
 
+	/** Whether the rune has been pressed since the last tick, even if released since */
+	bool wasPressedSinceTick;
+
+	/** Whether the rune has been released since the last tick, even if pressed again since */
+	bool wasReleasedSinceTick;
+
 private:
 	/** Entry state. This is not cached */
 	UPROPERTY()
@@ -380,8 +550,26 @@ private:
 	UPROPERTY()
 	TArray<UState*> _states;
 
+	/** States indexed by their name (at creation), in creation order */
+	TMap<FName, TArray<UState*, TInlineAllocator<1>>> _statesByName;
+
 	/** Pending states that have to be transitioned to */
-	TQueue<const UState*> _pendingStates;
+	TRuneRingBuffer<const UState*, MaxPendingStates> _pendingStates;
+
+	/** Number of pending states dropped because the pending states were full */
+	int32 _droppedPendingStates;
+
+	/** Whether the state machine has been woken up since it last ticked */
+	bool _isWokenUp;
+
+	/** Transition table and native callbacks of the states, indexed by UState::stateIndex */
+	FRuneStateGraph _stateGraph;
+
+	/** Time - in seconds - spent in the current state */
+	float _timeInState;
+
+	/** Timer used by WakeUpIn() */
+	FTimerHandle _wakeUpTimerHandle;
 
 	/** Linked RuneBehaviour this StateMachine is managing */
 	UPROPERTY(VisibleInstanceOnly, Category = "RuneCastStateMachine: Debug Variables")
@@ -0,0 +1,285 @@
+#include "RuneCostAccounting.h"
+#include "RuneBaseComponent.h"
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CoreDelegates.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+
+CSV_DEFINE_CATEGORY(RuneSystem, false);
+
+static TAutoConsoleVariable<bool> CVarRuneProfileEnabled(
+	TEXT("rune.Profile.Enabled"),
+	false,
+	TEXT("Whether the time spent by each rune configuration in cast ticks, pulses and effect applications is accounted, along with the agents it spawns."));
+
+static FAutoConsoleCommandWithOutputDevice CmdRuneProfileDump(
+	TEXT("rune.Profile.Dump"),
+	TEXT("Logs the costs accounted to each rune configuration and configuration asset, the most expensive first. Needs rune.Profile.Enabled."),
+	FConsoleCommandWithOutputDeviceDelegate::CreateLambda([](FOutputDevice& ar)
+	{
+		FRuneCostAccounting::Get().Dump(ar);
+	}));
+
+static FAutoConsoleCommand CmdRuneProfileReset(
+	TEXT("rune.Profile.Reset"),
+	TEXT("Clears the costs accounted to every rune configuration."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		FRuneCostAccounting::Get().Reset();
+	}));
+
+
+FRuneCostOwner::FRuneCostOwner(const URuneBaseComponent* inRune, int32 inConfigIndex) :
+	rune(inRune),
+	configIndex(inConfigIndex)
+{
+}
+
+void FRuneCostAccounting::FCost::Add(const FCost& other)
+{
+	for (int32 i = 0; i < static_cast<int32>(ERuneCostCategory::NUM); ++i)
+	{
+		cycles[i] += other.cycles[i];
+		calls[i] += other.calls[i];
+	}
+	topLevelCycles += other.topLevelCycles;
+	agentsSpawned += other.agentsSpawned;
+	frames += other.frames;
+}
+
+FRuneCostAccounting& FRuneCostAccounting::Get()
+{
+	static FRuneCostAccounting instance;
+	return instance;
+}
+
+bool FRuneCostAccounting::IsEnabled()
+{
+	return CVarRuneProfileEnabled.GetValueOnGameThread();
+}
+
+void FRuneCostAccounting::AddCost(const FRuneCostOwner& owner, ERuneCostCategory category, uint64 cycles, bool isTopLevel)
+{
+	const int32 index = static_cast<int32>(category);
+	FEntry& entry = FindOrAddEntry(owner);
+	entry.total.cycles[index] += cycles;
+	++entry.total.calls[index];
+	frameCategoryCycles[index] += cycles;
+
+	// nested times are already included in the top level one
+	if (isTopLevel)
+	{
+		entry.total.topLevelCycles += cycles;
+		entry.frameCycles += cycles;
+		runeFrames.FindOrAdd(owner.rune).cycles += cycles;
+	}
+	hasFrameCosts = true;
+}
+
+void FRuneCostAccounting::AddAgentSpawned(const FRuneCostOwner& owner)
+{
+	if (!owner.IsSet()) return;
+
+	++FindOrAddEntry(owner).total.agentsSpawned;
+	++frameAgentsSpawned;
+	hasFrameCosts = true;
+}
+
+void FRuneCostAccounting::Reset()
+{
+	entries.Reset();
+	retiredAssetCosts.Reset();
+	retiredCost = FCost();
+	runeFrames.Reset();
+	FMemory::Memzero(frameCategoryCycles);
+	frameAgentsSpawned = 0;
+	hasFrameCosts = false;
+}
+
+FRuneCostAccounting::FEntry& FRuneCostAccounting::FindOrAddEntry(const FRuneCostOwner& owner)
+{
+	FEntry* entry = entries.Find(owner);
+	if (entry != nullptr) return *entry;
+
+	// names are resolved once, so that costs of destroyed runes can still be dumped
+	const URuneBaseComponent* rune = owner.rune.ResolveObjectPtr();
+	const UObject* archetype = rune != nullptr ? rune->GetArchetype() : nullptr;
+
+	FEntry& newEntry = entries.Add(owner);
+	newEntry.runeName = FString::Printf(TEXT("%s.%s[%d]"), *GetNameSafe(rune != nullptr ? rune->GetOwner() : nullptr), *GetNameSafe(rune), owner.configIndex);
+	newEntry.assetName = FString::Printf(TEXT("%s.%s[%d]"), *GetNameSafe(archetype != nullptr ? archetype->GetOuter() : nullptr), *GetNameSafe(archetype), owner.configIndex);
+	newEntry.csvStatName = FName(*newEntry.assetName);
+
+	if (!isBoundToEndFrame)
+	{
+		FCoreDelegates::OnEndFrame.AddRaw(this, &FRuneCostAccounting::OnEndFrame);
+		isBoundToEndFrame = true;
+	}
+
+	return newEntry;
+}
+
+void FRuneCostAccounting::OnEndFrame()
+{
+	if (!hasFrameCosts) return;
+	hasFrameCosts = false;
+
+#if CSV_PROFILER
+	const bool isCsvCapturing = FCsvProfiler::Get()->IsCapturing();
+	if (isCsvCapturing)
+	{
+		CSV_CUSTOM_STAT(RuneSystem, CastTickMs, FPlatformTime::ToMilliseconds64(frameCategoryCycles[static_cast<int32>(ERuneCostCategory::CAST_TICK)]), ECsvCustomStatOp::Set);
+		CSV_CUSTOM_STAT(RuneSystem, PulseMs, FPlatformTime::ToMilliseconds64(frameCategoryCycles[static_cast<int32>(ERuneCostCategory::PULSE)]), ECsvCustomStatOp::Set);
+		CSV_CUSTOM_STAT(RuneSystem, EffectApplyMs, FPlatformTime::ToMilliseconds64(frameCategoryCycles[static_cast<int32>(ERuneCostCategory::EFFECT_APPLY)]), ECsvCustomStatOp::Set);
+		CSV_CUSTOM_STAT(RuneSystem, AgentsSpawned, static_cast<int32>(frameAgentsSpawned), ECsvCustomStatOp::Set);
+	}
+#endif
+	FMemory::Memzero(frameCategoryCycles);
+	frameAgentsSpawned = 0;
+
+	for (TPair<FRuneCostOwner, FEntry>& pair : entries)
+	{
+		FEntry& entry = pair.Value;
+		if (entry.frameCycles == 0) continue;
+
+		++entry.total.frames;
+#if CSV_PROFILER
+		// instances of the same configuration asset add up
+		if (isCsvCapturing)
+		{
+			FCsvProfiler::RecordCustomStat(entry.csvStatName, CSV_CATEGORY_INDEX(RuneSystem), FPlatformTime::ToMilliseconds64(entry.frameCycles), ECsvCustomStatOp::Accumulate);
+		}
+#endif
+		entry.frameCycles = 0;
+	}
+
+	if (entries.Num() > MaxEntries)
+	{
+		RetireDestroyedEntries();
+	}
+
+	for (auto it = runeFrames.CreateIterator(); it; ++it)
+	{
+		const URuneBaseComponent* rune = it.Key().ResolveObjectPtr();
+		if (rune == nullptr)
+		{
+			it.RemoveCurrent();
+			continue;
+		}
+
+		// only the first frame of a run over budget is logged
+		FRuneFrame& frame = it.Value();
+		const double frameMs = FPlatformTime::ToMilliseconds64(frame.cycles);
+		const bool isOverBudget = rune->frameBudget > 0.0f && frameMs > rune->frameBudget;
+		if (isOverBudget)
+		{
+			++frame.budgetOverruns;
+			if (!frame.wasOverBudget)
+			{
+				UE_LOG(LogTemp, Warning, TEXT("[FRuneCostAccounting] OnEndFrame(): '%s' in '%s' spent %.3f ms, over its budget of %.3f ms."),
+					*rune->GetName(), *GetNameSafe(rune->GetOwner()), frameMs, rune->frameBudget);
+			}
+		}
+		frame.wasOverBudget = isOverBudget;
+		frame.cycles = 0;
+	}
+}
+
+void FRuneCostAccounting::RetireDestroyedEntries()
+{
+	for (auto it = entries.CreateIterator(); it; ++it)
+	{
+		if (it.Key().rune.ResolveObjectPtr() != nullptr) continue;
+
+		retiredAssetCosts.FindOrAdd(it.Value().assetName).Add(it.Value().total);
+		retiredCost.Add(it.Value().total);
+		it.RemoveCurrent();
+	}
+}
+
+void FRuneCostAccounting::Dump(FOutputDevice& ar) const
+{
+	if (!IsEnabled())
+	{
+		ar.Logf(TEXT("[FRuneCostAccounting] Dump(): rune.Profile.Enabled is 0, no cost is being accounted."));
+	}
+
+	TMap<FString, FCost> runeCosts;
+	TMap<FString, FCost> assetCosts = retiredAssetCosts;
+	if (retiredAssetCosts.Num() > 0)
+	{
+		runeCosts.Add(TEXT("(destroyed runes)"), retiredCost);
+	}
+	for (const TPair<FRuneCostOwner, FEntry>& pair : entries)
+	{
+		runeCosts.FindOrAdd(pair.Value.runeName).Add(pair.Value.total);
+		assetCosts.FindOrAdd(pair.Value.assetName).Add(pair.Value.total);
+	}
+
+	DumpCosts(ar, TEXT("Rune configurations"), runeCosts);
+	DumpCosts(ar, TEXT("Configuration assets"), assetCosts);
+
+	ar.Logf(TEXT("Budget overruns:"));
+	for (const TPair<TObjectKey<URuneBaseComponent>, FRuneFrame>& pair : runeFrames)
+	{
+		const URuneBaseComponent* rune = pair.Key.ResolveObjectPtr();
+		if (rune == nullptr || pair.Value.budgetOverruns == 0) continue;
+
+		ar.Logf(TEXT("  %s.%s: %u frames over %.3f ms"), *GetNameSafe(rune->GetOwner()), *rune->GetName(), pair.Value.budgetOverruns, rune->frameBudget);
+	}
+}
+
+void FRuneCostAccounting::DumpCosts(FOutputDevice& ar, const TCHAR* title, const TMap<FString, FCost>& costs)
+{
+	TArray<TPair<FString, FCost>> sortedCosts = costs.Array();
+	sortedCosts.Sort([](const TPair<FString, FCost>& a, const TPair<FString, FCost>& b) { return a.Value.topLevelCycles > b.Value.topLevelCycles; });
+
+	auto toMs = [](uint64 cycles) { return FPlatformTime::ToMilliseconds64(cycles); };
+	constexpr int32 castTick = static_cast<int32>(ERuneCostCategory::CAST_TICK);
+	constexpr int32 pulse = static_cast<int32>(ERuneCostCategory::PULSE);
+	constexpr int32 effectApply = static_cast<int32>(ERuneCostCategory::EFFECT_APPLY);
+
+	ar.Logf(TEXT("%s:"), title);
+	ar.Logf(TEXT("  %-64s %10s %10s %8s %10s %8s %10s %8s %10s %7s"),
+		TEXT("Name"), TEXT("Total ms"), TEXT("ms/frame"), TEXT("Ticks"), TEXT("Tick ms"), TEXT("Pulses"), TEXT("Pulse ms"), TEXT("Effects"), TEXT("Effect ms"), TEXT("Agents"));
+	for (const TPair<FString, FCost>& pair : sortedCosts)
+	{
+		const FCost& cost = pair.Value;
+		ar.Logf(TEXT("  %-64s %10.3f %10.4f %8u %10.3f %8u %10.3f %8u %10.3f %7u"),
+			*pair.Key, toMs(cost.topLevelCycles), cost.frames > 0 ? toMs(cost.topLevelCycles) / cost.frames : 0.0,
+			cost.calls[castTick], toMs(cost.cycles[castTick]),
+			cost.calls[pulse], toMs(cost.cycles[pulse]),
+			cost.calls[effectApply], toMs(cost.cycles[effectApply]),
+			cost.agentsSpawned);
+	}
+}
+
+// ----------------------------
+// Scoped cost
+// ----------------------------
+
+const FRuneCostOwner* FRuneScopedCost::currentOwner = nullptr;
+
+FRuneScopedCost::FRuneScopedCost(const FRuneCostOwner& inOwner, ERuneCostCategory inCategory) :
+	owner(inOwner),
+	previousOwner(currentOwner),
+	category(inCategory),
+	startCycles(inOwner.IsSet() && FRuneCostAccounting::IsEnabled() ? FPlatformTime::Cycles64() : 0)
+{
+	if (startCycles != 0)
+	{
+		currentOwner = &owner;
+	}
+}
+
+FRuneScopedCost::~FRuneScopedCost()
+{
+	if (startCycles == 0) return;
+
+	currentOwner = previousOwner;
+
+	// scopes nested in one of the same owner are already included in its time
+	const bool isTopLevel = previousOwner == nullptr || !(*previousOwner == owner);
+	FRuneCostAccounting::Get().AddCost(owner, category, FPlatformTime::Cycles64() - startCycles, isTopLevel);
+}
@@ -0,0 +1,217 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+#include "Utils/RuneStats.h"
+
+class URuneBaseComponent;
+
+/** Categories of the time accounted to a rune. Nested categories are included in their parent's time */
+enum class ERuneCostCategory : uint8
+{
+	/** Cast state machine ticks, run by URuneBaseComponent::TickRune() */
+	CAST_TICK = 0,
+
+	/** Apply pulses of the behaviours */
+	PULSE,
+
+	/** Effect applications, over time ticks included */
+	EFFECT_APPLY,
+
+	NUM
+};
+
+/**
+ * What a cost is accounted to: a rune and one of its configurations.
+ * Behaviours and effects get the one of their rune when it is configured.
+ */
+struct RUNESYSTEM_API FRuneCostOwner
+{
+	FRuneCostOwner() = default;
+	FRuneCostOwner(const URuneBaseComponent* inRune, int32 inConfigIndex);
+
+	/** Whether the owner has been set, costs without owner are not accounted */
+	bool IsSet() const { return configIndex != INDEX_NONE; }
+
+	bool operator==(const FRuneCostOwner& other) const
+	{
+		return configIndex == other.configIndex && rune == other.rune;
+	}
+
+	friend uint32 GetTypeHash(const FRuneCostOwner& owner)
+	{
+		return HashCombine(GetTypeHash(owner.rune), ::GetTypeHash(owner.configIndex));
+	}
+
+	TObjectKey<URuneBaseComponent> rune;
+	int32 configIndex = INDEX_NONE;
+};
+
+/**
+ * Accumulates, per rune configuration, the time spent in cast ticks, pulses and effect applications,
+ * and the agents spawned. Totals are aggregated per configuration asset as well (the rune archetype).
+ *
+ * Disabled by default (rune.Profile.Enabled). Once enabled, every frame:
+ * - The time of each configuration asset is recorded in the RuneSystem CSV profiler category.
+ * - Runes spending more than their frameBudget are logged.
+ *
+ * Totals are logged by rune.Profile.Dump, and cleared by rune.Profile.Reset.
+ * Past MaxEntries configurations, those of destroyed runes are folded into per asset totals.
+ * Only fed from the game thread.
+ */
+class RUNESYSTEM_API FRuneCostAccounting
+{
+public:
+	/** Rune configurations accounted before folding those of destroyed runes */
+	static constexpr int32 MaxEntries = 2048;
+
+	/**
+	 * Gets the global accounting instance.
+	 *
+	 * @return Cost accounting.
+	 */
+	static FRuneCostAccounting& Get();
+
+	/** Whether costs are being accounted */
+	static bool IsEnabled();
+
+	/**
+	 * Adds time spent by a rune configuration.
+	 *
+	 * @param owner Rune configuration the time is accounted to
+	 * @param category Category of the time
+	 * @param cycles Time spent, in FPlatformTime cycles
+	 * @param isTopLevel Whether the time is not included in another time of the same owner
+	 */
+	void AddCost(const FRuneCostOwner& owner, ERuneCostCategory category, uint64 cycles, bool isTopLevel);
+
+	/**
+	 * Adds an agent spawned by a rune configuration.
+	 *
+	 * @param owner Rune configuration the agent is accounted to
+	 */
+	void AddAgentSpawned(const FRuneCostOwner& owner);
+
+	/**
+	 * Logs the totals of every rune configuration, then of every configuration asset, the most expensive first.
+	 *
+	 * @param ar Output device the totals are logged to
+	 */
+	void Dump(FOutputDevice& ar) const;
+
+	/** Clears every total */
+	void Reset();
+
+private:
+	/** Totals of a rune configuration, or of a configuration asset */
+	struct FCost
+	{
+		uint64 cycles[static_cast<int32>(ERuneCostCategory::NUM)] = {};
+		uint32 calls[static_cast<int32>(ERuneCostCategory::NUM)] = {};
+		uint64 topLevelCycles = 0;
+		uint32 agentsSpawned = 0;
+		uint32 frames = 0;
+
+		void Add(const FCost& other);
+	};
+
+	/** Accounted rune configuration */
+	struct FEntry
+	{
+		FCost total;
+
+		/** Time not included in other times, spent this frame */
+		uint64 frameCycles = 0;
+
+		/** Name of the rune instance and configuration, for dumps */
+		FString runeName;
+
+		/** Name of the configuration asset, for dumps and CSV stats */
+		FString assetName;
+		FName csvStatName;
+	};
+
+	/** Time spent by a rune this frame, checked against its budget */
+	struct FRuneFrame
+	{
+		uint64 cycles = 0;
+		uint32 budgetOverruns = 0;
+		bool wasOverBudget = false;
+	};
+
+	/**
+	 * Finds the entry of a rune configuration, adding it if missing.
+	 *
+	 * @param owner Rune configuration
+	 * @return Entry of the configuration
+	 */
+	FEntry& FindOrAddEntry(const FRuneCostOwner& owner);
+
+	/** Checks budgets and records CSV stats, then starts a new frame */
+	void OnEndFrame();
+
+	/** Folds the entries of destroyed runes into the retired totals */
+	void RetireDestroyedEntries();
+
+	/**
+	 * Logs a table of totals, the most expensive first.
+	 *
+	 * @param ar Output device the totals are logged to
+	 * @param title Title of the table
+	 * @param costs Totals by name
+	 */
+	static void DumpCosts(FOutputDevice& ar, const TCHAR* title, const TMap<FString, FCost>& costs);
+
+private:
+	/** Totals by rune configuration */
+	TMap<FRuneCostOwner, FEntry> entries;
+
+	/** Totals of the retired entries, by configuration asset */
+	TMap<FString, FCost> retiredAssetCosts;
+
+	/** Totals of every retired entry */
+	FCost retiredCost;
+
+	/** Time spent this frame by rune */
+	TMap<TObjectKey<URuneBaseComponent>, FRuneFrame> runeFrames;
+
+	/** Time spent this frame by category, every rune included */
+	uint64 frameCategoryCycles[static_cast<int32>(ERuneCostCategory::NUM)] = {};
+
+	/** Agents spawned this frame, every rune included */
+	uint32 frameAgentsSpawned = 0;
+
+	/** Whether entries have been fed since the last end of frame */
+	bool hasFrameCosts = false;
+
+	/** Whether OnEndFrame() is bound to the end of every frame */
+	bool isBoundToEndFrame = false;
+};
+
+/** Accounts the time spent in a scope to a rune configuration, see FRuneCostAccounting */
+class RUNESYSTEM_API FRuneScopedCost
+{
+public:
+	FRuneScopedCost(const FRuneCostOwner& inOwner, ERuneCostCategory inCategory);
+	~FRuneScopedCost();
+
+private:
+	/** Owner of the innermost scope being accounted, nullptr if none */
+	static const FRuneCostOwner* currentOwner;
+
+	FRuneCostOwner owner;
+	const FRuneCostOwner* previousOwner;
+	ERuneCostCategory category;
+	uint64 startCycles;
+};
+
+#if RUNE_STATS
+/** Accounts the time spent in the scope to a rune configuration, see ERuneCostCategory */
+#define RUNE_SCOPE_COST(Owner, Category) FRuneScopedCost ANONYMOUS_VARIABLE(RuneCost_)(Owner, ERuneCostCategory::Category)
+
+/** Accounts a spawned agent to a rune configuration */
+#define RUNE_ADD_AGENT_SPAWNED(Owner) if (FRuneCostAccounting::IsEnabled()) { FRuneCostAccounting::Get().AddAgentSpawned(Owner); }
+#else
+#define RUNE_SCOPE_COST(Owner, Category)
+#define RUNE_ADD_AGENT_SPAWNED(Owner)
+#endif
@@ -2,10 +2,13 @@
 
 
 #include "RuneEffect.h"
+#include "RuneBaseComponent.h"
 #include "RuneCompatible.h"
 #include "RuneFilter.h"
-#include "ApplicationType/EoTComponent.h"
-#include "ApplicationType/StatusComponent.h"
+#include "ApplicationType/EoTSubsystem.h"
+#include "ApplicationType/StatusSubsystem.h"
+#include "Utils/RuneStats.h"
+#include "Engine/World.h"
 
 
 
@@ -17,9 +20,11 @@ URuneEffect::URuneEffect() :
 	tickRate(0.5f),
 	duration(5.0f),
 	trimTickDistribution(true),
+	isStateful(false),
 	filterFaction(static_cast<uint8>(ERuneFilterFaction::FACTION_B)),
 	runeInstigator(nullptr),
-	instigatorFilter(nullptr)
+	instigatorFilter(nullptr),
+	costOwner()
 {
 	// do not tick by default
 	PrimaryComponentTick.bCanEverTick = false;
@@ -39,6 +44,30 @@ bool URuneEffect::CanEditChange(const FProperty* InProperty) const
 }
 #endif
 
+void URuneEffect::OnComponentDestroyed(bool bDestroyingHierarchy)
+{
+	Super::OnComponentDestroyed(bDestroyingHierarchy);
+
+	// the cached validity of the rune no longer holds
+	if (URuneBaseComponent* rune = costOwner.rune.ResolveObjectPtr())
+	{
+		rune->InvalidateValidity();
+	}
+}
+
+void URuneEffect::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(onEffectApplied.GetAllocatedSize() + onEffectReverted.GetAllocatedSize());
+
+	// custom filters are usually shared, only count an instanced one
+	if (CumulativeResourceSize.GetResourceSizeMode() == EResourceSizeMode::EstimatedTotal && customFilter != nullptr && customFilter->GetOuter() == this)
+	{
+		customFilter->GetResourceSizeEx(CumulativeResourceSize);
+	}
+}
+
 void URuneEffect::Apply(AController* instigator, AActor* causer, AActor* target)
 {
 	// by default calls the blueprint version
@@ -53,11 +82,7 @@ void URuneEffect::Revert(AActor* target)
 
 const URuneFilter* URuneEffect::GetUsedFilter() const
 {
-	if (!overrideFilter)
-	{
-		return instigatorFilter;
-	}
-	return customFilter;
+	return ResolveFilter(instigatorFilter);
 }
 
 AController* URuneEffect::GetInstigator() const
@@ -82,13 +107,44 @@ void URuneEffect::SetInstigatorFilter(const URuneFilter* filter)
 
 bool URuneEffect::Filter(const AActor& actor) const
 {
-	const URuneFilter* runeFilter = GetUsedFilter();
-	if (runeFilter == nullptr)
+	return FilterWith(actor, GetUsedFilter());
+}
+
+int32 URuneEffect::FilterBatch(TConstArrayView<const AActor*> actors, TBitArray<>& outFiltered) const
+{
+	return FilterBatchWith(actors, outFiltered, GetUsedFilter());
+}
+
+bool URuneEffect::Filter(const AActor& actor, const FRuneEffectContext& context) const
+{
+	return FilterWith(actor, ResolveFilter(context.instigatorFilter));
+}
+
+int32 URuneEffect::FilterBatch(TConstArrayView<const AActor*> actors, TBitArray<>& outFiltered, const FRuneEffectContext& context) const
+{
+	return FilterBatchWith(actors, outFiltered, ResolveFilter(context.instigatorFilter));
+}
+
+FRuneEffectContext URuneEffect::MakeContext(AActor* causer) const
+{
+	FRuneEffectContext context;
+	context.instigator = runeInstigator;
+	context.instigatorFilter = instigatorFilter;
+	context.causer = causer;
+	return context;
+}
+
+URuneEffect* URuneEffect::DuplicateEffect(UObject* outer) const
+{
+	LLM_SCOPE_BYTAG(RuneSystem);
+
+	URuneEffect* copy = DuplicateObject<URuneEffect>(this, outer);
+	if (copy != nullptr)
 	{
-		return false;
+		// not a property, so not duplicated
+		copy->costOwner = costOwner;
 	}
-
-	return !(filterFaction & ~runeFilter->Filter(actor, GetClass()));
+	return copy;
 }
 
 bool URuneEffect::InvokeFilter(const AActor* actor) const
@@ -102,6 +158,10 @@ bool URuneEffect::InvokeFilter(const AActor* actor) const
 
 void URuneEffect::InternalApply(AController* instigator, AActor* causer, AActor* target, FBooleanPtr success)
 {
+	RUNE_SCOPE_CYCLE_COUNTER(STAT_RuneEffectApply, "URuneEffect::InternalApply");
+	RUNE_SCOPE_PROFILE_PHASE(EFFECT_APPLY);
+	RUNE_SCOPE_COST(costOwner, EFFECT_APPLY);
+
 	// if actor is filtered, do NOT apply the effect
 	bool filtered = Filter(*target);
 	if (success.value != nullptr)
@@ -110,24 +170,12 @@ void URuneEffect::InternalApply(AController* instigator, AActor* causer, AActor*
 	}
 	if (filtered)
 	{
+		RUNE_INC_COUNTER(STAT_RuneFilterRejections);
 		return;
 	}
 
-	switch (applicationType)
-	{
-	case EApplicationType::IMMEDIATE:
-		ApplyEffectInstant(instigator , causer, target);
-		break;
-	case EApplicationType::OVER_TIME:
-		ApplyEffectOverTime(instigator, causer, target);
-		break;
-	case EApplicationType::STATUS:
-		ApplyEffectStatus(instigator, causer, target);
-		break;
-	default:
-		Apply(instigator, causer, target);
-		break;
-	}
+	RUNE_INC_COUNTER(STAT_RuneEffectsApplied);
+	DispatchApply(instigator, causer, target);
 }
 
 void URuneEffect::InternalRevert(AActor* target, FBooleanPtr success)
@@ -143,12 +191,102 @@ void URuneEffect::InternalRevert(AActor* target, FBooleanPtr success)
 		return;
 	}
 
+	DispatchRevert(target);
+}
+
+void URuneEffect::InternalApplyWithContext(const FRuneEffectContext& context, AActor* target, FBooleanPtr success)
+{
+	RUNE_SCOPE_CYCLE_COUNTER(STAT_RuneEffectApply, "URuneEffect::InternalApplyWithContext");
+	RUNE_SCOPE_PROFILE_PHASE(EFFECT_APPLY);
+	RUNE_SCOPE_COST(costOwner, EFFECT_APPLY);
+
+	// if actor is filtered, do NOT apply the effect
+	bool filtered = Filter(*target, context);
+	if (success.value != nullptr)
+	{
+		*success.value |= !filtered;
+	}
+	if (filtered)
+	{
+		RUNE_INC_COUNTER(STAT_RuneFilterRejections);
+		return;
+	}
+
+	RUNE_INC_COUNTER(STAT_RuneEffectsApplied);
+	DispatchApply(context.instigator, context.causer, target);
+}
+
+void URuneEffect::InternalRevertWithContext(const FRuneEffectContext& context, AActor* target, FBooleanPtr success)
+{
+	// filtering check
+	bool filtered = Filter(*target, context);
+	if (success.value != nullptr)
+	{
+		*success.value |= !filtered;
+	}
+	if (filtered)
+	{
+		return;
+	}
+
+	DispatchRevert(target);
+}
+
+const URuneFilter* URuneEffect::ResolveFilter(const URuneFilter* usedInstigatorFilter) const
+{
+	if (!overrideFilter)
+	{
+		return usedInstigatorFilter;
+	}
+	return customFilter;
+}
+
+bool URuneEffect::FilterWith(const AActor& actor, const URuneFilter* runeFilter) const
+{
+	if (runeFilter == nullptr)
+	{
+		return false;
+	}
+
+	return !(filterFaction & ~runeFilter->Filter(actor, GetClass()));
+}
+
+int32 URuneEffect::FilterBatchWith(TConstArrayView<const AActor*> actors, TBitArray<>& outFiltered, const URuneFilter* runeFilter) const
+{
+	const int32 num = actors.Num();
+	outFiltered.Init(false, num);
+
+	TArray<uint8, TInlineAllocator<128>> factionMasks;
+	if (runeFilter != nullptr)
+	{
+		factionMasks.SetNumUninitialized(num);
+		runeFilter->FilterBatch(actors, factionMasks, GetClass());
+	}
+
+	int32 unfilteredCount = 0;
+	for (int32 i = 0; i < num; ++i)
+	{
+		const bool filtered = actors[i] == nullptr
+			|| (runeFilter != nullptr && !(filterFaction & ~factionMasks[i]));
+		outFiltered[i] = filtered;
+		unfilteredCount += !filtered;
+	}
+
+	return unfilteredCount;
+}
+
+void URuneEffect::DispatchRevert(AActor* target)
+{
 	switch (applicationType)
 	{
 	case EApplicationType::IMMEDIATE:
 		RevertEffectInstant(target);
 		break;
 	case EApplicationType::OVER_TIME:
+		if (UEoTSubsystem* eotSubsystem = target->GetWorld() != nullptr ? target->GetWorld()->GetSubsystem<UEoTSubsystem>() : nullptr)
+		{
+			eotSubsystem->RemoveEffectOverTime(*this, *target);
+		}
 		onEffectReverted.Broadcast(target);
 		break;
 	case EApplicationType::STATUS:
@@ -160,6 +298,25 @@ void URuneEffect::InternalRevert(AActor* target, FBooleanPtr success)
 	}
 }
 
+void URuneEffect::DispatchApply(AController* instigator, AActor* causer, AActor* target)
+{
+	switch (applicationType)
+	{
+	case EApplicationType::IMMEDIATE:
+		ApplyEffectInstant(instigator , causer, target);
+		break;
+	case EApplicationType::OVER_TIME:
+		ApplyEffectOverTime(instigator, causer, target);
+		break;
+	case EApplicationType::STATUS:
+		ApplyEffectStatus(instigator, causer, target);
+		break;
+	default:
+		Apply(instigator, causer, target);
+		break;
+	}
+}
+
 void URuneEffect::ApplyEffectInstant(AController* instigator, AActor* causer, AActor* target)
 {
 	Apply(instigator, causer, target);
@@ -170,29 +327,26 @@ void URuneEffect::ApplyEffectInstant(AController* instigator, AActor* causer, AA
 
 void URuneEffect::ApplyEffectOverTime(AController* instigator, AActor* causer, AActor* target)
 {
-	UActorComponent* component = target->AddComponentByClass(UEoTComponent::StaticClass(), false, FTransform::Identity, true);
-	UEoTComponent* eotComponent = Cast<UEoTComponent>(component);
-	if (eotComponent == nullptr)
+	UWorld* world = target->GetWorld();
+	UEoTSubsystem* eotSubsystem = world != nullptr ? world->GetSubsystem<UEoTSubsystem>() : nullptr;
+	if (eotSubsystem == nullptr)
 	{
-		UE_LOG(LogTemp, Display, TEXT("[RuneEffect] EoTComponent is nullptr"));
+		UE_LOG(LogTemp, Display, TEXT("[RuneEffect] EoTSubsystem is nullptr"));
 		return;
 	}
-	eotComponent->Configure(this, instigator, ticks, duration, trimTickDistribution, tickRate);
-	onEffectReverted.AddDynamic(eotComponent, &UEoTComponent::RemoveFromOwner);
-	target->FinishAddComponent(component, false, FTransform::Identity);
+	eotSubsystem->AddEffectOverTime(*this, instigator, causer, *target, ticks, duration, trimTickDistribution, tickRate);
 }
 
 void URuneEffect::ApplyEffectStatus(AController* instigator, AActor* causer, AActor* target)
 {
-	UActorComponent* component = target->AddComponentByClass(UStatusComponent::StaticClass(), false, FTransform::Identity, true);
-	UStatusComponent* statusComponent = Cast<UStatusComponent>(component);
-	if (statusComponent == nullptr)
+	UWorld* world = target->GetWorld();
+	UStatusSubsystem* statusSubsystem = world != nullptr ? world->GetSubsystem<UStatusSubsystem>() : nullptr;
+	if (statusSubsystem == nullptr)
 	{
-		UE_LOG(LogTemp, Display, TEXT("[RuneEffect] StatusComponent is nullptr"));
+		UE_LOG(LogTemp, Display, TEXT("[RuneEffect] StatusSubsystem is nullptr"));
 		return;
 	}
-	statusComponent->Configure(this, instigator, duration);
-	target->FinishAddComponent(component, false, FTransform::Identity);
+	statusSubsystem->AddStatusEffect(*this, instigator, causer, *target, duration);
 }
 
 void URuneEffect::RevertEffectInstant(AActor* target)
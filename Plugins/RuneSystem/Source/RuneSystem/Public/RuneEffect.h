@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
 #include "Utils/RuneUtils.h"
+#include "RuneCostAccounting.h"
 #include "RuneEffect.generated.h"
 
 
@@ -44,10 +45,17 @@ public:
 	virtual bool CanEditChange(const FProperty* InProperty) const override;
 #endif
 
+	// Called when the effect is destroyed, invalidates the rune linking it
+	virtual void OnComponentDestroyed(bool bDestroyingHierarchy) override;
+
+	// Adds the memory of the delegates bindings, and of an owned custom filter when estimating the total
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+
 public:
 	/**
 	 * Manages the effect application to the specified AActor.
 	 * (e.g. substract X health points)
+	 * The applied effect may be a shared copy without owner, use causer rather than GetOwner().
 	 * 
 	 * @param instigator Controller that will spawn and/or control the causer
 	 * @param causer Actor which will apply the effect application.
@@ -121,6 +129,55 @@ public:
 	 */
 	bool Filter(const AActor& actor) const;
 
+	/**
+	 * Batch version of Filter().
+	 * The used filter is resolved once for all the actors.
+	 * Null actors are always filtered.
+	 *
+	 * @param actors Actors to be filtered.
+	 * @param outFiltered Whether each actor is filtered (discarded from the flow).
+	 * @return Number of actors that have NOT been filtered.
+	 */
+	int32 FilterBatch(TConstArrayView<const AActor*> actors, TBitArray<>& outFiltered) const;
+
+	/**
+	 * Context version of Filter().
+	 * The instigator filter of the context is used instead of the cached one.
+	 *
+	 * @param actor Actor to be filtered.
+	 * @param context Runtime context of the application.
+	 * @return If true, actor is filtered (discarded from the flow).
+	 */
+	bool Filter(const AActor& actor, const FRuneEffectContext& context) const;
+
+	/**
+	 * Context version of FilterBatch().
+	 *
+	 * @param actors Actors to be filtered.
+	 * @param outFiltered Whether each actor is filtered (discarded from the flow).
+	 * @param context Runtime context of the application.
+	 * @return Number of actors that have NOT been filtered.
+	 */
+	int32 FilterBatch(TConstArrayView<const AActor*> actors, TBitArray<>& outFiltered, const FRuneEffectContext& context) const;
+
+	/**
+	 * Creates the runtime context of an application of this effect,
+	 * using the cached instigator and instigator filter.
+	 *
+	 * @param causer Actor which will apply the effect application.
+	 * @return Runtime context.
+	 */
+	FRuneEffectContext MakeContext(AActor* causer) const;
+
+	/**
+	 * Copies the effect, along with the state not duplicated with its properties (i.e. its cost owner).
+	 * Every copy of a rune effect should be made this way.
+	 *
+	 * @param outer Outer of the copy.
+	 * @return Copy, nullptr if it could not be made.
+	 */
+	URuneEffect* DuplicateEffect(UObject* outer) const;
+
 protected:
 	/**
 	 * Manages the effect application to the specified AActor.
@@ -161,6 +218,50 @@ private:
 	UFUNCTION()
 	virtual void InternalRevert(AActor* target, FBooleanPtr success);
 
+	/**
+	 * Context version of InternalApply(), used by effects attached to agents.
+	 */
+	void InternalApplyWithContext(const FRuneEffectContext& context, AActor* target, FBooleanPtr success);
+
+	/**
+	 * Context version of InternalRevert(), used by effects attached to agents.
+	 */
+	void InternalRevertWithContext(const FRuneEffectContext& context, AActor* target, FBooleanPtr success);
+
+	/**
+	 * Gets the filter used along with the given instigator filter.
+	 *
+	 * @param usedInstigatorFilter Instigator filter
+	 * @return Used filter, either it is CustomFilter or the instigator filter.
+	 */
+	const URuneFilter* ResolveFilter(const URuneFilter* usedInstigatorFilter) const;
+
+	/**
+	 * Filter() with an already resolved filter.
+	 */
+	bool FilterWith(const AActor& actor, const URuneFilter* runeFilter) const;
+
+	/**
+	 * FilterBatch() with an already resolved filter.
+	 */
+	int32 FilterBatchWith(TConstArrayView<const AActor*> actors, TBitArray<>& outFiltered, const URuneFilter* runeFilter) const;
+
+	/**
+	 * Reverts the effect by its application type, without filtering.
+	 *
+	 * @param target Actor which will recieve the effect "undo".
+	 */
+	void DispatchRevert(AActor* target);
+
+	/**
+	 * Applies the effect by its application type, without filtering.
+	 *
+	 * @param instigator Controller that will spawn and/or control the causer
+	 * @param causer Actor which will apply the effect application.
+	 * @param target Actor which will recieve the effect application.
+	 */
+	void DispatchApply(AController* instigator, AActor* causer, AActor* target);
+
 	/**
 	 * Apply() wrapper.
 	 * Added for consistency with the other EApplicationTypes
@@ -173,7 +274,7 @@ private:
 
 	/**
 	 * Delegates the Apply() and Revert() functionality
-	 * to an Effect over Time component (EoTComponent).
+	 * to the world's Effect over Time subsystem (EoTSubsystem).
 	 *
 	 * @param instigator Controller that will spawn and/or control the causer
 	 * @param causer Actor which will apply the effect application.
@@ -183,7 +284,7 @@ private:
 
 	/**
 	 * Delegates the Apply() and Revert() functionality
-	 * to an Status component (StatusComponent).
+	 * to the world's Status subsystem (StatusSubsystem).
 	 *
 	 * @param instigator Controller that will spawn and/or control the causer
 	 * @param causer Actor which will apply the effect application.
@@ -240,6 +341,14 @@ public:
 	 */
 	UPROPERTY(EditAnywhere, Category = "RuneEffect: General Settings", meta = (EditCondition = "applicationType==EApplicationType::OVER_TIME", EditConditionHides))
 	bool trimTickDistribution;
+
+	/**
+	 * Whether the effect keeps state of its own between applications (e.g. Blueprint variables written in Apply).
+	 * Applications that may outlive the effect (agents, over time, status) share a read-only copy of it by default;
+	 * if true, each of them gets its own copy instead.
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = "RuneEffect: General Settings", AdvancedDisplay)
+	bool isStateful;
 	
 	/** Delegate invoked when a effect has been applied */
 	UPROPERTY(BlueprintAssignable, Category = "RuneEffect: General Settings")
@@ -266,10 +375,17 @@ protected:
 	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category = "RuneEffect: Debug Variables")
 	const URuneFilter* instigatorFilter;
 
+	/** Rune configuration the costs of the effect are accounted to, set when the rune is configured */
+	FRuneCostOwner costOwner;
+
 private:
 	friend class UEoTComponent;
+	friend class UEoTSubsystem;
 	friend class UStatusComponent;
+	friend class UStatusSubsystem;
 	friend class URuneBaseComponent;
+	friend class URuneBehaviour;
 	friend class ARuneTangibleAgent;
 	friend class URuneUtils;
+	friend class FRuneMemoryReport;
 };
@@ -3,6 +3,9 @@
 
 #include "RuneFilter.h"
 #include "RuneEffect.h"
+#include "RuneFilterCache.h"
+#include "Utils/RunePropertyCopyPlan.h"
+#include "Utils/RuneStats.h"
 
 
 FRuneFilterData::FRuneFilterData() :
@@ -17,295 +20,430 @@ FRuneFilterData::FRuneFilterData() :
 {
 }
 
-URuneFilter::URuneFilter() :
-	runeFilterData(),
-	runeFilterDataOverrides()
+void FRuneCompiledFilter::Compile(const FRuneFilterData& filterData, const TMap<TSubclassOf<URuneEffect>, FRuneFilterData>& filterDataOverrides)
 {
+	Reset();
+
+	slots.Reserve(filterDataOverrides.Num() + 1);
+	overrideSlots.Reserve(filterDataOverrides.Num());
+
+	// default data is always the first slot
+	CompileSlot(filterData);
+
+	for (const TPair<TSubclassOf<URuneEffect>, FRuneFilterData>& overridePair : filterDataOverrides)
+	{
+		if (overridePair.Key == nullptr) continue;
+
+		overrideSlots.Add(overridePair.Key.Get(), slots.Num());
+		CompileSlot(overridePair.Value);
+	}
+
+	slots.Shrink();
+	actorClasses.Shrink();
+	componentClasses.Shrink();
+
+	classLayoutEpoch = FRunePropertyCopyPlan::GetClassLayoutEpoch();
 }
 
-#if WITH_EDITOR
-bool URuneFilter::CanEditChange(const FProperty* InProperty) const
+void FRuneCompiledFilter::Reset()
 {
-	const bool result = Super::CanEditChange(InProperty);
+	slots.Reset();
+	actorClasses.Reset();
+	componentClasses.Reset();
+	overrideSlots.Reset();
+}
 
-	/*if (InProperty->GetFName() == GET_MEMBER_NAME_CHECKED(URuneFilter, factionAActorClassFilter))
+bool FRuneCompiledFilter::IsUpToDate() const
+{
+	return IsCompiled() && classLayoutEpoch == FRunePropertyCopyPlan::GetClassLayoutEpoch();
+}
+
+int32 FRuneCompiledFilter::GetSlotIndex(const UClass* effectClass) const
+{
+	if (effectClass == nullptr || overrideSlots.Num() == 0)
 	{
-		return result && IsFilteredByType(ERuneFilterType::ACTOR_CLASS);
+		return DefaultSlot;
 	}
 
-	if (InProperty->GetFName() == GET_MEMBER_NAME_CHECKED(URuneFilter, factionATagsFilter))
+	const int32* slotIndex = overrideSlots.Find(effectClass);
+	return slotIndex != nullptr ? *slotIndex : DefaultSlot;
+}
+
+uint8 FRuneCompiledFilter::Filter(const AActor& actor, int32 slotIndex) const
+{
+	const FRuneCompiledFilterSlot& slot = slots[slotIndex];
+
+	// usage is applied per type, as each type is a filter on its own
+	uint8 filtered = static_cast<uint8>(ERuneFilterFaction::NONE);
+	if (slot.filterType & static_cast<uint8>(ERuneFilterType::ACTOR_CLASS))
 	{
-		return result && IsFilteredByType(ERuneFilterType::TAGS);
+		filtered |= MatchActorClass(actor, slot) ^ slot.usageMask;
 	}
-
-	if (InProperty->GetFName() == GET_MEMBER_NAME_CHECKED(URuneFilter, factionAComponentClassFilter))
+	if (slot.filterType & static_cast<uint8>(ERuneFilterType::TAGS))
 	{
-		return result && IsFilteredByType(ERuneFilterType::COMPONENT_CLASS);
+		filtered |= MatchTags(actor, slot) ^ slot.usageMask;
+	}
+	if (slot.filterType & static_cast<uint8>(ERuneFilterType::COMPONENT_CLASS))
+	{
+		filtered |= MatchComponentClass(actor, slot) ^ slot.usageMask;
 	}
 
-	if (InProperty->GetFName() == GET_MEMBER_NAME_CHECKED(URuneFilter, factionBActorClassFilter))
+	return filtered;
+}
+
+void FRuneCompiledFilter::FilterBatch(TConstArrayView<const AActor*> actors, int32 slotIndex, TArrayView<uint8> outFactionMasks) const
+{
+	check(actors.Num() == outFactionMasks.Num());
+
+	const FRuneCompiledFilterSlot& slot = slots[slotIndex];
+	const int32 num = actors.Num();
+	FMemory::Memzero(outFactionMasks.GetData(), num * sizeof(uint8));
+
+	if (slot.filterType & static_cast<uint8>(ERuneFilterType::ACTOR_CLASS))
 	{
-		return result && IsFilteredByType(ERuneFilterType::ACTOR_CLASS);
+		// gather classes so each entry runs a tight loop over contiguous data
+		TArray<const UClass*, TInlineAllocator<128>> targetClasses;
+		targetClasses.SetNumUninitialized(num);
+		for (int32 i = 0; i < num; ++i)
+		{
+			targetClasses[i] = actors[i] != nullptr ? actors[i]->GetClass() : AActor::StaticClass();
+		}
+
+		TArray<uint8, TInlineAllocator<128>> matches;
+		matches.SetNumZeroed(num);
+		for (int32 entryIndex = slot.actorClassBegin; entryIndex < slot.actorClassEnd; ++entryIndex)
+		{
+			const FRuneCompiledClassEntry& entry = actorClasses[entryIndex];
+			for (int32 i = 0; i < num; ++i)
+			{
+				matches[i] |= entry.factionMask * targetClasses[i]->IsChildOf(entry.filterClass);
+			}
+		}
+
+		for (int32 i = 0; i < num; ++i)
+		{
+			outFactionMasks[i] |= matches[i] ^ slot.usageMask;
+		}
 	}
 
-	if (InProperty->GetFName() == GET_MEMBER_NAME_CHECKED(URuneFilter, factionBTagsFilter))
+	if (slot.filterType & static_cast<uint8>(ERuneFilterType::TAGS))
 	{
-		return result && IsFilteredByType(ERuneFilterType::TAGS);
+		for (int32 i = 0; i < num; ++i)
+		{
+			if (actors[i] == nullptr) continue;
+			outFactionMasks[i] |= MatchTags(*actors[i], slot) ^ slot.usageMask;
+		}
 	}
 
-	if (InProperty->GetFName() == GET_MEMBER_NAME_CHECKED(URuneFilter, factionBComponentClassFilter))
+	if (slot.filterType & static_cast<uint8>(ERuneFilterType::COMPONENT_CLASS))
 	{
-		return result && IsFilteredByType(ERuneFilterType::COMPONENT_CLASS);
-	}*/
+		for (int32 i = 0; i < num; ++i)
+		{
+			if (actors[i] == nullptr) continue;
+			outFactionMasks[i] |= MatchComponentClass(*actors[i], slot) ^ slot.usageMask;
+		}
+	}
 
-	return result;
+	// null actors are never filtered by any faction
+	for (int32 i = 0; i < num; ++i)
+	{
+		outFactionMasks[i] *= actors[i] != nullptr;
+	}
 }
-#endif
 
-ERuneFilterUsage URuneFilter::GetFilterUsage(TSubclassOf<URuneEffect> effectClass) const
+uint8 FRuneCompiledFilter::MatchActorClass(const AActor& actor, const FRuneCompiledFilterSlot& slot) const
 {
-	if (effectClass != nullptr && runeFilterDataOverrides.Contains(effectClass))
+	const UClass* actorClass = actor.GetClass();
+	uint8 factionMask = static_cast<uint8>(ERuneFilterFaction::NONE);
+	for (int32 i = slot.actorClassBegin; i < slot.actorClassEnd; ++i)
 	{
-		return runeFilterDataOverrides[effectClass].filterUsage;
+		const FRuneCompiledClassEntry& entry = actorClasses[i];
+		factionMask |= entry.factionMask * actorClass->IsChildOf(entry.filterClass);
 	}
 
-	return runeFilterData.filterUsage;
+	return factionMask;
 }
 
-bool URuneFilter::IsFilteredByType(ERuneFilterType type, TSubclassOf<URuneEffect> effectClass) const
+uint8 FRuneCompiledFilter::MatchTags(const AActor& actor, const FRuneCompiledFilterSlot& slot) const
 {
-	if (effectClass != nullptr && runeFilterDataOverrides.Contains(effectClass))
+	if (slot.tagFactions.Num() == 0)
 	{
-		return (runeFilterDataOverrides[effectClass].filterType & static_cast<uint8>(type)) != 0;
+		return static_cast<uint8>(ERuneFilterFaction::NONE);
 	}
 
-	return (runeFilterData.filterType & static_cast<uint8>(type)) != 0;
-}
-
-bool URuneFilter::TryGetActorClassFilter(TArray<TSubclassOf<AActor>>& outFilter, ERuneFilterFaction faction, TSubclassOf<URuneEffect> effectClass) const
-{
-	if (IsFilteredByType(ERuneFilterType::ACTOR_CLASS, effectClass))
+	// actors usually have fewer tags than filters, so hash the actor tags
+	uint8 factionMask = static_cast<uint8>(ERuneFilterFaction::NONE);
+	for (const FName& tag : actor.Tags)
 	{
-		if (effectClass != nullptr && runeFilterDataOverrides.Contains(effectClass))
+		if (const uint8* tagFactionMask = slot.tagFactions.Find(tag))
 		{
-			const TArray<TSubclassOf<AActor>>& ActorClassFilter = faction == ERuneFilterFaction::FACTION_B
-				? runeFilterDataOverrides[effectClass].factionBActorClassFilter 
-				: runeFilterDataOverrides[effectClass].factionAActorClassFilter;
-			outFilter = ActorClassFilter;
-			return true;
+			factionMask |= *tagFactionMask;
+			if (factionMask == static_cast<uint8>(ERuneFilterFaction::ALL)) break;
 		}
-
-		const TArray<TSubclassOf<AActor>>& ActorClassFilter = faction == ERuneFilterFaction::FACTION_B 
-			? runeFilterData.factionBActorClassFilter 
-			: runeFilterData.factionAActorClassFilter;
-		outFilter = ActorClassFilter;
-		return true;
 	}
 
-	return false;
+	return factionMask;
 }
 
-bool URuneFilter::TryGetTagsFilter(TArray<FName>& outFilter, ERuneFilterFaction faction, TSubclassOf<URuneEffect> effectClass) const
+uint8 FRuneCompiledFilter::MatchComponentClass(const AActor& actor, const FRuneCompiledFilterSlot& slot) const
 {
-	if (IsFilteredByType(ERuneFilterType::TAGS, effectClass))
+	if (slot.componentClassBegin == slot.componentClassEnd)
 	{
-		if (effectClass != nullptr && runeFilterDataOverrides.Contains(effectClass))
+		return static_cast<uint8>(ERuneFilterFaction::NONE);
+	}
+
+	// single pass over the owned components
+	uint8 factionMask = static_cast<uint8>(ERuneFilterFaction::NONE);
+	for (const UActorComponent* component : actor.GetComponents())
+	{
+		if (component == nullptr) continue;
+
+		const UClass* componentClass = component->GetClass();
+		for (int32 i = slot.componentClassBegin; i < slot.componentClassEnd; ++i)
 		{
-			const TArray<FName>& TagsFilter = faction == ERuneFilterFaction::FACTION_B 
-				? runeFilterDataOverrides[effectClass].factionBTagsFilter 
-				: runeFilterDataOverrides[effectClass].factionATagsFilter;
-			outFilter = TagsFilter;
-			return true;
+			const FRuneCompiledClassEntry& entry = componentClasses[i];
+			factionMask |= entry.factionMask * componentClass->IsChildOf(entry.filterClass);
 		}
 
-		const TArray<FName>& TagsFilter = faction == ERuneFilterFaction::FACTION_B 
-			? runeFilterData.factionBTagsFilter 
-			: runeFilterData.factionATagsFilter;
-		outFilter = TagsFilter;
-		return true;
+		if (factionMask == static_cast<uint8>(ERuneFilterFaction::ALL)) break;
 	}
 
-	return false;
+	return factionMask;
 }
 
-bool URuneFilter::TryGetComponentClassFilter(TArray<TSubclassOf<UActorComponent>>& outFilter, ERuneFilterFaction faction, TSubclassOf<URuneEffect> effectClass) const
+void FRuneCompiledFilter::CompileSlot(const FRuneFilterData& filterData)
 {
-	if (IsFilteredByType(ERuneFilterType::COMPONENT_CLASS, effectClass))
+	FRuneCompiledFilterSlot& slot = slots.AddDefaulted_GetRef();
+	slot.filterType = filterData.filterType;
+	slot.usageMask = filterData.filterUsage == ERuneFilterUsage::EXCLUSIVE
+		? static_cast<uint8>(ERuneFilterFaction::NONE)
+		: static_cast<uint8>(ERuneFilterFaction::ALL);
+
+	// actor classes
+	slot.actorClassBegin = actorClasses.Num();
+	for (const TSubclassOf<AActor>& actorClass : filterData.factionAActorClassFilter)
 	{
-		if (effectClass != nullptr && runeFilterDataOverrides.Contains(effectClass))
-		{
-			const TArray<TSubclassOf<UActorComponent>>& ComponentClassFilter = faction == ERuneFilterFaction::FACTION_B 
-				? runeFilterDataOverrides[effectClass].factionBComponentClassFilter 
-				: runeFilterDataOverrides[effectClass].factionAComponentClassFilter;
-			outFilter = ComponentClassFilter;
-			return true;
-		}
+		AddClassEntry(actorClasses, slot.actorClassBegin, actorClass.Get(), ERuneFilterFaction::FACTION_A);
+	}
+	for (const TSubclassOf<AActor>& actorClass : filterData.factionBActorClassFilter)
+	{
+		AddClassEntry(actorClasses, slot.actorClassBegin, actorClass.Get(), ERuneFilterFaction::FACTION_B);
+	}
+	slot.actorClassEnd = actorClasses.Num();
 
-		const TArray<TSubclassOf<UActorComponent>>& ComponentClassFilter = faction == ERuneFilterFaction::FACTION_B 
-			? runeFilterData.factionBComponentClassFilter 
-			: runeFilterData.factionAComponentClassFilter;
-		outFilter = ComponentClassFilter;
-		return true;
+	// tags
+	slot.tagFactions.Reserve(filterData.factionATagsFilter.Num() + filterData.factionBTagsFilter.Num());
+	for (const FName& tag : filterData.factionATagsFilter)
+	{
+		slot.tagFactions.FindOrAdd(tag) |= static_cast<uint8>(ERuneFilterFaction::FACTION_A);
+	}
+	for (const FName& tag : filterData.factionBTagsFilter)
+	{
+		slot.tagFactions.FindOrAdd(tag) |= static_cast<uint8>(ERuneFilterFaction::FACTION_B);
 	}
 
-	return false;
+	// component classes
+	slot.componentClassBegin = componentClasses.Num();
+	for (const TSubclassOf<UActorComponent>& componentClass : filterData.factionAComponentClassFilter)
+	{
+		AddClassEntry(componentClasses, slot.componentClassBegin, componentClass.Get(), ERuneFilterFaction::FACTION_A);
+	}
+	for (const TSubclassOf<UActorComponent>& componentClass : filterData.factionBComponentClassFilter)
+	{
+		AddClassEntry(componentClasses, slot.componentClassBegin, componentClass.Get(), ERuneFilterFaction::FACTION_B);
+	}
+	slot.componentClassEnd = componentClasses.Num();
 }
 
-uint8 URuneFilter::Filter(const AActor& actor, TSubclassOf<URuneEffect> effectClass) const
+void FRuneCompiledFilter::AddClassEntry(TArray<FRuneCompiledClassEntry>& entries, int32 rangeBegin, const UClass* filterClass, ERuneFilterFaction faction)
 {
-	uint8 filtered = static_cast<uint8>(ERuneFilterFaction::NONE);
-	for (ERuneFilterType type : TEnumRange<ERuneFilterType>())
-	{
-		if (!IsFilteredByType(type, effectClass)) continue;
+	// null classes never match anything
+	if (filterClass == nullptr) return;
 
-		switch (type)
+	for (int32 i = rangeBegin; i < entries.Num(); ++i)
+	{
+		if (entries[i].filterClass == filterClass)
 		{
-		case ERuneFilterType::ACTOR_CLASS:
-			filtered |= FilterByActorClass(actor, effectClass);
-			break;
-		case ERuneFilterType::TAGS:
-			filtered |= FilterByTags(actor, effectClass);
-			break;
-		case ERuneFilterType::COMPONENT_CLASS:
-			filtered |= FilterByComponentClass(actor, effectClass);
-			break;
+			entries[i].factionMask |= static_cast<uint8>(faction);
+			return;
 		}
 	}
 
-	return filtered;
+	entries.Add({ filterClass, static_cast<uint8>(faction) });
 }
 
-uint8 URuneFilter::FilterByActorClass(const AActor& actor, TSubclassOf<URuneEffect> effectClass) const
+URuneFilter::URuneFilter() :
+	runeFilterData(),
+	runeFilterDataOverrides()
 {
-	if (effectClass != nullptr && runeFilterDataOverrides.Contains(effectClass))
+}
+
+#if WITH_EDITOR
+bool URuneFilter::CanEditChange(const FProperty* InProperty) const
+{
+	const bool result = Super::CanEditChange(InProperty);
+
+	/*if (InProperty->GetFName() == GET_MEMBER_NAME_CHECKED(URuneFilter, factionAActorClassFilter))
 	{
-		return FilterByActorClassByFilterData(actor, runeFilterDataOverrides[effectClass]);
+		return result && IsFilteredByType(ERuneFilterType::ACTOR_CLASS);
 	}
 
-	return FilterByActorClassByFilterData(actor, runeFilterData);
-}
+	if (InProperty->GetFName() == GET_MEMBER_NAME_CHECKED(URuneFilter, factionATagsFilter))
+	{
+		return result && IsFilteredByType(ERuneFilterType::TAGS);
+	}
 
-uint8 URuneFilter::FilterByActorClassByFilterData(const AActor& actor, const FRuneFilterData& filterData) const
-{
-	uint8 factionMask = static_cast<uint8>(ERuneFilterFaction::NONE);
+	if (InProperty->GetFName() == GET_MEMBER_NAME_CHECKED(URuneFilter, factionAComponentClassFilter))
+	{
+		return result && IsFilteredByType(ERuneFilterType::COMPONENT_CLASS);
+	}
 
-	// faction A
-	{
-		const TArray<TSubclassOf<AActor>>& ActorClassFilter = filterData.factionAActorClassFilter;
-		bool result =
-			ActorClassFilter.ContainsByPredicate(
-				[&actor](const TSubclassOf<AActor>& actorClass) -> bool
-				{
-					return actor.IsA(actorClass);
-				}
-		);
-		factionMask |= (static_cast<uint8>(ERuneFilterFaction::FACTION_A) * result);
+	if (InProperty->GetFName() == GET_MEMBER_NAME_CHECKED(URuneFilter, factionBActorClassFilter))
+	{
+		return result && IsFilteredByType(ERuneFilterType::ACTOR_CLASS);
 	}
 
-	// faction B
-	{
-		const TArray<TSubclassOf<AActor>>& ActorClassFilter = filterData.factionBActorClassFilter;
-		bool result =
-			ActorClassFilter.ContainsByPredicate(
-				[&actor](const TSubclassOf<AActor>& actorClass) -> bool
-				{
-					return actor.IsA(actorClass);
-				}
-		);
-		factionMask |= (static_cast<uint8>(ERuneFilterFaction::FACTION_B) * result);
+	if (InProperty->GetFName() == GET_MEMBER_NAME_CHECKED(URuneFilter, factionBTagsFilter))
+	{
+		return result && IsFilteredByType(ERuneFilterType::TAGS);
 	}
 
-	return filterData.filterUsage == ERuneFilterUsage::EXCLUSIVE ?
-		factionMask :
-		~factionMask & static_cast<uint8>(ERuneFilterFaction::ALL);
+	if (InProperty->GetFName() == GET_MEMBER_NAME_CHECKED(URuneFilter, factionBComponentClassFilter))
+	{
+		return result && IsFilteredByType(ERuneFilterType::COMPONENT_CLASS);
+	}*/
+
+	return result;
 }
 
-uint8 URuneFilter::FilterByTags(const AActor& actor, TSubclassOf<URuneEffect> effectClass) const
+void URuneFilter::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
 {
-	if (effectClass != nullptr && runeFilterDataOverrides.Contains(effectClass))
-	{
-		return FilterByTagsByFilterData(actor, runeFilterDataOverrides[effectClass]);
-	}
+	Super::PostEditChangeProperty(PropertyChangedEvent);
 
-	return FilterByTagsByFilterData(actor, runeFilterData);
+	// any filtering data might have changed
+	Compile();
 }
 
-uint8 URuneFilter::FilterByTagsByFilterData(const AActor& actor, const FRuneFilterData& filterData) const
+void URuneFilter::PostEditUndo()
 {
-	uint8 factionMask = static_cast<uint8>(ERuneFilterFaction::NONE);
+	Super::PostEditUndo();
 
-	// allies
-	{
-		const TArray<FName>& TagsFilter = filterData.factionATagsFilter;
-		bool result =
-			TagsFilter.ContainsByPredicate(
-				[&actor](const FName& name) -> bool
-				{
-					return actor.Tags.Contains(name);
-				}
-		);
-		factionMask |= (static_cast<uint8>(ERuneFilterFaction::FACTION_A) * result);
+	// undo restores the filtering data without notifying property changes
+	Compile();
+}
+#endif
+
+void URuneFilter::PostLoad()
+{
+	Super::PostLoad();
+
+	Compile();
+}
+
+void URuneFilter::Compile()
+{
+	compiledFilter.Compile(runeFilterData, runeFilterDataOverrides);
+
+	// cached verdicts may have been computed with the previous data
+	FRuneFilterCache::Get().InvalidateAll();
+}
+
+ERuneFilterUsage URuneFilter::GetFilterUsage(TSubclassOf<URuneEffect> effectClass) const
+{
+	return GetFilterData(effectClass).filterUsage;
+}
+
+bool URuneFilter::IsFilteredByType(ERuneFilterType type, TSubclassOf<URuneEffect> effectClass) const
+{
+	return (GetFilterData(effectClass).filterType & static_cast<uint8>(type)) != 0;
+}
+
+bool URuneFilter::TryGetActorClassFilter(TArray<TSubclassOf<AActor>>& outFilter, ERuneFilterFaction faction, TSubclassOf<URuneEffect> effectClass) const
+{
+	const FRuneFilterData& filterData = GetFilterData(effectClass);
+	if ((filterData.filterType & static_cast<uint8>(ERuneFilterType::ACTOR_CLASS)) == 0)
+	{
+		return false;
 	}
 
-	// enemies
-	{
-		const TArray<FName>& TagsFilter = filterData.factionBTagsFilter;
-		bool result =
-			TagsFilter.ContainsByPredicate(
-				[&actor](const FName& name) -> bool
-				{
-					return actor.Tags.Contains(name);
-				}
-		);
-		factionMask |= (static_cast<uint8>(ERuneFilterFaction::FACTION_B) * result);
+	outFilter = faction == ERuneFilterFaction::FACTION_B
+		? filterData.factionBActorClassFilter
+		: filterData.factionAActorClassFilter;
+	return true;
+}
+
+bool URuneFilter::TryGetTagsFilter(TArray<FName>& outFilter, ERuneFilterFaction faction, TSubclassOf<URuneEffect> effectClass) const
+{
+	const FRuneFilterData& filterData = GetFilterData(effectClass);
+	if ((filterData.filterType & static_cast<uint8>(ERuneFilterType::TAGS)) == 0)
+	{
+		return false;
 	}
 
-	return filterData.filterUsage == ERuneFilterUsage::EXCLUSIVE ?
-		factionMask :
-		~factionMask & static_cast<uint8>(ERuneFilterFaction::ALL);
+	outFilter = faction == ERuneFilterFaction::FACTION_B
+		? filterData.factionBTagsFilter
+		: filterData.factionATagsFilter;
+	return true;
 }
 
-uint8 URuneFilter::FilterByComponentClass(const AActor& actor, TSubclassOf<URuneEffect> effectClass) const
+bool URuneFilter::TryGetComponentClassFilter(TArray<TSubclassOf<UActorComponent>>& outFilter, ERuneFilterFaction faction, TSubclassOf<URuneEffect> effectClass) const
 {
-	if (effectClass != nullptr && runeFilterDataOverrides.Contains(effectClass))
+	const FRuneFilterData& filterData = GetFilterData(effectClass);
+	if ((filterData.filterType & static_cast<uint8>(ERuneFilterType::COMPONENT_CLASS)) == 0)
 	{
-		return FilterByComponentClassByFilterData(actor, runeFilterDataOverrides[effectClass]);
+		return false;
 	}
 
-	return FilterByComponentClassByFilterData(actor, runeFilterData);
+	outFilter = faction == ERuneFilterFaction::FACTION_B
+		? filterData.factionBComponentClassFilter
+		: filterData.factionAComponentClassFilter;
+	return true;
 }
 
-uint8 URuneFilter::FilterByComponentClassByFilterData(const AActor& actor, const FRuneFilterData& filterData) const
+uint8 URuneFilter::Filter(const AActor& actor, TSubclassOf<URuneEffect> effectClass) const
 {
-	uint8 factionMask = static_cast<uint8>(ERuneFilterFaction::NONE);
+	RUNE_SCOPE_CYCLE_COUNTER(STAT_RuneFilter, "URuneFilter::Filter");
+	RUNE_SCOPE_PROFILE_PHASE(FILTER);
+
+	return FRuneFilterCache::Get().FindOrFilter(*this, effectClass.Get(), actor,
+		[this, &actor, &effectClass]() -> uint8
+		{
+			const FRuneCompiledFilter& compiled = GetCompiledFilter();
+			return compiled.Filter(actor, compiled.GetSlotIndex(effectClass.Get()));
+		});
+}
+
+void URuneFilter::FilterBatch(TConstArrayView<const AActor*> actors, TArrayView<uint8> outFactionMasks, TSubclassOf<URuneEffect> effectClass) const
+{
+	RUNE_SCOPE_CYCLE_COUNTER(STAT_RuneFilter, "URuneFilter::FilterBatch");
+	RUNE_SCOPE_PROFILE_PHASE(FILTER);
+
+	const FRuneCompiledFilter& compiled = GetCompiledFilter();
+	compiled.FilterBatch(actors, compiled.GetSlotIndex(effectClass.Get()), outFactionMasks);
+}
 
-	// faction A
-	{
-		const TArray<TSubclassOf<UActorComponent>>& ComponentClassFilter = filterData.factionAComponentClassFilter;
-		bool result =
-			ComponentClassFilter.ContainsByPredicate(
-				[&actor](const TSubclassOf<UActorComponent>& componentClass) -> bool
-				{
-					return actor.GetComponentByClass(componentClass) != nullptr;
-				}
-		);
-		factionMask |= (static_cast<uint8>(ERuneFilterFaction::FACTION_A) * result);
+const FRuneFilterData& URuneFilter::GetFilterData(TSubclassOf<URuneEffect> effectClass) const
+{
+	if (effectClass != nullptr)
+	{
+		if (const FRuneFilterData* filterDataOverride = runeFilterDataOverrides.Find(effectClass))
+		{
+			return *filterDataOverride;
+		}
 	}
 
-	// faction B
-	{
-		const TArray<TSubclassOf<UActorComponent>>& ComponentClassFilter = filterData.factionBComponentClassFilter;
-		bool result =
-			ComponentClassFilter.ContainsByPredicate(
-				[&actor](const TSubclassOf<UActorComponent>& componentClass) -> bool
-				{
-					return actor.GetComponentByClass(componentClass) != nullptr;
-				}
-		);
-		factionMask |= (static_cast<uint8>(ERuneFilterFaction::FACTION_B) * result);
+	return runeFilterData;
+}
+
+const FRuneCompiledFilter& URuneFilter::GetCompiledFilter() const
+{
+	// instanced or runtime created filters may not have been loaded,
+	// and reinstanced classes leave the compiled ones dangling
+	if (!compiledFilter.IsUpToDate())
+	{
+		compiledFilter.Compile(runeFilterData, runeFilterDataOverrides);
+		FRuneFilterCache::Get().InvalidateAll();
 	}
 
-	return filterData.filterUsage == ERuneFilterUsage::EXCLUSIVE ?
-		factionMask :
-		~factionMask & static_cast<uint8>(ERuneFilterFaction::ALL);
+	return compiledFilter;
 }
@@ -81,6 +81,149 @@ public:
 };
 
 
+/** Class entry of a compiled filter, with the factions it belongs to */
+struct FRuneCompiledClassEntry
+{
+	/** Class used for filtering */
+	const UClass* filterClass;
+
+	/** Faction bitmask the class belongs to */
+	uint8 factionMask;
+};
+
+/**
+ * Flattened version of a FRuneFilterData.
+ * Class ranges point into the contiguous arrays of its FRuneCompiledFilter.
+ */
+struct FRuneCompiledFilterSlot
+{
+	/** ERuneFilterType bitmask */
+	uint8 filterType = 0;
+
+	/** Mask xor-ed into each per-type result, ALL if INCLUSIVE, NONE if EXCLUSIVE */
+	uint8 usageMask = 0;
+
+	/** [begin, end) range inside FRuneCompiledFilter::actorClasses */
+	int32 actorClassBegin = 0;
+	int32 actorClassEnd = 0;
+
+	/** [begin, end) range inside FRuneCompiledFilter::componentClasses */
+	int32 componentClassBegin = 0;
+	int32 componentClassEnd = 0;
+
+	/** Pre-hashed tags, each one with the factions it belongs to */
+	TMap<FName, uint8> tagFactions;
+};
+
+/**
+ * Compiled form of a URuneFilter.
+ * Default data and every override are flattened into slots so that
+ * filtering an actor costs one hashed lookup plus a few bit operations.
+ */
+struct RUNESYSTEM_API FRuneCompiledFilter
+{
+public:
+	/** Slot index used by the default filter data */
+	static constexpr int32 DefaultSlot = 0;
+
+	/**
+	 * Flattens the given filter data and overrides.
+	 * Any previously compiled data is discarded.
+	 *
+	 * @param filterData Default filter data
+	 * @param filterDataOverrides Filter data per effect class
+	 */
+	void Compile(const FRuneFilterData& filterData, const TMap<TSubclassOf<class URuneEffect>, FRuneFilterData>& filterDataOverrides);
+
+	/** Discards the compiled data, forcing a recompilation on next use */
+	void Reset();
+
+	/**
+	 * Whether or not the filter has been compiled.
+	 *
+	 * @return If true, it is compiled
+	 */
+	bool IsCompiled() const { return slots.Num() > 0; }
+
+	/**
+	 * Whether or not the filter has been compiled since classes were last reinstanced.
+	 * Compiled classes are raw pointers, so they must not be used once reinstanced (e.g. blueprint recompiles).
+	 *
+	 * @return If true, it is compiled and its classes are still valid
+	 */
+	bool IsUpToDate() const;
+
+	/**
+	 * Gets the slot used by an effect class.
+	 *
+	 * @param effectClass Effect class to be filtered
+	 * @return Override slot if there is one, DefaultSlot otherwise.
+	 */
+	int32 GetSlotIndex(const UClass* effectClass) const;
+
+	/**
+	 * Gets a compiled slot.
+	 *
+	 * @param slotIndex Index returned by GetSlotIndex()
+	 * @return Compiled slot
+	 */
+	const FRuneCompiledFilterSlot& GetSlot(int32 slotIndex) const { return slots[slotIndex]; }
+
+	/**
+	 * Filters an actor by a compiled slot.
+	 *
+	 * @param actor Actor to be filtered.
+	 * @param slotIndex Index returned by GetSlotIndex()
+	 * @return Faction bitmask.
+	 */
+	uint8 Filter(const AActor& actor, int32 slotIndex) const;
+
+	/**
+	 * Filters many actors by a compiled slot, one type at a time.
+	 * Null actors get an empty faction bitmask.
+	 *
+	 * @param actors Actors to be filtered.
+	 * @param slotIndex Index returned by GetSlotIndex()
+	 * @param outFactionMasks Faction bitmask per actor. Same size as actors.
+	 */
+	void FilterBatch(TConstArrayView<const AActor*> actors, int32 slotIndex, TArrayView<uint8> outFactionMasks) const;
+
+	/**
+	 * Helper methods used to filter by a single type, before applying the usage mask.
+	 *
+	 * @param actor Actor to be filtered.
+	 * @param slot Compiled slot
+	 * @return Faction bitmask where the filter was successfull.
+	 */
+	uint8 MatchActorClass(const AActor& actor, const FRuneCompiledFilterSlot& slot) const;
+	uint8 MatchTags(const AActor& actor, const FRuneCompiledFilterSlot& slot) const;
+	uint8 MatchComponentClass(const AActor& actor, const FRuneCompiledFilterSlot& slot) const;
+
+private:
+	/** Appends a compiled slot for the given filter data */
+	void CompileSlot(const FRuneFilterData& filterData);
+
+	/** Adds a class to the last compiled range, merging factions if already present */
+	static void AddClassEntry(TArray<FRuneCompiledClassEntry>& entries, int32 rangeBegin, const UClass* filterClass, ERuneFilterFaction faction);
+
+private:
+	/** Compiled slots, DefaultSlot is always the default filter data */
+	TArray<FRuneCompiledFilterSlot> slots;
+
+	/** Contiguous actor class entries of every slot */
+	TArray<FRuneCompiledClassEntry> actorClasses;
+
+	/** Contiguous component class entries of every slot */
+	TArray<FRuneCompiledClassEntry> componentClasses;
+
+	/** Slot index per overridden effect class */
+	TMap<const UClass*, int32> overrideSlots;
+
+	/** Class layout epoch the classes were compiled at, see FRunePropertyCopyPlan::GetClassLayoutEpoch() */
+	uint32 classLayoutEpoch = 0;
+};
+
+
 /**
  * 
  */
@@ -104,9 +247,21 @@ public:
 	 * @return true if the property can be modified in the editor, otherwise false
 	 */
 	virtual bool CanEditChange(const FProperty* InProperty) const override;
+
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+	virtual void PostEditUndo() override;
 #endif
 
+	virtual void PostLoad() override;
+
 public:
+	/**
+	 * Flattens the filter data and its overrides into its compiled form.
+	 * It is done on load and on edit, but it can be forced if the
+	 * filter data gets modified at runtime.
+	 */
+	void Compile();
+
 	/**
 	 * Gets the filter usage.
 	 * 
@@ -161,6 +316,7 @@ public:
 	 * Whether it is applying an effect or checking whether an
 	 * effect can be applied to an actor, if it is filtered out,
 	 * the given actor should NOT get any effect.
+	 * Results may be cached per actor (rune.FilterCache.Enabled), see FRuneFilterCache.
 	 *
 	 * @param actor Actor to be filtered.
 	 * @param effectClass Effect class to be filtered
@@ -168,61 +324,33 @@ public:
 	 */
 	uint8 Filter(const AActor& actor, TSubclassOf<class URuneEffect> effectClass = nullptr) const;
 
-private:
 	/**
-	 * Helper method used to filter only by ActorClass.
+	 * Batch version of Filter().
+	 * Per filter work is done once for all the actors, which is
+	 * the preferred way of filtering area of effect targets.
+	 * Results are NOT cached.
 	 *
-	 * @param actor Actor to be filtered.
+	 * @param actors Actors to be filtered. Null actors get an empty bitmask.
+	 * @param outFactionMasks Faction bitmask per actor. Same size as actors.
 	 * @param effectClass Effect class to be filtered
-	 * @return Faction bitmask where the filter was successfull.
 	 */
-	uint8 FilterByActorClass(const AActor& actor, TSubclassOf<class URuneEffect> effectClass) const;
-
-	/**
-	 * Helper method used to filter only by ActorClass by a given filter data.
-	 *
-	 * @param actor Actor to be filtered.
-	 * @param filterData Filter data used to filter.
-	 * @param effectClass Effect class to be filtered
-	 * @return Faction bitmask where the filter was successfull.
-	 */
-	uint8 FilterByActorClassByFilterData(const AActor& actor, const FRuneFilterData& filterData) const;
-
-	/**
-	 * Helper method used to filter only by Tags.
-	 *
-	 * @param actor Actor to be filtered.
-	 * @param effectClass Effect class to be filtered
-	 * @return Faction bitmask where the filter was successfull.
-	 */
-	uint8 FilterByTags(const AActor& actor, TSubclassOf<class URuneEffect> effectClass) const;
-
-	/**
-	 * Helper method used to filter only by Tags by a given filter data.
-	 *
-	 * @param actor Actor to be filtered.
-	 * @param filterData Filter data used to filter.
-	 * @return Faction bitmask where the filter was successfull.
-	 */
-	uint8 FilterByTagsByFilterData(const AActor& actor, const FRuneFilterData& filterData) const;
+	void FilterBatch(TConstArrayView<const AActor*> actors, TArrayView<uint8> outFactionMasks, TSubclassOf<class URuneEffect> effectClass = nullptr) const;
 
+private:
 	/**
-	 * Helper method used to filter only by ComponentClass.
+	 * Gets the filter data used by an effect class.
 	 *
-	 * @param actor Actor to be filtered.
 	 * @param effectClass Effect class to be filtered
-	 * @return Faction bitmask where the filter was successfull.
+	 * @return Override filter data if there is one, default filter data otherwise.
 	 */
-	uint8 FilterByComponentClass(const AActor& actor, TSubclassOf<class URuneEffect> effectClass) const;
+	const FRuneFilterData& GetFilterData(TSubclassOf<class URuneEffect> effectClass) const;
 
 	/**
-	 * Helper method used to filter only by ComponentClass by a given filter data.
+	 * Gets the compiled filter, compiling it if needed or if classes have been reinstanced since.
 	 *
-	 * @param actor Actor to be filtered.
-	 * @param filterData Filter data used to filter.
-	 * @return Faction bitmask where the filter was successfull.
+	 * @return Compiled filter.
 	 */
-	uint8 FilterByComponentClassByFilterData(const AActor& actor, const FRuneFilterData& filterData) const;
+	const FRuneCompiledFilter& GetCompiledFilter() const;
 
 protected:
 	/** Default filtering data */
@@ -233,4 +361,8 @@ protected:
 	UPROPERTY(EditAnywhere, Category = "RuneFilter: Advanced Settings", meta = (ForceInlineRow))
 	TMap<TSubclassOf<class URuneEffect>, FRuneFilterData> runeFilterDataOverrides;
 
+private:
+	/** Compiled form of runeFilterData and runeFilterDataOverrides. Lazily built if not loaded. */
+	mutable FRuneCompiledFilter compiledFilter;
+
 };
@@ -0,0 +1,134 @@
+
+
+#include "RuneFilterCache.h"
+#include "RuneFilter.h"
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
+
+
+static TAutoConsoleVariable<bool> CVarRuneFilterCacheEnabled(
+	TEXT("rune.FilterCache.Enabled"),
+	false,
+	TEXT("Whether URuneFilter::Filter() results are cached per (filter, effect class, actor).\n")
+	TEXT("Off by default: changes of actor tags and components made outside of the rune system are not tracked,\n")
+	TEXT("so game code enabling it must call URuneUtils::InvalidateFilterCache() on those changes."));
+
+static TAutoConsoleVariable<int32> CVarRuneFilterCacheMaxEntries(
+	TEXT("rune.FilterCache.MaxEntries"),
+	16384,
+	TEXT("Number of cached filter verdicts before the cache is pruned down to three quarters of it."));
+
+static FAutoConsoleCommand CmdRuneFilterCacheStats(
+	TEXT("rune.FilterCache.Stats"),
+	TEXT("Logs the filter cache hit/miss counters."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		const FRuneFilterCache& cache = FRuneFilterCache::Get();
+		const uint64 total = cache.GetHits() + cache.GetMisses();
+		UE_LOG(LogTemp, Display, TEXT("[RuneFilterCache] hits: %llu, misses: %llu, hit ratio: %.2f%%, entries: %d"),
+			cache.GetHits(), cache.GetMisses(), total > 0 ? 100.0 * cache.GetHits() / total : 0.0, cache.GetNumEntries());
+	}));
+
+static FAutoConsoleCommand CmdRuneFilterCacheReset(
+	TEXT("rune.FilterCache.Reset"),
+	TEXT("Empties the filter cache and resets its counters."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		FRuneFilterCache::Get().Reset();
+		FRuneFilterCache::Get().ResetCounters();
+	}));
+
+
+FRuneFilterCache& FRuneFilterCache::Get()
+{
+	static FRuneFilterCache instance;
+	return instance;
+}
+
+uint8 FRuneFilterCache::FindOrFilter(const URuneFilter& filter, const UClass* effectClass, const AActor& actor, TFunctionRef<uint8()> filterFunc)
+{
+	if (!CVarRuneFilterCacheEnabled.GetValueOnGameThread())
+	{
+		return filterFunc();
+	}
+
+	if (entries.Num() >= CVarRuneFilterCacheMaxEntries.GetValueOnGameThread())
+	{
+		Prune();
+	}
+
+	const uint32 actorEpoch = GetActorEpoch(actor);
+	FEntry& entry = entries.FindOrAdd({ &filter, effectClass, &actor });
+	if (entry.globalEpoch == globalEpoch && entry.actorEpoch == actorEpoch)
+	{
+		++hits;
+		return entry.factionMask;
+	}
+
+	++misses;
+	entry.factionMask = filterFunc();
+	entry.actorEpoch = actorEpoch;
+	entry.globalEpoch = globalEpoch;
+
+	return entry.factionMask;
+}
+
+void FRuneFilterCache::InvalidateActor(const AActor& actor)
+{
+	++actorEpochs.FindOrAdd(&actor);
+}
+
+void FRuneFilterCache::InvalidateAll()
+{
+	++globalEpoch;
+}
+
+void FRuneFilterCache::Reset()
+{
+	entries.Reset();
+	actorEpochs.Reset();
+	++globalEpoch;
+}
+
+void FRuneFilterCache::ResetCounters()
+{
+	hits = 0;
+	misses = 0;
+}
+
+uint32 FRuneFilterCache::GetActorEpoch(const AActor& actor) const
+{
+	const uint32* actorEpoch = actorEpochs.Find(&actor);
+	return actorEpoch != nullptr ? *actorEpoch : 0;
+}
+
+void FRuneFilterCache::Prune()
+{
+	for (auto it = entries.CreateIterator(); it; ++it)
+	{
+		const FKey& key = it.Key();
+		const FEntry& entry = it.Value();
+		const AActor* actor = key.actor.ResolveObjectPtr();
+		if (actor == nullptr || key.filter.ResolveObjectPtr() == nullptr || entry.globalEpoch != globalEpoch || entry.actorEpoch != GetActorEpoch(*actor))
+		{
+			it.RemoveCurrent();
+		}
+	}
+
+	for (auto it = actorEpochs.CreateIterator(); it; ++it)
+	{
+		if (it.Key().ResolveObjectPtr() == nullptr)
+		{
+			it.RemoveCurrent();
+		}
+	}
+
+	// evict valid entries as well down to the low-water mark, so the next prune is a quarter of the cache away
+	const int32 lowWaterMark = CVarRuneFilterCacheMaxEntries.GetValueOnGameThread() * 3 / 4;
+	for (auto it = entries.CreateIterator(); it && entries.Num() > lowWaterMark; ++it)
+	{
+		it.RemoveCurrent();
+	}
+
+	entries.Compact();
+}
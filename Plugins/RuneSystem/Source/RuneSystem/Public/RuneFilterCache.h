@@ -0,0 +1,118 @@
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+#include "Templates/Function.h"
+
+class AActor;
+class URuneFilter;
+
+/**
+ * Cache of URuneFilter::Filter() results keyed by filter, effect class and actor.
+ *
+ * Entries are invalidated through epochs instead of being removed:
+ * - Per actor epoch, bumped when an actor's tags or components change.
+ * - Global epoch, bumped when any filter gets recompiled.
+ * 
+ * Game code modifying an actor's Tags (or adding/removing components outside
+ * of the rune system) should call InvalidateActor() to keep verdicts up to date.
+ * As those changes are not tracked, the cache is disabled by default (rune.FilterCache.Enabled).
+ *
+ * Once full (rune.FilterCache.MaxEntries), stale entries are removed, then valid ones
+ * until three quarters of the cache are left, so pruning is amortized over many lookups.
+ */
+class RUNESYSTEM_API FRuneFilterCache
+{
+public:
+	/**
+	 * Gets the global cache instance.
+	 *
+	 * @return Filter cache.
+	 */
+	static FRuneFilterCache& Get();
+
+	/**
+	 * Gets the cached faction bitmask, computing and caching it if missing or stale.
+	 *
+	 * @param filter Filter used to filter the actor
+	 * @param effectClass Effect class to be filtered
+	 * @param actor Actor to be filtered
+	 * @param filterFunc Function computing the faction bitmask on a cache miss
+	 * @return Faction bitmask.
+	 */
+	uint8 FindOrFilter(const URuneFilter& filter, const UClass* effectClass, const AActor& actor, TFunctionRef<uint8()> filterFunc);
+
+	/**
+	 * Invalidates every cached verdict of a given actor.
+	 *
+	 * @param actor Actor whose tags or components have changed
+	 */
+	void InvalidateActor(const AActor& actor);
+
+	/** Invalidates every cached verdict (e.g. when a filter has been recompiled) */
+	void InvalidateAll();
+
+	/** Removes all entries and epochs */
+	void Reset();
+
+	/** Resets hit and miss counters */
+	void ResetCounters();
+
+	/** Number of lookups served from the cache */
+	uint64 GetHits() const { return hits; }
+
+	/** Number of lookups that had to filter */
+	uint64 GetMisses() const { return misses; }
+
+	/** Number of cached entries, including stale ones */
+	int32 GetNumEntries() const { return entries.Num(); }
+
+private:
+	/** Cache key */
+	struct FKey
+	{
+		TObjectKey<URuneFilter> filter;
+		TObjectKey<UClass> effectClass;
+		TObjectKey<AActor> actor;
+
+		bool operator==(const FKey& other) const
+		{
+			return actor == other.actor && effectClass == other.effectClass && filter == other.filter;
+		}
+
+		friend uint32 GetTypeHash(const FKey& key)
+		{
+			return HashCombine(GetTypeHash(key.actor), HashCombine(GetTypeHash(key.effectClass), GetTypeHash(key.filter)));
+		}
+	};
+
+	/** Cached verdict, valid while both epochs match */
+	struct FEntry
+	{
+		uint8 factionMask = 0;
+		uint32 actorEpoch = 0;
+		uint32 globalEpoch = MAX_uint32;
+	};
+
+	/** Gets the current epoch of an actor */
+	uint32 GetActorEpoch(const AActor& actor) const;
+
+	/** Removes stale entries and epochs of actors no longer alive, then valid entries down to the low-water mark */
+	void Prune();
+
+private:
+	/** Cached verdicts */
+	TMap<FKey, FEntry> entries;
+
+	/** Epoch per actor. Missing actors are at epoch 0 */
+	TMap<TObjectKey<AActor>, uint32> actorEpochs;
+
+	/** Epoch shared by all entries */
+	uint32 globalEpoch = 0;
+
+	/** Lookup counters */
+	uint64 hits = 0;
+	uint64 misses = 0;
+};
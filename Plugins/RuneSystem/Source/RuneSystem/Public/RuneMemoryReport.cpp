@@ -0,0 +1,157 @@
+#include "RuneMemoryReport.h"
+#include "RuneBaseComponent.h"
+#include "RuneCastStateMachine.h"
+#include "RuneBehaviour.h"
+#include "RuneEffect.h"
+#include "RuneTangibleAgent.h"
+#include "ApplicationType/EoTComponent.h"
+#include "ApplicationType/EoTSubsystem.h"
+#include "ApplicationType/RuneSharedEffectsSubsystem.h"
+#include "ApplicationType/StatusComponent.h"
+#include "ApplicationType/StatusSubsystem.h"
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/UObjectHash.h"
+
+
+static FAutoConsoleCommandWithOutputDevice CmdRuneMemory(
+	TEXT("rune.Memory"),
+	TEXT("Logs the live rune objects and their memory, by class and by owning rune."),
+	FConsoleCommandWithOutputDeviceDelegate::CreateLambda([](FOutputDevice& ar)
+	{
+		FRuneMemoryReport report;
+		report.Gather();
+		report.Dump(ar);
+	}));
+
+
+void FRuneMemoryReport::Gather()
+{
+	classUsages.Reset();
+	runeUsages.Reset();
+	total = FUsage();
+
+	// templates are not live objects
+	const EObjectFlags excludedFlags = RF_ClassDefaultObject | RF_ArchetypeObject;
+
+	// states only know their state machine, whose rune is found through the configurations
+	TArray<UObject*> runes;
+	GetObjectsOfClass(URuneBaseComponent::StaticClass(), runes, true, excludedFlags, EInternalObjectFlags::Garbage);
+	TMap<const UObject*, const URuneBaseComponent*> stateMachineRunes;
+	for (const UObject* object : runes)
+	{
+		const URuneBaseComponent* rune = CastChecked<URuneBaseComponent>(object);
+		for (const FRuneConfiguration& rc : rune->runeConfigurations)
+		{
+			stateMachineRunes.Add(rc.runeCastStateMachine, rune);
+		}
+	}
+
+	UClass* const runeClasses[] = {
+		URuneBaseComponent::StaticClass(),
+		URuneCastStateMachine::StaticClass(),
+		UState::StaticClass(),
+		URuneBehaviour::StaticClass(),
+		URuneEffect::StaticClass(),
+		ARuneTangibleAgent::StaticClass(),
+		UEoTComponent::StaticClass(),
+		UStatusComponent::StaticClass(),
+		UEoTSubsystem::StaticClass(),
+		UStatusSubsystem::StaticClass(),
+		URuneSharedEffectsSubsystem::StaticClass()
+	};
+
+	TArray<UObject*> objects;
+	for (UClass* runeClass : runeClasses)
+	{
+		objects.Reset();
+		GetObjectsOfClass(runeClass, objects, true, excludedFlags, EInternalObjectFlags::Garbage);
+		for (UObject* object : objects)
+		{
+			const SIZE_T bytes = object->GetClass()->GetStructureSize() + object->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+
+			FUsage& classUsage = classUsages.FindOrAdd(object->GetClass()->GetName());
+			++classUsage.count;
+			classUsage.bytes += bytes;
+
+			FUsage& runeUsage = runeUsages.FindOrAdd(GetOwningRuneName(*object, stateMachineRunes));
+			++runeUsage.count;
+			runeUsage.bytes += bytes;
+
+			++total.count;
+			total.bytes += bytes;
+		}
+	}
+}
+
+void FRuneMemoryReport::Dump(FOutputDevice& ar) const
+{
+	DumpUsages(ar, TEXT("Rune memory by class"), classUsages);
+	DumpUsages(ar, TEXT("Rune memory by owning rune"), runeUsages);
+	ar.Logf(TEXT("Total: %d objects, %.1f KB"), total.count, total.bytes / 1024.0);
+}
+
+FString FRuneMemoryReport::GetOwningRuneName(UObject& object, const TMap<const UObject*, const URuneBaseComponent*>& stateMachineRunes)
+{
+	const URuneBaseComponent* rune = nullptr;
+	const FRuneCostOwner* costOwner = nullptr;
+	if (const URuneBaseComponent* runeComponent = Cast<URuneBaseComponent>(&object))
+	{
+		rune = runeComponent;
+	}
+	else if (const UState* state = Cast<UState>(&object))
+	{
+		rune = stateMachineRunes.FindRef(state->GetOuter());
+	}
+	else if (Cast<URuneCastStateMachine>(&object) != nullptr)
+	{
+		rune = stateMachineRunes.FindRef(&object);
+	}
+	else if (const URuneBehaviour* behaviour = Cast<URuneBehaviour>(&object))
+	{
+		costOwner = &behaviour->costOwner;
+	}
+	else if (const URuneEffect* effect = Cast<URuneEffect>(&object))
+	{
+		costOwner = &effect->costOwner;
+	}
+	else if (const UEoTComponent* eotComponent = Cast<UEoTComponent>(&object))
+	{
+		costOwner = eotComponent->runeEffect != nullptr ? &eotComponent->runeEffect->costOwner : nullptr;
+	}
+	else if (const UStatusComponent* statusComponent = Cast<UStatusComponent>(&object))
+	{
+		costOwner = statusComponent->runeEffect != nullptr ? &statusComponent->runeEffect->costOwner : nullptr;
+	}
+	else if (const ARuneTangibleAgent* agent = Cast<ARuneTangibleAgent>(&object))
+	{
+		// every attached effect belongs to the behaviour that spawned the agent
+		const int32 index = agent->attachedRuneEffects.IndexOfByPredicate([](const URuneEffect* effect) { return effect != nullptr; });
+		costOwner = index != INDEX_NONE ? &agent->attachedRuneEffects[index]->costOwner : nullptr;
+	}
+
+	// effect copies may outlive their rune
+	if (costOwner != nullptr && costOwner->IsSet())
+	{
+		rune = costOwner->rune.ResolveObjectPtr();
+		if (rune == nullptr)
+		{
+			return TEXT("(destroyed rune)");
+		}
+	}
+
+	return rune != nullptr ? FString::Printf(TEXT("%s.%s"), *GetNameSafe(rune->GetOwner()), *rune->GetName()) : TEXT("(none)");
+}
+
+void FRuneMemoryReport::DumpUsages(FOutputDevice& ar, const TCHAR* title, const TMap<FString, FUsage>& usages)
+{
+	TArray<TPair<FString, FUsage>> sortedUsages = usages.Array();
+	sortedUsages.Sort([](const TPair<FString, FUsage>& a, const TPair<FString, FUsage>& b) { return a.Value.bytes > b.Value.bytes; });
+
+	ar.Logf(TEXT("%s:"), title);
+	ar.Logf(TEXT("  %-64s %8s %12s"), TEXT("Name"), TEXT("Count"), TEXT("KB"));
+	for (const TPair<FString, FUsage>& pair : sortedUsages)
+	{
+		ar.Logf(TEXT("  %-64s %8d %12.1f"), *pair.Key, pair.Value.count, pair.Value.bytes / 1024.0);
+	}
+}
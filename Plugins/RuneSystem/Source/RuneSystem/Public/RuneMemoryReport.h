@@ -0,0 +1,67 @@
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class URuneBaseComponent;
+
+/**
+ * Live rune objects and their memory: runes, cast state machines and their states, behaviours,
+ * effects (copies included), tangible agents, and the components and subsystems applying or sharing effects.
+ * The memory of an object is its class size plus its exclusive resource size (see GetResourceSizeEx() of each class).
+ *
+ * Usage is grouped by class and by owning rune, and logged by rune.Memory.
+ */
+class RUNESYSTEM_API FRuneMemoryReport
+{
+public:
+	/** Live objects of a group and their memory */
+	struct FUsage
+	{
+		int32 count = 0;
+		SIZE_T bytes = 0;
+	};
+
+	/** Gathers the usage of every live rune object, replacing the previous one */
+	void Gather();
+
+	/**
+	 * Logs the usage by class, then by owning rune, the largest first.
+	 *
+	 * @param ar Output device the usage is logged to
+	 */
+	void Dump(FOutputDevice& ar) const;
+
+	/** Usage of every gathered object */
+	const FUsage& GetTotal() const { return total; }
+
+private:
+	/**
+	 * Gets the name of the rune owning an object.
+	 *
+	 * @param object Rune object
+	 * @param stateMachineRunes Rune of each cast state machine
+	 * @return Name of the owning rune, or why there is none
+	 */
+	static FString GetOwningRuneName(UObject& object, const TMap<const UObject*, const URuneBaseComponent*>& stateMachineRunes);
+
+	/**
+	 * Logs a table of usages, the largest first.
+	 *
+	 * @param ar Output device the usages are logged to
+	 * @param title Title of the table
+	 * @param usages Usages by name
+	 */
+	static void DumpUsages(FOutputDevice& ar, const TCHAR* title, const TMap<FString, FUsage>& usages);
+
+private:
+	/** Usage by object class */
+	TMap<FString, FUsage> classUsages;
+
+	/** Usage by owning rune */
+	TMap<FString, FUsage> runeUsages;
+
+	/** Usage of every object */
+	FUsage total;
+};
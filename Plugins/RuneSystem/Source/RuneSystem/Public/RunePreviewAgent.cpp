@@ -2,6 +2,7 @@
 
 
 #include "RunePreviewAgent.h"
+#include "Utils/RuneStats.h"
 
 
 ARunePreviewAgent::ARunePreviewAgent() :
@@ -13,6 +14,15 @@ ARunePreviewAgent::ARunePreviewAgent() :
 void ARunePreviewAgent::BeginPlay()
 {
 	Super::BeginPlay();
+
+	RUNE_INC_COUNTER(STAT_RuneAgentsAlive);
+}
+
+void ARunePreviewAgent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	RUNE_DEC_COUNTER(STAT_RuneAgentsAlive);
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void ARunePreviewAgent::Tick(float DeltaTime)
@@ -40,3 +50,9 @@ bool ARunePreviewAgent::IsHidden() const
 	return Super::IsHidden();
 }
 
+void ARunePreviewAgent::ResetAgent()
+{
+	// by default calls the blueprint version
+	ReceiveResetAgent();
+}
+
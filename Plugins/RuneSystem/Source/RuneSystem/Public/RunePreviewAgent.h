@@ -19,6 +19,9 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	// Called when the agent is destroyed or removed from the world
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 public:	
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
@@ -36,11 +39,26 @@ public:
 	UFUNCTION(BlueprintCallable)
 	virtual bool IsHidden() const;
 
+protected:
+	/**
+	 * Restores the preview agent state so that it can be reused.
+	 * Called once the behaviour that spawned it has hidden its preview,
+	 * after it has been hidden.
+	 */
+	virtual void ResetAgent();
+
+	/**
+	 * Blueprint version of ResetAgent() method.
+	 */
+	UFUNCTION(BlueprintImplementableEvent, meta = (DisplayName = "Reset Agent"))
+	void ReceiveResetAgent();
+
 protected:
 	UPROPERTY(EditAnywhere)
 	bool isInitializedHidden;
 
 private:
 	friend class URuneUtils;
+	friend class URuneAgentPool;
 
 };
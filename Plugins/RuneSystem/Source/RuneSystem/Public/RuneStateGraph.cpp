@@ -0,0 +1,118 @@
+
+
+#include "RuneStateGraph.h"
+
+
+int32 FRuneStateGraph::AddState(const UState& state)
+{
+	FGraphState& graphState = states.AddDefaulted_GetRef();
+	graphState.state = &state;
+
+	return states.Num() - 1;
+}
+
+void FRuneStateGraph::RemoveState(int32 stateIndex)
+{
+	if (!states.IsValidIndex(stateIndex)) return;
+
+	states[stateIndex] = FGraphState();
+	transitions.RemoveAll([stateIndex](const FTransition& transition)
+	{
+		return transition.sourceIndex == stateIndex || transition.targetIndex == stateIndex;
+	});
+	Compile();
+}
+
+void FRuneStateGraph::AddTransition(int32 sourceIndex, int32 targetIndex, ERuneTransitionCondition condition, float minTimeInState, FRuneNativeGuardDelegate guard)
+{
+	if (GetState(sourceIndex) == nullptr || GetState(targetIndex) == nullptr) return;
+
+	FTransition& transition = transitions.AddDefaulted_GetRef();
+	transition.sourceIndex = sourceIndex;
+	transition.targetIndex = targetIndex;
+	transition.condition = condition;
+	transition.minTimeInState = minTimeInState;
+	transition.guard = MoveTemp(guard);
+	Compile();
+}
+
+FRuneNativeState* FRuneStateGraph::GetNativeState(int32 stateIndex)
+{
+	return states.IsValidIndex(stateIndex) && states[stateIndex].state != nullptr ? &states[stateIndex].callbacks : nullptr;
+}
+
+const FRuneNativeState* FRuneStateGraph::GetNativeState(int32 stateIndex) const
+{
+	return states.IsValidIndex(stateIndex) && states[stateIndex].state != nullptr ? &states[stateIndex].callbacks : nullptr;
+}
+
+const UState* FRuneStateGraph::GetState(int32 stateIndex) const
+{
+	return states.IsValidIndex(stateIndex) ? states[stateIndex].state : nullptr;
+}
+
+int32 FRuneStateGraph::FindTransition(int32 sourceIndex, bool isPressed, bool wasPressed, bool wasReleased, float timeInState) const
+{
+	if (!states.IsValidIndex(sourceIndex)) return INDEX_NONE;
+
+	const FGraphState& graphState = states[sourceIndex];
+	const int32 lastTransition = graphState.firstTransition + graphState.numTransitions;
+	for (int32 i = graphState.firstTransition; i < lastTransition; ++i)
+	{
+		const FTransition& transition = transitions[i];
+		if (timeInState < transition.minTimeInState) continue;
+		// a press or release between ticks still triggers, even if the input level has changed back
+		if (transition.condition == ERuneTransitionCondition::PRESSED && !isPressed && !wasPressed) continue;
+		if (transition.condition == ERuneTransitionCondition::RELEASED && isPressed && !wasReleased) continue;
+		if (transition.guard.IsBound() && !transition.guard.Execute()) continue;
+
+		return transition.targetIndex;
+	}
+
+	return INDEX_NONE;
+}
+
+bool FRuneStateGraph::HasPolledTransitions(int32 stateIndex) const
+{
+	if (!states.IsValidIndex(stateIndex)) return false;
+
+	return states[stateIndex].hasPolledTransitions;
+}
+
+void FRuneStateGraph::Reset()
+{
+	states.Reset();
+	transitions.Reset();
+}
+
+void FRuneStateGraph::Compile()
+{
+	// stable, so transitions of a state keep their declaration order (priority)
+	transitions.StableSort([](const FTransition& a, const FTransition& b)
+	{
+		return a.sourceIndex < b.sourceIndex;
+	});
+
+	for (FGraphState& graphState : states)
+	{
+		graphState.firstTransition = 0;
+		graphState.numTransitions = 0;
+		graphState.hasPolledTransitions = false;
+	}
+
+	for (int32 i = 0; i < transitions.Num(); ++i)
+	{
+		const FTransition& transition = transitions[i];
+		FGraphState& graphState = states[transition.sourceIndex];
+		if (graphState.numTransitions == 0)
+		{
+			graphState.firstTransition = i;
+		}
+		++graphState.numTransitions;
+
+		// input conditions are met when the rune is woken up by the input itself
+		graphState.hasPolledTransitions |= transition.condition == ERuneTransitionCondition::ALWAYS
+			|| transition.minTimeInState > 0.0f
+			|| transition.guard.IsBound();
+	}
+}
@@ -0,0 +1,165 @@
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RuneStateGraph.generated.h"
+
+
+UENUM(BlueprintType)
+enum class ERuneTransitionCondition : uint8
+{
+	/** Transition as soon as the source state has ticked */
+	ALWAYS = 0,
+
+	/** Transition once the rune is pressed */
+	PRESSED,
+
+	/** Transition once the rune is released */
+	RELEASED
+};
+
+class UState;
+
+DECLARE_DELEGATE(FRuneNativeStateDelegate);
+DECLARE_DELEGATE_OneParam(FRuneNativeStateTickDelegate, float);
+DECLARE_DELEGATE_RetVal(bool, FRuneNativeGuardDelegate);
+
+/**
+ * Native callbacks of a state, run along with the dynamic delegates of its UState.
+ */
+struct FRuneNativeState
+{
+	/** Invoked just when entered the state */
+	FRuneNativeStateDelegate onEnter;
+
+	/** Invoked when the state ticks */
+	FRuneNativeStateTickDelegate onTick;
+
+	/** Invoked just when exited the state */
+	FRuneNativeStateDelegate onExit;
+};
+
+/**
+ * Transition table of a cast state machine.
+ *
+ * States are dense integer IDs (UState::stateIndex) indexing a contiguous array,
+ * and transitions are declared up front along with their conditions and guards.
+ * The table is compiled whenever it changes, keeping the transitions of each state
+ * contiguous, so finding the transition to take from a state only walks its own transitions.
+ */
+class RUNESYSTEM_API FRuneStateGraph
+{
+public:
+	/**
+	 * Adds a state to the graph.
+	 *
+	 * @param state UState of the graph state
+	 * @return Dense ID of the state
+	 */
+	int32 AddState(const UState& state);
+
+	/**
+	 * Removes a state from the graph, along with its transitions.
+	 * Its ID is not reused.
+	 *
+	 * @param stateIndex ID of the state
+	 */
+	void RemoveState(int32 stateIndex);
+
+	/**
+	 * Declares a transition between two states, taken when its condition and guard are met.
+	 *
+	 * @param sourceIndex ID of the source state
+	 * @param targetIndex ID of the target state
+	 * @param condition Input condition to meet
+	 * @param minTimeInState Time - in seconds - to spend in the source state before transitioning
+	 * @param guard Optional native guard, the transition is only taken if it returns true
+	 */
+	void AddTransition(int32 sourceIndex, int32 targetIndex, ERuneTransitionCondition condition, float minTimeInState = 0.0f, FRuneNativeGuardDelegate guard = FRuneNativeGuardDelegate());
+
+	/**
+	 * Gets the native callbacks of a state.
+	 *
+	 * @param stateIndex ID of the state
+	 * @return Native callbacks, nullptr if there is no such state
+	 */
+	FRuneNativeState* GetNativeState(int32 stateIndex);
+	const FRuneNativeState* GetNativeState(int32 stateIndex) const;
+
+	/**
+	 * Gets the UState of a state.
+	 *
+	 * @param stateIndex ID of the state
+	 * @return UState, nullptr if there is no such state
+	 */
+	const UState* GetState(int32 stateIndex) const;
+
+	/**
+	 * Finds the first transition of a state whose condition and guard are met.
+	 *
+	 * @param sourceIndex ID of the source state
+	 * @param isPressed Whether the rune is pressed
+	 * @param wasPressed Whether the rune has been pressed since the last tick, even if released since
+	 * @param wasReleased Whether the rune has been released since the last tick, even if pressed again since
+	 * @param timeInState Time - in seconds - spent in the source state
+	 * @return ID of the target state, INDEX_NONE if no transition is taken
+	 */
+	int32 FindTransition(int32 sourceIndex, bool isPressed, bool wasPressed, bool wasReleased, float timeInState) const;
+
+	/**
+	 * Whether a state has transitions that can only be taken by polling them every tick
+	 * (not triggered by inputs alone).
+	 *
+	 * @param stateIndex ID of the state
+	 * @return If true, the state needs to tick for its transitions
+	 */
+	bool HasPolledTransitions(int32 stateIndex) const;
+
+	/** Removes every state and transition */
+	void Reset();
+
+	/** Number of state IDs given, including removed states */
+	int32 Num() const { return states.Num(); }
+
+	/** Heap memory used by the states and transitions */
+	SIZE_T GetAllocatedSize() const { return states.GetAllocatedSize() + transitions.GetAllocatedSize(); }
+
+private:
+	/** Sorts the transitions by source state and caches the range of each state */
+	void Compile();
+
+private:
+	struct FGraphState
+	{
+		/** UState of the graph state, owned by the state machine. Null once removed */
+		const UState* state = nullptr;
+
+		/** Native callbacks */
+		FRuneNativeState callbacks;
+
+		/** First transition of the state in the compiled transitions */
+		int32 firstTransition = 0;
+
+		/** Number of transitions of the state */
+		int32 numTransitions = 0;
+
+		/** Whether any transition of the state has to be polled */
+		bool hasPolledTransitions = false;
+	};
+
+	struct FTransition
+	{
+		int32 sourceIndex = INDEX_NONE;
+		int32 targetIndex = INDEX_NONE;
+		ERuneTransitionCondition condition = ERuneTransitionCondition::ALWAYS;
+		float minTimeInState = 0.0f;
+		FRuneNativeGuardDelegate guard;
+	};
+
+	/** States indexed by ID */
+	TArray<FGraphState> states;
+
+	/** Transitions, contiguous per source state once compiled */
+	TArray<FTransition> transitions;
+};
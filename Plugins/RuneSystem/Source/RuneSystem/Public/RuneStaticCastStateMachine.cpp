@@ -0,0 +1,80 @@
+
+
+#include "RuneStaticCastStateMachine.h"
+
+
+void URuneStaticCastStateMachine::Init()
+{
+	Super::Init();
+
+	StartStaticMachine();
+}
+
+void URuneStaticCastStateMachine::TickCastStateMachine(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	// without UStates, this only consumes the wake up
+	Super::TickCastStateMachine(DeltaTime, TickType, ThisTickFunction);
+
+	if (!PrimaryComponentTick.bCanEverTick || !IsRunning()) return;
+
+	TickStaticMachine(DeltaTime);
+
+	// edges are only seen by one tick, the input level is kept
+	wasPressedSinceTick = false;
+	wasReleasedSinceTick = false;
+}
+
+bool URuneStaticCastStateMachine::IsIdle() const
+{
+	return !isPressed && !wasPressedSinceTick && IsStaticMachineInEntryState();
+}
+
+bool URuneStaticCastStateMachine::NeedsTick() const
+{
+	if (Super::NeedsTick()) return true;
+
+	return IsRunning() && StaticMachineNeedsTick();
+}
+
+float URuneStaticCastStateMachine::GetTimeInState() const
+{
+	return GetStaticMachineTimeInState();
+}
+
+void URuneStaticCastStateMachine::ActivateBehaviourSlots()
+{
+	for (int32 i = 0; i < GetNumLinkedSlots(); ++i)
+	{
+		ActivateBehaviourSlot(i);
+	}
+}
+
+void URuneStaticCastStateMachine::DeactivateBehaviourSlots()
+{
+	for (int32 i = 0; i < GetNumLinkedSlots(); ++i)
+	{
+		DeactivateBehaviourSlot(i);
+	}
+}
+
+void URuneStaticCastStateMachine::ShowBehaviourSlotPreviews()
+{
+	for (int32 i = 0; i < GetNumLinkedSlots(); ++i)
+	{
+		ShowBehaviourSlotPreview(i);
+	}
+}
+
+void URuneStaticCastStateMachine::HideBehaviourSlotPreviews()
+{
+	for (int32 i = 0; i < GetNumLinkedSlots(); ++i)
+	{
+		HideBehaviourSlotPreview(i);
+	}
+}
+
+int32 URuneStaticCastStateMachine::GetNumLinkedSlots() const
+{
+	// slots without a linked behaviour can not be accessed
+	return FMath::Min(GetBehaviourSlotCount(), GetBehaviourSlots().Num());
+}
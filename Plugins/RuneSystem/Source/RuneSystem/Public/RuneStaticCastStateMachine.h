@@ -0,0 +1,246 @@
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RuneCastStateMachine.h"
+#include "RuneStaticCastStateMachine.generated.h"
+
+
+/**
+ * Transition of a compile-time state machine, see TRuneStaticStateMachine.
+ *
+ * @tparam StateType Enum of the states
+ * @tparam MachineType Cast state machine passed to the guard
+ */
+template <typename StateType, typename MachineType>
+struct TRuneStaticTransition
+{
+	/** State to transition from */
+	StateType source;
+
+	/** State to transition to */
+	StateType target;
+
+	/** Input condition to meet */
+	ERuneTransitionCondition condition = ERuneTransitionCondition::ALWAYS;
+
+	/** Time - in seconds - to spend in the source state before transitioning */
+	float minTimeInState = 0.0f;
+
+	/** Optional guard, given the time spent in the source state. The transition is only taken if it returns true */
+	bool (*guard)(const MachineType&, float) = nullptr;
+};
+
+template <typename Traits>
+concept RuneStaticStateMachineTraits = std::is_enum_v<typename Traits::StateType> && requires()
+{
+	Traits::NumStates;
+	Traits::EntryState;
+	Traits::Transitions;
+};
+
+namespace RuneStaticStateMachine::Private
+{
+	/** Whether every transition of the table goes between valid states */
+	template <RuneStaticStateMachineTraits Traits>
+	consteval bool AreTransitionsValid()
+	{
+		auto isValidState = [](auto state) { return static_cast<int32>(state) >= 0 && static_cast<int32>(state) < Traits::NumStates; };
+		for (const auto& transition : Traits::Transitions)
+		{
+			if (!isValidState(transition.source) || !isValidState(transition.target)) return false;
+		}
+		return isValidState(Traits::EntryState);
+	}
+
+	template <int32 NumStates>
+	struct TStatesNeedingTick
+	{
+		bool values[NumStates] = {};
+
+		constexpr bool operator[](int32 index) const { return values[index]; }
+	};
+
+	/** Whether each state needs to tick, for its own tick or for its transitions */
+	template <RuneStaticStateMachineTraits Traits>
+	consteval TStatesNeedingTick<Traits::NumStates> ComputeStatesNeedingTick()
+	{
+		TStatesNeedingTick<Traits::NumStates> result;
+		for (int32 i = 0; i < Traits::NumStates; ++i)
+		{
+			result.values[i] = Traits::TicksState(static_cast<typename Traits::StateType>(i));
+		}
+
+		// input conditions are met when the rune is woken up by the input itself
+		for (const auto& transition : Traits::Transitions)
+		{
+			const bool isPolled = transition.condition == ERuneTransitionCondition::ALWAYS
+				|| transition.minTimeInState > 0.0f
+				|| transition.guard != nullptr;
+			result.values[static_cast<int32>(transition.source)] |= isPolled;
+		}
+		return result;
+	}
+}
+
+/**
+ * State machine whose states and transitions are known at compile time.
+ *
+ * The traits provide the states enum, the entry state, a constexpr transition table
+ * and static enter/tick/exit callbacks. Since everything is known at compile time,
+ * ticking the machine and walking its transitions is fully inlined, with no delegates,
+ * UObjects nor allocations involved. Transitions are taken instantly, one per tick.
+ *
+ * Traits must provide:
+ * - StateType: enum of the states, with values in [0, NumStates)
+ * - MachineType: cast state machine owning the state machine
+ * - NumStates, EntryState and Transitions (array of TRuneStaticTransition)
+ * - static void OnEnter(MachineType&, StateType), OnExit(MachineType&, StateType)
+ * - static void OnTick(MachineType&, StateType, float)
+ * - static constexpr bool TicksState(StateType), whether OnTick does something in a state
+ */
+template <RuneStaticStateMachineTraits Traits>
+class TRuneStaticStateMachine
+{
+public:
+	using StateType = typename Traits::StateType;
+	using MachineType = typename Traits::MachineType;
+
+	/**
+	 * Enters the entry state.
+	 *
+	 * @param machine Cast state machine owning this state machine
+	 */
+	void Start(MachineType& machine)
+	{
+		currentState = Traits::EntryState;
+		timeInState = 0.0f;
+		Traits::OnEnter(machine, currentState);
+	}
+
+	/**
+	 * Ticks the current state, then takes the first transition whose condition and guard are met.
+	 * Input conditions are met by the input level, or by an edge latched since the last tick,
+	 * so presses and releases happening within a single frame are not missed.
+	 *
+	 * @param machine Cast state machine owning this state machine
+	 * @param deltaTime Time - in seconds - since the last tick
+	 * @param isPressed Whether the rune is pressed
+	 * @param wasPressed Whether the rune has been pressed since the last tick
+	 * @param wasReleased Whether the rune has been released since the last tick
+	 */
+	FORCEINLINE void Tick(MachineType& machine, float deltaTime, bool isPressed, bool wasPressed, bool wasReleased)
+	{
+		timeInState += deltaTime;
+		Traits::OnTick(machine, currentState, deltaTime);
+
+		for (const TRuneStaticTransition<StateType, MachineType>& transition : Traits::Transitions)
+		{
+			if (transition.source != currentState) continue;
+			if (timeInState < transition.minTimeInState) continue;
+			if (transition.condition == ERuneTransitionCondition::PRESSED && !isPressed && !wasPressed) continue;
+			if (transition.condition == ERuneTransitionCondition::RELEASED && isPressed && !wasReleased) continue;
+			if (transition.guard != nullptr && !transition.guard(machine, timeInState)) continue;
+
+			Traits::OnExit(machine, currentState);
+			currentState = transition.target;
+			timeInState = 0.0f;
+			Traits::OnEnter(machine, currentState);
+			return;
+		}
+	}
+
+	/**
+	 * Whether the current state has to tick every frame, either for its own
+	 * OnTick or for transitions not triggered by inputs alone.
+	 *
+	 * @return If false, the state machine only has to tick when woken up
+	 */
+	bool NeedsTick() const { return StatesNeedingTick[static_cast<int32>(currentState)]; }
+
+	/** Whether the state machine is in its entry state */
+	bool IsInEntryState() const { return currentState == Traits::EntryState; }
+
+	StateType GetState() const { return currentState; }
+
+	float GetTimeInState() const { return timeInState; }
+
+private:
+	static_assert(RuneStaticStateMachine::Private::AreTransitionsValid<Traits>(), "Transition table references states out of [0, NumStates)");
+
+	/** Whether each state needs to tick, computed from the transition table */
+	static constexpr RuneStaticStateMachine::Private::TStatesNeedingTick<Traits::NumStates> StatesNeedingTick = RuneStaticStateMachine::Private::ComputeStatesNeedingTick<Traits>();
+
+private:
+	StateType currentState = Traits::EntryState;
+	float timeInState = 0.0f;
+};
+
+/**
+ * Base of the cast state machines driven by a TRuneStaticStateMachine instead of UStates.
+ *
+ * Subclasses own a TRuneStaticStateMachine and forward the hooks below to it,
+ * the rest of the cast state machine (inputs, pause, behaviour slots) works as usual.
+ * Since they have no UStates, onStateEnter/onStateTick/onStateExit are not broadcast.
+ */
+UCLASS(Abstract)
+class RUNESYSTEM_API URuneStaticCastStateMachine : public URuneCastStateMachine
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Init() override;
+	virtual void TickCastStateMachine(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	virtual bool IsIdle() const override;
+	virtual bool NeedsTick() const override;
+	virtual float GetTimeInState() const override;
+
+	/**
+	 * Gets the number of behaviour slots with a linked behaviour.
+	 *
+	 * @return Slots that can be activated
+	 */
+	int32 GetNumLinkedSlots() const;
+
+	/**
+	 * Activates every behaviour slot.
+	 */
+	void ActivateBehaviourSlots();
+
+	/**
+	 * Deactivates every behaviour slot.
+	 */
+	void DeactivateBehaviourSlots();
+
+	/**
+	 * Shows the preview of every behaviour slot.
+	 */
+	void ShowBehaviourSlotPreviews();
+
+	/**
+	 * Hides the preview of every behaviour slot.
+	 */
+	void HideBehaviourSlotPreviews();
+
+protected:
+	/** Enters the entry state of the static state machine */
+	virtual void StartStaticMachine() {};
+
+	/**
+	 * Ticks the static state machine.
+	 *
+	 * @param DeltaTime Time - in seconds - since the last tick
+	 */
+	virtual void TickStaticMachine(float DeltaTime) {};
+
+	/** Whether the static state machine is in its entry state */
+	virtual bool IsStaticMachineInEntryState() const { return true; };
+
+	/** Whether the static state machine has to tick every frame */
+	virtual bool StaticMachineNeedsTick() const { return false; };
+
+	/** Time - in seconds - spent in the current state of the static state machine */
+	virtual float GetStaticMachineTimeInState() const { return 0.0f; };
+
+};
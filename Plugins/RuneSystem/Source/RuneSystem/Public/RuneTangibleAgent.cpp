@@ -4,12 +4,25 @@
 #include "RuneTangibleAgent.h"
 #include "RunePreviewAgent.h"
 #include "RuneEffect.h"
+#include "RuneAgentPool.h"
+#include "ApplicationType/RuneSharedEffectsSubsystem.h"
+#include "Utils/RuneStats.h"
+#include "Algo/Count.h"
+#include "Engine/World.h"
 
 
 ARuneTangibleAgent::ARuneTangibleAgent() : 
 	duration(30.0f),
+	isPoolable(false),
 	previewAgentClass(nullptr),
-	attachedRuneEffects()
+	attachedRuneEffects(),
+	attachedEffectContexts(),
+	templateHash(0),
+	isInPool(false),
+	wasCollisionEnabled(true),
+	wasTickEnabled(true),
+	pausedComponents(),
+	attachedSourceEffects()
 {
 	// Set this actor to call Tick() every frame. You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
@@ -33,29 +46,157 @@ void ARuneTangibleAgent::BeginPlay()
 {
 	Super::BeginPlay();
 
+	// pooled agents are still alive, only destroyed ones are not
+	RUNE_INC_COUNTER(STAT_RuneAgentsAlive);
+
 	if (duration >= 0.0f)
 	{
 		SetLifeSpan(duration);
 	}
 }
 
+void ARuneTangibleAgent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	RUNE_DEC_COUNTER(STAT_RuneAgentsAlive);
+
+	ClearAttachedRuneEffects();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ARuneTangibleAgent::LifeSpanExpired()
+{
+	if (!isPoolable)
+	{
+		Super::LifeSpanExpired();
+		return;
+	}
+
+	ReleaseAgent();
+}
+
 void ARuneTangibleAgent::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 }
 
+void ARuneTangibleAgent::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+
+	// attached effects are owned by the world's URuneSharedEffectsSubsystem
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(attachedRuneEffects.GetAllocatedSize() + attachedEffectContexts.GetAllocatedSize() + attachedSourceEffects.GetAllocatedSize() + pausedComponents.GetAllocatedSize());
+}
+
+void ARuneTangibleAgent::ReleaseAgent()
+{
+	if (isInPool) return;
+
+	UWorld* world = GetWorld();
+	URuneAgentPool* agentPool = world != nullptr ? world->GetSubsystem<URuneAgentPool>() : nullptr;
+	if (agentPool == nullptr)
+	{
+		Destroy();
+		return;
+	}
+
+	agentPool->ReleaseTangibleAgent(*this);
+}
+
+bool ARuneTangibleAgent::IsInPool() const
+{
+	return isInPool;
+}
+
+void ARuneTangibleAgent::ResetAgent()
+{
+	// by default calls the blueprint version
+	ReceiveResetAgent();
+}
+
+void ARuneTangibleAgent::ActivateAgent()
+{
+	// by default calls the blueprint version
+	ReceiveActivateAgent();
+}
+
+void ARuneTangibleAgent::DeactivateAgent()
+{
+	SetLifeSpan(0.0f);
+	SetActorHiddenInGame(true);
+
+	wasCollisionEnabled = GetActorEnableCollision();
+	SetActorEnableCollision(false);
+
+	wasTickEnabled = IsActorTickEnabled();
+	SetActorTickEnabled(false);
+
+	pausedComponents.Reset();
+	for (UActorComponent* component : GetComponents())
+	{
+		if (component != nullptr && component->IsComponentTickEnabled())
+		{
+			component->SetComponentTickEnabled(false);
+			pausedComponents.Add(component);
+		}
+	}
+
+	// whoever spawned the agent binds again on reuse, bindings of the agent itself (e.g. from BeginPlay) are kept
+	ClearAttachedRuneEffects();
+	RemoveExternalBindings(onApplyEffects);
+	RemoveExternalBindings(onRevertEffects);
+
+	ResetAgent();
+}
+
+void ARuneTangibleAgent::ReactivateAgent(const FTransform& transform)
+{
+	SetActorTransform(transform, false, nullptr, ETeleportType::ResetPhysics);
+
+	SetActorEnableCollision(wasCollisionEnabled);
+	SetActorTickEnabled(wasTickEnabled);
+	for (UActorComponent* component : pausedComponents)
+	{
+		if (component != nullptr)
+		{
+			component->SetComponentTickEnabled(true);
+		}
+	}
+	pausedComponents.Reset();
+
+	SetActorHiddenInGame(false);
+
+	if (duration >= 0.0f)
+	{
+		SetLifeSpan(duration);
+	}
+
+	ActivateAgent();
+}
+
+void ARuneTangibleAgent::RemoveExternalBindings(FAgentApplicationDelegate& delegate) const
+{
+	for (UObject* object : delegate.GetAllObjects())
+	{
+		if (object != nullptr && object != this && !object->IsIn(this))
+		{
+			delegate.RemoveAll(object);
+		}
+	}
+}
+
 bool ARuneTangibleAgent::TryApplyEffects(AActor* actor)
 {
 	if(actor == nullptr) return false;
 
 	bool success = false;
 	FBooleanPtr successPtr({ &success });
-	for (URuneEffect* effect : attachedRuneEffects)
+	for (int32 i = 0; i < attachedRuneEffects.Num(); ++i)
 	{
-		if (effect != nullptr)
-		{
-			effect->InternalApply(effect->GetInstigator(), this, actor, successPtr);
-		}
+		URuneEffect* effect = attachedRuneEffects[i];
+		if (effect == nullptr) continue;
+
+		effect->InternalApplyWithContext(attachedEffectContexts[i], actor, successPtr);
 	}
 	onApplyEffects.Broadcast(actor, success);
 
@@ -68,12 +209,12 @@ bool ARuneTangibleAgent::TryRevertEffects(AActor* actor)
 
 	bool success = false;
 	FBooleanPtr successPtr({ &success });
-	for (URuneEffect* effect : attachedRuneEffects)
+	for (int32 i = 0; i < attachedRuneEffects.Num(); ++i)
 	{
-		if (effect != nullptr)
-		{
-			effect->InternalRevert(actor, successPtr);
-		}
+		URuneEffect* effect = attachedRuneEffects[i];
+		if (effect == nullptr) continue;
+
+		effect->InternalRevertWithContext(attachedEffectContexts[i], actor, successPtr);
 	}
 	onRevertEffects.Broadcast(actor, success);
 
@@ -85,14 +226,90 @@ bool ARuneTangibleAgent::CheckForApplicableEffects(AActor* actor)
 	if (actor == nullptr) return false;
 
 	bool result = false;
-	for (URuneEffect* effect : attachedRuneEffects)
+	for (int32 i = 0; i < attachedRuneEffects.Num(); ++i)
 	{
-		if (effect != nullptr)
+		const URuneEffect* effect = attachedRuneEffects[i];
+		if (effect == nullptr) continue;
+
+		result |= !effect->Filter(*actor, attachedEffectContexts[i]);
+	}
+	return result;
+}
+
+int32 ARuneTangibleAgent::TryApplyEffectsBatch(const TArray<AActor*>& actors)
+{
+	RUNE_SCOPE_CYCLE_COUNTER(STAT_RuneEffectApply, "ARuneTangibleAgent::TryApplyEffectsBatch");
+
+	const int32 num = actors.Num();
+	TConstArrayView<const AActor*> targets(actors.GetData(), num);
+
+	// null actors are filtered out as well, but they are not rejections
+	const int32 numTargets = num - Algo::Count(actors, nullptr);
+
+	TBitArray<> applied(false, num);
+	TBitArray<> filtered;
+	for (int32 e = 0; e < attachedRuneEffects.Num(); ++e)
+	{
+		URuneEffect* effect = attachedRuneEffects[e];
+		const FRuneEffectContext& context = attachedEffectContexts[e];
+		if (effect == nullptr) continue;
+
+		RUNE_SCOPE_PROFILE_PHASE(EFFECT_APPLY);
+		RUNE_SCOPE_COST(effect->costOwner, EFFECT_APPLY);
+
+		const int32 unfilteredCount = effect->FilterBatch(targets, filtered, context);
+		RUNE_INC_COUNTER_BY(STAT_RuneFilterRejections, numTargets - unfilteredCount);
+		RUNE_INC_COUNTER_BY(STAT_RuneEffectsApplied, unfilteredCount);
+		if (unfilteredCount == 0) continue;
+
+		for (int32 i = 0; i < num; ++i)
 		{
-			result |= !effect->Filter(*actor);
+			if (filtered[i]) continue;
+
+			applied[i] = true;
+			effect->DispatchApply(context.instigator, context.causer, actors[i]);
 		}
 	}
-	return result;
+
+	int32 appliedCount = 0;
+	for (int32 i = 0; i < num; ++i)
+	{
+		if (actors[i] == nullptr) continue;
+
+		appliedCount += applied[i];
+		onApplyEffects.Broadcast(actors[i], applied[i]);
+	}
+
+	return appliedCount;
+}
+
+bool ARuneTangibleAgent::CheckForApplicableEffectsBatch(const TArray<AActor*>& actors, TArray<AActor*>& outApplicableActors)
+{
+	const int32 num = actors.Num();
+	TConstArrayView<const AActor*> targets(actors.GetData(), num);
+	outApplicableActors.Reset();
+
+	TBitArray<> applicable(false, num);
+	TBitArray<> filtered;
+	for (int32 e = 0; e < attachedRuneEffects.Num(); ++e)
+	{
+		const URuneEffect* effect = attachedRuneEffects[e];
+		if (effect == nullptr) continue;
+		if (effect->FilterBatch(targets, filtered, attachedEffectContexts[e]) == 0) continue;
+
+		// applicable = applicable | !filtered
+		for (int32 i = 0; i < num; ++i)
+		{
+			applicable[i] = applicable[i] || !filtered[i];
+		}
+	}
+
+	for (TConstSetBitIterator<> it(applicable); it; ++it)
+	{
+		outApplicableActors.Add(actors[it.GetIndex()]);
+	}
+
+	return outApplicableActors.Num() > 0;
 }
 
 void ARuneTangibleAgent::SetAttachedRuneEffects(TArray<class UObject*> runeEffects)
@@ -102,10 +319,60 @@ void ARuneTangibleAgent::SetAttachedRuneEffects(TArray<class UObject*> runeEffec
 		URuneEffect* effect = Cast<URuneEffect>(object);
 		if (effect != nullptr)
 		{
-			URuneEffect* copy = DuplicateObject<URuneEffect>(effect, this);
-			attachedRuneEffects.Add(copy);
+			AttachRuneEffect(*effect);
+		}
+	}
+}
+
+void ARuneTangibleAgent::AttachRuneEffects(TConstArrayView<URuneEffect*> runeEffects)
+{
+	attachedRuneEffects.Reserve(attachedRuneEffects.Num() + runeEffects.Num());
+	attachedEffectContexts.Reserve(attachedEffectContexts.Num() + runeEffects.Num());
+	attachedSourceEffects.Reserve(attachedSourceEffects.Num() + runeEffects.Num());
+	for (URuneEffect* effect : runeEffects)
+	{
+		if (effect != nullptr)
+		{
+			AttachRuneEffect(*effect);
+		}
+	}
+}
+
+void ARuneTangibleAgent::ClearAttachedRuneEffects()
+{
+	UWorld* world = GetWorld();
+	URuneSharedEffectsSubsystem* sharedEffectsSubsystem = world != nullptr ? world->GetSubsystem<URuneSharedEffectsSubsystem>() : nullptr;
+	if (sharedEffectsSubsystem != nullptr)
+	{
+		for (int32 i = 0; i < attachedRuneEffects.Num(); ++i)
+		{
+			sharedEffectsSubsystem->ReleaseEffect(attachedSourceEffects[i], attachedRuneEffects[i]);
 		}
 	}
+
+	// the allocations are kept since agents are usually re-attached the same amount of effects
+	attachedRuneEffects.Reset();
+	attachedEffectContexts.Reset();
+	attachedSourceEffects.Reset();
+}
+
+void ARuneTangibleAgent::AttachRuneEffect(URuneEffect& runeEffect)
+{
+	UWorld* world = GetWorld();
+	URuneSharedEffectsSubsystem* sharedEffectsSubsystem = world != nullptr ? world->GetSubsystem<URuneSharedEffectsSubsystem>() : nullptr;
+	if (sharedEffectsSubsystem == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[RuneTangibleAgent] AttachRuneEffect(): RuneSharedEffectsSubsystem is nullptr, '%s' is not attached."), *runeEffect.GetName());
+		return;
+	}
+
+	// the shared copy outlives the caster, the context keeps what differs per agent
+	URuneEffect* sharedEffect = sharedEffectsSubsystem->AcquireEffect(runeEffect);
+	if (sharedEffect == nullptr) return;
+
+	attachedRuneEffects.Add(sharedEffect);
+	attachedEffectContexts.Add(runeEffect.MakeContext(this));
+	attachedSourceEffects.Add(&runeEffect);
 }
 
 TSubclassOf<ARunePreviewAgent> ARuneTangibleAgent::GetPreviewAgentClass() const
@@ -4,6 +4,8 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "UObject/ObjectKey.h"
+#include "Utils/RuneTypes.h"
 #include "RuneTangibleAgent.generated.h"
 
 
@@ -36,10 +38,79 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	// Called when the agent is destroyed or removed from the world
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Called when the lifespan is over, returns the agent to its pool if poolable
+	virtual void LifeSpanExpired() override;
+
 public:
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
 
+	// Adds the memory of the attached effects and their contexts
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+
+	/**
+	 * Destroys the agent or, if poolable, returns it to its pool.
+	 * Poolable agents should always be released instead of destroyed.
+	 */
+	UFUNCTION(BlueprintCallable)
+	void ReleaseAgent();
+
+	/**
+	 * Whether or not the agent is inactive, waiting in its pool.
+	 *
+	 * @return If true, the agent is pooled
+	 */
+	UFUNCTION(BlueprintCallable)
+	bool IsInPool() const;
+
+protected:
+	/**
+	 * Restores the agent state so that it can be reused.
+	 * Called when the agent is returned to its pool, after it has been hidden.
+	 */
+	virtual void ResetAgent();
+
+	/**
+	 * Prepares a reused agent, equivalent to BeginPlay() for spawned agents.
+	 * Called when the agent is taken from its pool, after it has been shown.
+	 */
+	virtual void ActivateAgent();
+
+	/**
+	 * Blueprint version of ResetAgent() method.
+	 */
+	UFUNCTION(BlueprintImplementableEvent, meta = (DisplayName = "Reset Agent"))
+	void ReceiveResetAgent();
+
+	/**
+	 * Blueprint version of ActivateAgent() method.
+	 */
+	UFUNCTION(BlueprintImplementableEvent, meta = (DisplayName = "Activate Agent"))
+	void ReceiveActivateAgent();
+
+private:
+	/**
+	 * Hides the agent, disables its ticking and collisions, and resets it.
+	 */
+	void DeactivateAgent();
+
+	/**
+	 * Places and shows the agent, restores its ticking and collisions, and activates it.
+	 *
+	 * @param transform Transform of the reused agent.
+	 */
+	void ReactivateAgent(const FTransform& transform);
+
+	/**
+	 * Removes the bindings of objects other than the agent and its subobjects (e.g. its components).
+	 *
+	 * @param delegate Delegate of the agent
+	 */
+	void RemoveExternalBindings(FAgentApplicationDelegate& delegate) const;
+
 protected:
 	/**
 	 * Iterates trhough all attached effects and tries to apply each one to
@@ -75,13 +146,61 @@ protected:
 	bool CheckForApplicableEffects(AActor* actor);
 
 	/**
-	 * Creates a copy of the given rune effects.
+	 * Batch version of TryApplyEffects(). Each effect filters all the
+	 * actors at once, which is the preferred way for area of effect agents.
+	 * onApplyEffects is invoked once per (non null) actor.
 	 *
-	 * @param runeEffects Rune effects that should be copied.
+	 * @param actors Actors to which the effects should be applied
+	 * @return Number of actors that got at least one effect applied
+	 */
+	UFUNCTION(BlueprintCallable)
+	int32 TryApplyEffectsBatch(const TArray<AActor*>& actors);
+
+	/**
+	 * Batch version of CheckForApplicableEffects().
+	 *
+	 * @param actors Actors to which the effects could be applied
+	 * @param outApplicableActors Actors to which any of the effects could be successfully applied
+	 * @return If any of the effects could be successfully applied to any actor
+	 */
+	UFUNCTION(BlueprintCallable)
+	bool CheckForApplicableEffectsBatch(const TArray<AActor*>& actors, TArray<AActor*>& outApplicableActors);
+
+	/**
+	 * Attaches the given rune effects.
+	 * Effects are copied, so that each agent owns its own instances: they outlive
+	 * the caster, their owner is the agent and their state is not shared.
+	 * Their runtime context (instigator, instigator filter and causer) is captured at attachment time.
+	 *
+	 * @param runeEffects Rune effects that should be attached.
 	 */
 	UFUNCTION(BlueprintCallable)
 	void SetAttachedRuneEffects(TArray<class UObject*> runeEffects);
 
+	/**
+	 * Native version of SetAttachedRuneEffects().
+	 *
+	 * @param runeEffects Rune effects that should be attached.
+	 */
+	void AttachRuneEffects(TConstArrayView<class URuneEffect*> runeEffects);
+
+	/**
+	 * Detaches all the attached rune effects.
+	 */
+	UFUNCTION(BlueprintCallable)
+	void ClearAttachedRuneEffects();
+
+private:
+	/**
+	 * Attaches a single rune effect, capturing its runtime context.
+	 * The agent uses the world's shared copy of the effect (see FRuneSharedEffects), so that it outlives the caster.
+	 *
+	 * @param runeEffect Rune effect that should be attached.
+	 */
+	void AttachRuneEffect(class URuneEffect& runeEffect);
+
+protected:
+
 	/**
 	 * Gets the assigned preview agent class.
 	 * Could be nullptr if not set or invalid.
@@ -105,14 +224,46 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "RuneTangibleAgent: General Settings")
 	float duration;
 
+	/**
+	 * Whether agents of this class are reused through the world's URuneAgentPool.
+	 * Poolable agents should restore their state on ResetAgent/ActivateAgent.
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "RuneTangibleAgent: General Settings")
+	bool isPoolable;
+
 	/** Actor class used to preview the agent. */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "RuneTangibleAgent: General Settings")
 	TSubclassOf<class ARunePreviewAgent> previewAgentClass;
 
-	/** Rune effects attached to the tangible agent */
+	/** Shared copies of the rune effects attached to the tangible agent, read-only unless stateful */
 	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category = "RuneTangibleAgent: Debug Variables")
 	TArray<class URuneEffect*> attachedRuneEffects;
 
+	/** Runtime context of each attached rune effect */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category = "RuneTangibleAgent: Debug Variables")
+	TArray<FRuneEffectContext> attachedEffectContexts;
+
 private:
 	friend class URuneUtils;
+	friend class URuneAgentPool;
+	friend class FRuneMemoryReport;
+
+	/** Hash of the template properties the agent was initialized with, part of its pool key */
+	uint32 templateHash;
+
+	/** Whether the agent is waiting in its pool */
+	bool isInPool;
+
+	/** Collision state before being pooled */
+	bool wasCollisionEnabled;
+
+	/** Whether the actor ticked before being pooled */
+	bool wasTickEnabled;
+
+	/** Components that ticked before being pooled */
+	UPROPERTY()
+	TArray<UActorComponent*> pausedComponents;
+
+	/** Source effect of each attached rune effect, used to release its copy */
+	TArray<TObjectKey<class URuneEffect>> attachedSourceEffects;
 };
@@ -0,0 +1,199 @@
+
+
+#include "RuneTickSubsystem.h"
+#include "RuneBaseComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+
+
+static TAutoConsoleVariable<bool> CVarRuneTickManagerEnabled(
+	TEXT("rune.TickManager.Enabled"),
+	true,
+	TEXT("Whether runes are ticked in a single batched loop instead of each one registering its own tick function. Read when runes begin play."));
+
+static TAutoConsoleVariable<bool> CVarRuneTickManagerAllowSleep(
+	TEXT("rune.TickManager.AllowSleep"),
+	true,
+	TEXT("Whether runes stop ticking while their cast state machines do not need to tick, until they are woken up."));
+
+static TAutoConsoleVariable<float> CVarRuneTickManagerLODDistance(
+	TEXT("rune.TickManager.LODDistance"),
+	0.0f,
+	TEXT("Distance to the closest local player beyond which runes tick at rune.TickManager.LODInterval. 0 disables tick LOD."));
+
+static TAutoConsoleVariable<float> CVarRuneTickManagerLODInterval(
+	TEXT("rune.TickManager.LODInterval"),
+	0.1f,
+	TEXT("Minimum time - in seconds - between ticks of runes beyond rune.TickManager.LODDistance."));
+
+
+URuneTickSubsystem::URuneTickSubsystem() :
+	runes(),
+	accumulatedTimes(),
+	viewLocations(),
+	pendingRemovals(0),
+	isTicking(false)
+{
+}
+
+bool URuneTickSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void URuneTickSubsystem::Deinitialize()
+{
+	for (URuneBaseComponent* rune : runes)
+	{
+		if (rune != nullptr)
+		{
+			rune->tickIndex = INDEX_NONE;
+		}
+	}
+	runes.Empty();
+	accumulatedTimes.Empty();
+	viewLocations.Empty();
+	pendingRemovals = 0;
+
+	Super::Deinitialize();
+}
+
+void URuneTickSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	GatherViewLocations();
+
+	// runes registered while ticking will tick from the next tick on
+	isTicking = true;
+	const int32 num = runes.Num();
+	for (int32 i = 0; i < num; ++i)
+	{
+		URuneBaseComponent* rune = runes[i];
+		if (!IsValid(rune)) continue;
+
+		// dilated like the tick function of the rune would be
+		const AActor* owner = rune->GetOwner();
+		accumulatedTimes[i] += owner != nullptr ? DeltaTime * owner->CustomTimeDilation : DeltaTime;
+		if (accumulatedTimes[i] < GetTickInterval(*rune)) continue;
+
+		const float runeDeltaTime = accumulatedTimes[i];
+		accumulatedTimes[i] = 0.0f;
+
+		if (rune->skipTickWhenIdle && rune->IsIdle()) continue;
+
+		rune->TickRune(runeDeltaTime);
+	}
+	isTicking = false;
+
+	Compact();
+}
+
+TStatId URuneTickSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(URuneTickSubsystem, STATGROUP_Tickables);
+}
+
+bool URuneTickSubsystem::RegisterRune(URuneBaseComponent& rune)
+{
+	if (rune.tickIndex != INDEX_NONE) return false;
+
+	rune.tickIndex = runes.Add(&rune);
+	accumulatedTimes.Add(0.0f);
+
+	return true;
+}
+
+void URuneTickSubsystem::UnregisterRune(URuneBaseComponent& rune)
+{
+	const int32 index = rune.tickIndex;
+	if (!runes.IsValidIndex(index) || runes[index] != &rune) return;
+
+	rune.tickIndex = INDEX_NONE;
+	runes[index] = nullptr;
+	++pendingRemovals;
+
+	if (!isTicking)
+	{
+		Compact();
+	}
+}
+
+int32 URuneTickSubsystem::GetNumRegisteredRunes() const
+{
+	return runes.Num() - pendingRemovals;
+}
+
+bool URuneTickSubsystem::IsEnabled()
+{
+	return CVarRuneTickManagerEnabled.GetValueOnGameThread();
+}
+
+bool URuneTickSubsystem::IsSleepAllowed()
+{
+	return CVarRuneTickManagerAllowSleep.GetValueOnGameThread();
+}
+
+void URuneTickSubsystem::GatherViewLocations()
+{
+	viewLocations.Reset();
+	if (CVarRuneTickManagerLODDistance.GetValueOnGameThread() <= 0.0f) return;
+
+	for (FConstPlayerControllerIterator it = GetWorld()->GetPlayerControllerIterator(); it; ++it)
+	{
+		const APlayerController* controller = it->Get();
+		if (controller == nullptr || !controller->IsLocalController()) continue;
+
+		FVector location;
+		FRotator rotation;
+		controller->GetPlayerViewPoint(location, rotation);
+		viewLocations.Add(location);
+	}
+}
+
+float URuneTickSubsystem::GetTickInterval(const URuneBaseComponent& rune) const
+{
+	const float lodDistance = CVarRuneTickManagerLODDistance.GetValueOnGameThread();
+	const AActor* owner = rune.GetOwner();
+	if (lodDistance <= 0.0f || viewLocations.Num() <= 0 || owner == nullptr)
+	{
+		return rune.tickInterval;
+	}
+
+	const FVector location = owner->GetActorLocation();
+	const float lodDistanceSquared = lodDistance * lodDistance;
+	for (const FVector& viewLocation : viewLocations)
+	{
+		if (FVector::DistSquared(location, viewLocation) <= lodDistanceSquared)
+		{
+			return rune.tickInterval;
+		}
+	}
+
+	return FMath::Max(rune.tickInterval, CVarRuneTickManagerLODInterval.GetValueOnGameThread());
+}
+
+void URuneTickSubsystem::Compact()
+{
+	if (pendingRemovals == 0)
+	{
+		return;
+	}
+
+	for (int32 i = runes.Num() - 1; i >= 0; --i)
+	{
+		if (runes[i] != nullptr) continue;
+
+		runes.RemoveAtSwap(i, 1, false);
+		accumulatedTimes.RemoveAtSwap(i, 1, false);
+
+		// the swapped rune has moved into the removed slot
+		if (runes.IsValidIndex(i) && runes[i] != nullptr)
+		{
+			runes[i]->tickIndex = i;
+		}
+	}
+	pendingRemovals = 0;
+}
@@ -0,0 +1,108 @@
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "RuneTickSubsystem.generated.h"
+
+
+class URuneBaseComponent;
+
+/**
+ * Ticks every rune of its world in a single batched loop,
+ * instead of each URuneBaseComponent registering its own tick function.
+ *
+ * Runes are kept in a dense array and can tick at their own interval,
+ * which is raised for runes far away from every local player (LOD).
+ * Runes can also opt in to skip their tick while idle (URuneBaseComponent::IsIdle()).
+ * Runes whose state machines do not need to tick (URuneCastStateMachine::NeedsTick())
+ * leave the array until they are woken up, and deactivated runes until they are activated again.
+ * Each rune gets the delta time dilated by the CustomTimeDilation of its owner.
+ */
+UCLASS()
+class RUNESYSTEM_API URuneTickSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this subsystem's properties
+	URuneTickSubsystem();
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Deinitialize() override;
+
+	// Called every frame
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+public:
+	/**
+	 * Starts ticking a rune. Its own tick function should be disabled by the caller.
+	 *
+	 * @param rune Registered rune
+	 * @return If true, the rune has been registered
+	 */
+	bool RegisterRune(URuneBaseComponent& rune);
+
+	/**
+	 * Stops ticking a rune.
+	 *
+	 * @param rune Unregistered rune
+	 */
+	void UnregisterRune(URuneBaseComponent& rune);
+
+	/**
+	 * Gets the number of registered runes, not counting sleeping ones.
+	 *
+	 * @return Registered runes
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Rune System|Tick")
+	int32 GetNumRegisteredRunes() const;
+
+	/**
+	 * Whether or not runes should be ticked by the subsystem, read when they begin play.
+	 *
+	 * @return If true, runes register into the subsystem
+	 */
+	static bool IsEnabled();
+
+	/**
+	 * Whether or not runes can stop ticking while their state machines do not need to tick.
+	 *
+	 * @return If true, runes can sleep
+	 */
+	static bool IsSleepAllowed();
+
+private:
+	/** Gets the view locations of every local player */
+	void GatherViewLocations();
+
+	/**
+	 * Gets the tick interval of a rune, taking its distance to the local players into account.
+	 *
+	 * @param rune Ticked rune
+	 * @return Time - in seconds - between ticks of the rune
+	 */
+	float GetTickInterval(const URuneBaseComponent& rune) const;
+
+	/** Removes all unregistered runes */
+	void Compact();
+
+private:
+	/** Registered runes. Null once unregistered */
+	UPROPERTY()
+	TArray<TObjectPtr<URuneBaseComponent>> runes;
+
+	/** Time - in seconds - accumulated since each rune last ticked */
+	TArray<float> accumulatedTimes;
+
+	/** View locations of the local players, refreshed every tick */
+	TArray<FVector> viewLocations;
+
+	/** Number of runes unregistered while ticking */
+	int32 pendingRemovals;
+
+	/** Whether runes are being ticked */
+	bool isTicking;
+};
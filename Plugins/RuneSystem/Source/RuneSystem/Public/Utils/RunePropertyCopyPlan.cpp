@@ -0,0 +1,163 @@
+
+
+#include "RunePropertyCopyPlan.h"
+#include "UObject/UnrealType.h"
+#include "UObject/UObjectGlobals.h"
+
+
+FRunePropertyCopyPlan::~FRunePropertyCopyPlan()
+{
+	Reset();
+}
+
+void FRunePropertyCopyPlan::AddImportedValue(const FProperty& property, const FString& text)
+{
+	FEntry& entry = entries.AddDefaulted_GetRef();
+	entry.property = &property;
+	entry.text = text;
+
+	// parse into a temporary value, kept if it is not an object reference
+	// zeroed first, initializing a value may not write all its bytes (e.g. bitfield bools)
+	void* value = FMemory::MallocZeroed(property.GetSize(), property.GetMinAlignment());
+	property.InitializeValue(value);
+	if (property.ImportText_Direct(*text, value, nullptr, PPF_None) == nullptr)
+	{
+		property.DestroyValue(value);
+		FMemory::Free(value);
+		return;
+	}
+
+	if (const FObjectPropertyBase* objectProperty = CastField<FObjectPropertyBase>(&property))
+	{
+		if (property.ArrayDim == 1)
+		{
+			entry.type = EEntryType::OBJECT;
+			entry.object = objectProperty->GetObjectPropertyValue(value);
+		}
+		property.DestroyValue(value);
+		FMemory::Free(value);
+		return;
+	}
+
+	// containers and structs holding objects are imported every time, so they are referenced by their owner
+	TArray<const FStructProperty*> encounteredStructProps;
+	if (property.ContainsObjectReference(encounteredStructProps))
+	{
+		property.DestroyValue(value);
+		FMemory::Free(value);
+		return;
+	}
+
+	entry.type = IsMemoryCopyable(property) ? EEntryType::RAW : EEntryType::VALUE;
+	entry.value = value;
+}
+
+void FRunePropertyCopyPlan::AddCopiedValue(const FProperty& sourceProperty, const FProperty& property)
+{
+	FEntry& entry = entries.AddDefaulted_GetRef();
+	entry.property = &property;
+	entry.sourceProperty = &sourceProperty;
+
+	if (!sourceProperty.SameType(&property) || sourceProperty.ArrayDim != property.ArrayDim)
+	{
+		entry.type = EEntryType::COPY_TEXT;
+		return;
+	}
+
+	// bools are read and written through their own bit, which may differ between both classes
+	if (property.IsA<FBoolProperty>() && property.ArrayDim == 1)
+	{
+		entry.type = EEntryType::COPY_BOOL;
+		return;
+	}
+
+	entry.type = IsMemoryCopyable(property) ? EEntryType::COPY_RAW : EEntryType::COPY_VALUE;
+}
+
+void FRunePropertyCopyPlan::Apply(UObject& object, const UObject* source) const
+{
+	for (const FEntry& entry : entries)
+	{
+		void* dest = entry.property->ContainerPtrToValuePtr<void>(&object);
+		switch (entry.type)
+		{
+		case EEntryType::RAW:
+			FMemory::Memcpy(dest, entry.value, entry.property->GetSize());
+			break;
+		case EEntryType::VALUE:
+			entry.property->CopyCompleteValue(dest, entry.value);
+			break;
+		case EEntryType::OBJECT:
+			if (UObject* referenced = entry.object.Get())
+			{
+				CastFieldChecked<const FObjectPropertyBase>(entry.property)->SetObjectPropertyValue(dest, referenced);
+			}
+			else
+			{
+				// unloaded or None, import it as it used to be
+				entry.property->ImportText_Direct(*entry.text, dest, &object, PPF_None);
+			}
+			break;
+		case EEntryType::COPY_RAW:
+			if (source == nullptr) break;
+			FMemory::Memcpy(dest, entry.sourceProperty->ContainerPtrToValuePtr<void>(source), entry.property->GetSize());
+			break;
+		case EEntryType::COPY_BOOL:
+			if (source == nullptr) break;
+			CastFieldChecked<const FBoolProperty>(entry.property)->SetPropertyValue(dest,
+				CastFieldChecked<const FBoolProperty>(entry.sourceProperty)->GetPropertyValue(entry.sourceProperty->ContainerPtrToValuePtr<void>(source)));
+			break;
+		case EEntryType::COPY_VALUE:
+			if (source == nullptr) break;
+			entry.property->CopyCompleteValue(dest, entry.sourceProperty->ContainerPtrToValuePtr<void>(source));
+			break;
+		case EEntryType::COPY_TEXT:
+		{
+			if (source == nullptr) break;
+			FString serializedData;
+			entry.sourceProperty->ExportText_InContainer(0, serializedData, source, source, entry.sourceProperty->GetOwnerUObject(), PPF_None);
+			entry.property->ImportText_Direct(*serializedData, dest, &object, PPF_None);
+			break;
+		}
+		default:
+			entry.property->ImportText_Direct(*entry.text, dest, &object, PPF_None);
+			break;
+		}
+	}
+}
+
+void FRunePropertyCopyPlan::Reset()
+{
+	for (FEntry& entry : entries)
+	{
+		FreeValue(entry);
+	}
+	entries.Reset();
+}
+
+bool FRunePropertyCopyPlan::IsMemoryCopyable(const FProperty& property)
+{
+	// bitfield bools share their byte with sibling bits, copying the byte would overwrite them
+	return property.HasAnyPropertyFlags(CPF_IsPlainOldData) && !property.IsA<FBoolProperty>();
+}
+
+void FRunePropertyCopyPlan::FreeValue(FEntry& entry)
+{
+	if (entry.value == nullptr) return;
+
+	entry.property->DestroyValue(entry.value);
+	FMemory::Free(entry.value);
+	entry.value = nullptr;
+}
+
+uint32 FRunePropertyCopyPlan::GetClassLayoutEpoch()
+{
+#if WITH_EDITOR
+	static uint32 classLayoutEpoch = 0;
+	static const FDelegateHandle reinstancedHandle = FCoreUObjectDelegates::OnObjectsReinstanced.AddLambda(
+		[](const TMap<UObject*, UObject*>&) { ++classLayoutEpoch; });
+	return classLayoutEpoch;
+#else
+	return 0;
+#endif
+}
@@ -0,0 +1,119 @@
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+/**
+ * Precompiled list of property values written into objects.
+ * 
+ * Properties are resolved once and their values are parsed once (or read
+ * from a source object), then applied with direct memory copies (plain old data)
+ * or property copies (e.g. strings), instead of finding, exporting and importing
+ * them from text on every application.
+ * Object references are kept as weak pointers so the plan never keeps nor
+ * dangles objects.
+ */
+class RUNESYSTEM_API FRunePropertyCopyPlan
+{
+public:
+	FRunePropertyCopyPlan() = default;
+	~FRunePropertyCopyPlan();
+
+	FRunePropertyCopyPlan(const FRunePropertyCopyPlan&) = delete;
+	FRunePropertyCopyPlan& operator=(const FRunePropertyCopyPlan&) = delete;
+
+	/**
+	 * Adds a value imported from text. The text is parsed right away,
+	 * if it can not be parsed it will be imported on every application.
+	 *
+	 * @param property Property written by the plan
+	 * @param text Exported text of the value
+	 */
+	void AddImportedValue(const FProperty& property, const FString& text);
+
+	/**
+	 * Adds a value copied from a source object on every application.
+	 * Binary copied if both properties have the same type, exported and imported otherwise.
+	 *
+	 * @param sourceProperty Property read from the source object
+	 * @param property Property written by the plan
+	 */
+	void AddCopiedValue(const FProperty& sourceProperty, const FProperty& property);
+
+	/**
+	 * Writes all the values into an object.
+	 *
+	 * @param object Object whose class owns the plan properties
+	 * @param source Object whose class owns the source properties. Needed if there are copied values.
+	 */
+	void Apply(UObject& object, const UObject* source = nullptr) const;
+
+	/** Removes every value */
+	void Reset();
+
+	/** Number of values */
+	int32 Num() const { return entries.Num(); }
+
+	/**
+	 * Gets a counter increased whenever classes are reinstanced (e.g. blueprint compilation),
+	 * invalidating the resolved properties of every plan. Always 0 outside the editor.
+	 *
+	 * @return Class layout epoch
+	 */
+	static uint32 GetClassLayoutEpoch();
+
+private:
+	/** How a value is applied */
+	enum class EEntryType : uint8
+	{
+		// memory copy of a plain old data value, bools excluded
+		RAW,
+		// property copy of a non plain old data value
+		VALUE,
+		// object reference
+		OBJECT,
+		// text import, used when parsing failed
+		TEXT,
+		// memory copy of a plain old data value from the source, bools excluded
+		COPY_RAW,
+		// bool copy from the source, bit by bit
+		COPY_BOOL,
+		// property copy of a non plain old data value from the source
+		COPY_VALUE,
+		// text export from the source and import, used with different types
+		COPY_TEXT,
+	};
+
+	struct FEntry
+	{
+		const FProperty* property = nullptr;
+		EEntryType type = EEntryType::TEXT;
+
+		/** Property read from the source (COPY_*) */
+		const FProperty* sourceProperty = nullptr;
+
+		/** Parsed value (RAW and VALUE) */
+		void* value = nullptr;
+
+		/** Referenced object (OBJECT) */
+		TWeakObjectPtr<UObject> object;
+
+		/** Source text, also used when an object reference is no longer valid */
+		FString text;
+	};
+
+	/**
+	 * Whether a value can be applied with a memory copy.
+	 *
+	 * @param property Property of the value
+	 * @return If true, the value is plain old data and does not share its memory
+	 */
+	static bool IsMemoryCopyable(const FProperty& property);
+
+	/** Frees the parsed value of an entry */
+	static void FreeValue(FEntry& entry);
+
+	TArray<FEntry> entries;
+};
@@ -0,0 +1,79 @@
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StaticArray.h"
+
+
+/**
+ * Fixed-capacity FIFO queue stored inline, so pushing and popping never allocate.
+ * When full, pushing overwrites the oldest element.
+ *
+ * @tparam T Element type, trivially copyable values (e.g. pointers)
+ * @tparam Capacity Maximum number of elements, must be a power of two
+ */
+template<typename T, uint32 Capacity>
+class TRuneRingBuffer
+{
+	static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+	TRuneRingBuffer() : elements(), head(0), count(0) {}
+
+	/**
+	 * Adds an element at the end of the queue.
+	 *
+	 * @param element Added element
+	 * @return If false, the queue was full and its oldest element has been dropped
+	 */
+	bool Push(const T& element)
+	{
+		const bool isFull = count == Capacity;
+		if (isFull)
+		{
+			head = (head + 1) & (Capacity - 1);
+			--count;
+		}
+
+		elements[(head + count) & (Capacity - 1)] = element;
+		++count;
+
+		return !isFull;
+	}
+
+	/**
+	 * Removes the element at the front of the queue.
+	 *
+	 * @param outElement Removed element
+	 * @return If false, the queue was empty
+	 */
+	bool Pop(T& outElement)
+	{
+		if (count == 0) return false;
+
+		outElement = elements[head];
+		head = (head + 1) & (Capacity - 1);
+		--count;
+
+		return true;
+	}
+
+	/** Removes every element */
+	void Reset()
+	{
+		head = 0;
+		count = 0;
+	}
+
+	bool IsEmpty() const { return count == 0; }
+
+	uint32 Num() const { return count; }
+
+	static constexpr uint32 Max() { return Capacity; }
+
+private:
+	TStaticArray<T, Capacity> elements;
+	uint32 head;
+	uint32 count;
+};
@@ -0,0 +1,63 @@
+
+
+#include "RuneStats.h"
+
+
+LLM_DEFINE_TAG(RuneSystem);
+
+DEFINE_STAT(STAT_RunePendingTransitionsDropped);
+
+DEFINE_STAT(STAT_RuneTick);
+DEFINE_STAT(STAT_RuneCastStateMachineTick);
+DEFINE_STAT(STAT_RunePerformTransition);
+DEFINE_STAT(STAT_RuneBroadcastApplyPulse);
+DEFINE_STAT(STAT_RuneEffectApply);
+DEFINE_STAT(STAT_RuneFilter);
+DEFINE_STAT(STAT_RuneSpawnTangibleAgent);
+DEFINE_STAT(STAT_RuneSpawnPreviewAgent);
+DEFINE_STAT(STAT_RuneEoTTick);
+DEFINE_STAT(STAT_RuneStatusTick);
+
+DEFINE_STAT(STAT_RunePulses);
+DEFINE_STAT(STAT_RuneEffectsApplied);
+DEFINE_STAT(STAT_RuneFilterRejections);
+DEFINE_STAT(STAT_RuneAgentsAlive);
+
+#if RUNE_STATS
+UE_TRACE_CHANNEL_DEFINE(RuneSystemChannel);
+#endif
+
+bool FRuneProfiler::isEnabled = false;
+uint64 FRuneProfiler::cycles[FRuneProfiler::NumPhases] = {};
+uint32 FRuneProfiler::calls[FRuneProfiler::NumPhases] = {};
+
+void FRuneProfiler::AddSample(ERuneProfilePhase phase, uint64 sampleCycles)
+{
+	const int32 index = static_cast<int32>(phase);
+	cycles[index] += sampleCycles;
+	++calls[index];
+}
+
+const TCHAR* FRuneProfiler::GetPhaseName(ERuneProfilePhase phase)
+{
+	switch (phase)
+	{
+	case ERuneProfilePhase::RUNE_TICK:					return TEXT("RuneTick");
+	case ERuneProfilePhase::CAST_STATE_MACHINE_TICK:	return TEXT("CastStateMachineTick");
+	case ERuneProfilePhase::PERFORM_TRANSITION:			return TEXT("PerformTransition");
+	case ERuneProfilePhase::APPLY_PULSE:				return TEXT("ApplyPulse");
+	case ERuneProfilePhase::EFFECT_APPLY:				return TEXT("EffectApply");
+	case ERuneProfilePhase::FILTER:						return TEXT("Filter");
+	case ERuneProfilePhase::SPAWN_TANGIBLE_AGENT:		return TEXT("SpawnTangibleAgent");
+	case ERuneProfilePhase::SPAWN_PREVIEW_AGENT:		return TEXT("SpawnPreviewAgent");
+	case ERuneProfilePhase::EOT_TICK:					return TEXT("EoTTick");
+	case ERuneProfilePhase::STATUS_TICK:				return TEXT("StatusTick");
+	default:											return TEXT("Unknown");
+	}
+}
+
+void FRuneProfiler::Reset()
+{
+	FMemory::Memzero(cycles);
+	FMemory::Memzero(calls);
+}
@@ -0,0 +1,144 @@
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "HAL/LowLevelMemTracker.h"
+
+// stats and trace scopes of the rune system, compiled out in shipping builds
+#ifndef RUNE_STATS
+#define RUNE_STATS !UE_BUILD_SHIPPING
+#endif
+
+
+DECLARE_STATS_GROUP(TEXT("RuneSystem"), STATGROUP_RuneSystem, STATCAT_Advanced);
+
+/** Low level memory tag of the rune objects and applications created at runtime, used with LLM_SCOPE_BYTAG(RuneSystem) */
+LLM_DECLARE_TAG_API(RuneSystem, RUNESYSTEM_API);
+
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Pending Transitions Dropped"), STAT_RunePendingTransitionsDropped, STATGROUP_RuneSystem, RUNESYSTEM_API);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Rune Tick"), STAT_RuneTick, STATGROUP_RuneSystem, RUNESYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Cast State Machine Tick"), STAT_RuneCastStateMachineTick, STATGROUP_RuneSystem, RUNESYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Perform Transition"), STAT_RunePerformTransition, STATGROUP_RuneSystem, RUNESYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Broadcast Apply Pulse"), STAT_RuneBroadcastApplyPulse, STATGROUP_RuneSystem, RUNESYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Effect Apply"), STAT_RuneEffectApply, STATGROUP_RuneSystem, RUNESYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Filter"), STAT_RuneFilter, STATGROUP_RuneSystem, RUNESYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Spawn Tangible Agent"), STAT_RuneSpawnTangibleAgent, STATGROUP_RuneSystem, RUNESYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Spawn Preview Agent"), STAT_RuneSpawnPreviewAgent, STATGROUP_RuneSystem, RUNESYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("EoT Tick"), STAT_RuneEoTTick, STATGROUP_RuneSystem, RUNESYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Status Tick"), STAT_RuneStatusTick, STATGROUP_RuneSystem, RUNESYSTEM_API);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Pulses"), STAT_RunePulses, STATGROUP_RuneSystem, RUNESYSTEM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Effects Applied"), STAT_RuneEffectsApplied, STATGROUP_RuneSystem, RUNESYSTEM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Filter Rejections"), STAT_RuneFilterRejections, STATGROUP_RuneSystem, RUNESYSTEM_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Agents Alive"), STAT_RuneAgentsAlive, STATGROUP_RuneSystem, RUNESYSTEM_API);
+
+/** Phases of the rune pipeline timed by FRuneProfiler. Nested phases are included in their parent's time */
+enum class ERuneProfilePhase : uint8
+{
+	RUNE_TICK = 0,
+	CAST_STATE_MACHINE_TICK,
+	PERFORM_TRANSITION,
+	APPLY_PULSE,
+	EFFECT_APPLY,
+	FILTER,
+	SPAWN_TANGIBLE_AGENT,
+	SPAWN_PREVIEW_AGENT,
+	EOT_TICK,
+	STATUS_TICK,
+
+	NUM
+};
+
+/**
+ * Accumulates the time spent in each phase of the rune pipeline, and how many times each one ran.
+ * Unlike stats, the totals can be read back by code, i.e. by benchmarks.
+ * Disabled by default, and only fed from the game thread.
+ */
+class RUNESYSTEM_API FRuneProfiler
+{
+public:
+	static constexpr int32 NumPhases = static_cast<int32>(ERuneProfilePhase::NUM);
+
+	/**
+	 * Starts or stops accumulating. Totals are kept until reset.
+	 *
+	 * @param enabled Whether phases should be timed
+	 */
+	static void SetEnabled(bool enabled) { isEnabled = enabled; };
+
+	static bool IsEnabled() { return isEnabled; };
+
+	/**
+	 * Adds a run of a phase.
+	 *
+	 * @param phase Timed phase
+	 * @param cycles Duration of the run, in FPlatformTime cycles
+	 */
+	static void AddSample(ERuneProfilePhase phase, uint64 cycles);
+
+	/** Total cycles spent in a phase since the last reset */
+	static uint64 GetCycles(ERuneProfilePhase phase) { return cycles[static_cast<int32>(phase)]; };
+
+	/** Number of runs of a phase since the last reset */
+	static uint32 GetCalls(ERuneProfilePhase phase) { return calls[static_cast<int32>(phase)]; };
+
+	/** Display name of a phase */
+	static const TCHAR* GetPhaseName(ERuneProfilePhase phase);
+
+	/** Clears the totals of every phase */
+	static void Reset();
+
+private:
+	static bool isEnabled;
+	static uint64 cycles[NumPhases];
+	static uint32 calls[NumPhases];
+};
+
+/** Times a phase for FRuneProfiler until going out of scope */
+class FRuneScopedProfilePhase
+{
+public:
+	explicit FRuneScopedProfilePhase(ERuneProfilePhase inPhase) :
+		phase(inPhase),
+		startCycles(FRuneProfiler::IsEnabled() ? FPlatformTime::Cycles64() : 0)
+	{
+	}
+
+	~FRuneScopedProfilePhase()
+	{
+		if (startCycles != 0)
+		{
+			FRuneProfiler::AddSample(phase, FPlatformTime::Cycles64() - startCycles);
+		}
+	}
+
+private:
+	ERuneProfilePhase phase;
+	uint64 startCycles;
+};
+
+#if RUNE_STATS
+UE_TRACE_CHANNEL_EXTERN(RuneSystemChannel, RUNESYSTEM_API);
+
+/** Scopes a cycle stat of STATGROUP_RuneSystem, also traced as a CPU event on RuneSystemChannel */
+#define RUNE_SCOPE_CYCLE_COUNTER(Stat, EventName) \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR(EventName, RuneSystemChannel); \
+	SCOPE_CYCLE_COUNTER(Stat)
+
+/** Times a phase for FRuneProfiler, see ERuneProfilePhase */
+#define RUNE_SCOPE_PROFILE_PHASE(Phase) FRuneScopedProfilePhase ANONYMOUS_VARIABLE(RuneProfilePhase_)(ERuneProfilePhase::Phase)
+
+#define RUNE_INC_COUNTER(Stat) INC_DWORD_STAT(Stat)
+#define RUNE_INC_COUNTER_BY(Stat, Amount) INC_DWORD_STAT_BY(Stat, Amount)
+#define RUNE_DEC_COUNTER(Stat) DEC_DWORD_STAT(Stat)
+#else
+#define RUNE_SCOPE_CYCLE_COUNTER(Stat, EventName)
+#define RUNE_SCOPE_PROFILE_PHASE(Phase)
+#define RUNE_INC_COUNTER(Stat)
+#define RUNE_INC_COUNTER_BY(Stat, Amount)
+#define RUNE_DEC_COUNTER(Stat)
+#endif
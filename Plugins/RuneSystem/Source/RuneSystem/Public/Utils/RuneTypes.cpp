@@ -1,8 +1,90 @@
 #include "RuneTypes.h"
 #include "RuneTangibleAgent.h"
+#include "RunePreviewAgent.h"
+#include "RunePropertyCopyPlan.h"
 
 
 UClass* URuneBlueprintFunctionLibrary::Conv_RuneTangibleAgentTemplateToClass(const FRuneTangibleAgentTemplate& inTemplate)
 {
 	return inTemplate.agentClass;
 }
+
+void FRuneTangibleAgentTemplate::ApplyProperties(ARuneTangibleAgent& agent) const
+{
+	ValidatePropertyPlans();
+	propertyPlan->Apply(agent);
+}
+
+void FRuneTangibleAgentTemplate::ApplyPreviewProperties(ARunePreviewAgent& previewAgent) const
+{
+	ValidatePropertyPlans();
+	if (!previewPropertyPlan.IsValid() || previewPropertyPlanClass.Get() != previewAgent.GetClass())
+	{
+		previewPropertyPlan = CompilePropertyPlan(previewAgent.GetClass());
+		previewPropertyPlanClass = previewAgent.GetClass();
+	}
+	previewPropertyPlan->Apply(previewAgent);
+}
+
+uint32 FRuneTangibleAgentTemplate::GetPropertiesHash() const
+{
+	ValidatePropertyPlans();
+	return propertiesHash;
+}
+
+void FRuneTangibleAgentTemplate::InvalidatePropertyPlan()
+{
+	propertyPlan.Reset();
+	propertyPlanClass.Reset();
+	previewPropertyPlan.Reset();
+	previewPropertyPlanClass.Reset();
+	propertiesHash = 0;
+}
+
+void FRuneTangibleAgentTemplate::ValidatePropertyPlans() const
+{
+	// map iteration order depends on insertion order, so hash is order independent
+	auto computeHash = [this]()
+	{
+		uint32 hash = 0;
+		for (const TPair<FName, FString>& propPair : properties)
+		{
+			hash ^= HashCombine(GetTypeHash(propPair.Key), GetTypeHash(propPair.Value));
+		}
+		return hash;
+	};
+
+	bool isOutdated = !propertyPlan.IsValid() || propertyPlanClass.Get() != agentClass.Get();
+#if WITH_EDITOR
+	// properties could have been modified without invalidating (e.g. undo), or classes recompiled
+	isOutdated |= propertiesHash != computeHash();
+	isOutdated |= classLayoutEpoch != FRunePropertyCopyPlan::GetClassLayoutEpoch();
+#endif
+	if (!isOutdated) return;
+
+	propertyPlan = CompilePropertyPlan(agentClass);
+	propertyPlanClass = agentClass.Get();
+	previewPropertyPlan.Reset();
+	previewPropertyPlanClass.Reset();
+	propertiesHash = computeHash();
+	classLayoutEpoch = FRunePropertyCopyPlan::GetClassLayoutEpoch();
+}
+
+TSharedPtr<FRunePropertyCopyPlan> FRuneTangibleAgentTemplate::CompilePropertyPlan(const UClass* objectClass) const
+{
+	TSharedPtr<FRunePropertyCopyPlan> plan = MakeShared<FRunePropertyCopyPlan>();
+	if (objectClass == nullptr)
+	{
+		return plan;
+	}
+
+	for (const TPair<FName, FString>& propPair : properties)
+	{
+		const FProperty* prop = FindFProperty<FProperty>(objectClass, propPair.Key);
+		if (prop == nullptr) continue;
+
+		plan->AddImportedValue(*prop, propPair.Value);
+	}
+
+	return plan;
+}
@@ -7,6 +7,9 @@
 #include "RuneTypes.generated.h"
 
 
+class FRunePropertyCopyPlan;
+
+
 USTRUCT(BlueprintType)
 struct FBooleanPtr
 {
@@ -20,7 +23,7 @@ struct FBooleanPtr
 };
 
 USTRUCT(BlueprintType)
-struct FRuneTangibleAgentTemplate
+struct RUNESYSTEM_API FRuneTangibleAgentTemplate
 {
 	GENERATED_BODY()
 
@@ -31,6 +34,42 @@ public:
 	{
 		return agentClass;
 	};
+
+	/**
+	 * Writes the templated properties into an agent, through
+	 * a plan compiled the first time it is needed.
+	 *
+	 * @param agent Agent of class agentClass (or a child class)
+	 */
+	void ApplyProperties(class ARuneTangibleAgent& agent) const;
+
+	/**
+	 * Writes the templated properties into a preview agent,
+	 * only those the preview agent class also has.
+	 *
+	 * @param previewAgent Preview agent of the templated agent
+	 */
+	void ApplyPreviewProperties(class ARunePreviewAgent& previewAgent) const;
+
+	/**
+	 * Gets a hash of the templated properties.
+	 *
+	 * @return Hash of the properties, 0 if there are none
+	 */
+	uint32 GetPropertiesHash() const;
+
+	/**
+	 * Discards the compiled plans, they will be compiled again on next use.
+	 * Must be called whenever agentClass or properties are modified.
+	 */
+	void InvalidatePropertyPlan();
+
+private:
+	/** Compiles the agent plan if there is none or it is outdated, discarding the preview one */
+	void ValidatePropertyPlans() const;
+
+	/** Compiles a plan resolving the templated properties against a class */
+	TSharedPtr<FRunePropertyCopyPlan> CompilePropertyPlan(const UClass* objectClass) const;
 	
 public:
 	/** Sets the class of TangibleAgent to be used */
@@ -45,6 +84,47 @@ public:
 
 	UPROPERTY(VisibleAnywhere, Export)
 	TMap<FName, FString> properties;
+
+private:
+	/** Compiled properties, shared among copies of the template */
+	mutable TSharedPtr<FRunePropertyCopyPlan> propertyPlan;
+
+	/** Class the plan was compiled for */
+	mutable TWeakObjectPtr<UClass> propertyPlanClass;
+
+	/** Compiled properties for the preview agent */
+	mutable TSharedPtr<FRunePropertyCopyPlan> previewPropertyPlan;
+
+	/** Class the preview plan was compiled for */
+	mutable TWeakObjectPtr<UClass> previewPropertyPlanClass;
+
+	/** Hash of the properties the plan was compiled from */
+	mutable uint32 propertiesHash = 0;
+
+	/** Class layout epoch the plans were compiled in */
+	mutable uint32 classLayoutEpoch = 0;
+};
+
+/**
+ * Per-instance runtime data of an effect application,
+ * captured when the effect is attached to an agent.
+ */
+USTRUCT(BlueprintType)
+struct FRuneEffectContext
+{
+	GENERATED_BODY()
+
+	/** Controller that spawned and/or controls the causer. It could be nullptr. */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly)
+	class AController* instigator = nullptr;
+
+	/** RuneFilter of the instigator. It could be nullptr. */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly)
+	const class URuneFilter* instigatorFilter = nullptr;
+
+	/** Actor which applies the effect. It could be nullptr. */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly)
+	class AActor* causer = nullptr;
 };
 
 
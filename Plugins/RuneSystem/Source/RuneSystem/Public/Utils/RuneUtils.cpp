@@ -3,6 +3,9 @@
 
 #include "RuneUtils.h"
 #include "RuneEffect.h"
+#include "RuneFilterCache.h"
+#include "RunePropertyCopyPlan.h"
+#include "UObject/ObjectKey.h"
 
 
 bool URuneUtils::ApplyEffect(URuneEffect* effect, AController* instigator, AActor* causer, AActor* target)
@@ -23,3 +26,46 @@ bool URuneUtils::RevertEffect(URuneEffect* effect, AActor* target)
 	return success;
 }
 
+void URuneUtils::InvalidateFilterCache(AActor* actor)
+{
+	if (actor == nullptr) return;
+
+	FRuneFilterCache::Get().InvalidateActor(*actor);
+}
+
+const FRunePropertyCopyPlan& URuneUtils::GetPreviewCopyPlan(UClass* agentClass, UClass* previewClass)
+{
+	// class keys are never reused, so new classes get their own plans
+	static TMap<TPair<TObjectKey<UClass>, TObjectKey<UClass>>, TUniquePtr<FRunePropertyCopyPlan>> plans;
+	static uint32 plansEpoch = 0;
+
+	// classes compiled in place invalidate all plans
+	if (plansEpoch != FRunePropertyCopyPlan::GetClassLayoutEpoch())
+	{
+		plans.Empty();
+		plansEpoch = FRunePropertyCopyPlan::GetClassLayoutEpoch();
+	}
+
+	TUniquePtr<FRunePropertyCopyPlan>& plan = plans.FindOrAdd({ agentClass, previewClass });
+	if (plan.IsValid())
+	{
+		return *plan;
+	}
+
+	plan = MakeUnique<FRunePropertyCopyPlan>();
+	for (TFieldIterator<FProperty> PropIt(agentClass, EFieldIteratorFlags::IncludeSuper); PropIt; ++PropIt)
+	{
+		FProperty* Property = *PropIt;
+
+		if (Property->HasAnyPropertyFlags(CPF_Edit)
+			&& !Property->HasAnyPropertyFlags(CPF_EditConst | CPF_DisableEditOnTemplate | CPF_DisableEditOnInstance))
+		{
+			FProperty* prop = FindFProperty<FProperty>(previewClass, Property->GetFName());
+			if (prop == nullptr) continue;
+
+			plan->AddCopiedValue(*Property, *prop);
+		}
+	}
+
+	return *plan;
+}
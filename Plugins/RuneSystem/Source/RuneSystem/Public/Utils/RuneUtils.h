@@ -10,6 +10,8 @@
 #include "RuneTangibleAgent.h"
 #include "RunePreviewAgent.h"
 #include "RuneCompatible.h"
+#include "RuneAgentPool.h"
+#include "Utils/RuneStats.h"
 #include "RuneUtils.generated.h"
 
 UCLASS()
@@ -40,6 +42,15 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Rune System|Rune Effect", meta = (DefaultToSelf = "effect", HideSelfPin))
 	static bool RevertEffect(class URuneEffect* effect, AActor* target);
 
+	/**
+	 * Invalidates the cached filter verdicts of a given actor.
+	 * Should be called after modifying its Tags or its components while rune.FilterCache.Enabled is on.
+	 *
+	 * @param actor Actor whose filtering data has changed
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Rune System|Rune Filter")
+	static void InvalidateFilterCache(AActor* actor);
+
 	template <class T, typename... Args>
 	static T* SpawnTangibleAgent(const URuneBehaviour& behaviour, UClass* InClass, Args... args);
 
@@ -52,11 +63,34 @@ public:
 	template <class T, typename... Args>
 	static T* SpawnPreviewAgent(const URuneBehaviour& behaviour, const FRuneTangibleAgentTemplate& agentTemplate, Args... args);
 
+private:
+	/**
+	 * Gets the cached plan copying the editable properties of an agent class
+	 * into the matching properties of a preview agent class.
+	 * Compiled the first time a pair of classes is used.
+	 *
+	 * @param agentClass Class whose default object is copied
+	 * @param previewClass Class of the preview agent
+	 * @return Copy plan
+	 */
+	static const class FRunePropertyCopyPlan& GetPreviewCopyPlan(UClass* agentClass, UClass* previewClass);
+
+	/** Gets the spawn transform out of the FinishSpawning() arguments */
+	template <typename... Args>
+	static const FTransform& GetSpawnTransform(const FTransform& transform, Args&&...)
+	{
+		return transform;
+	}
+
 };
 
 template <class T, typename... Args>
 static T* URuneUtils::SpawnTangibleAgent(const URuneBehaviour& behaviour, UClass* InClass, Args... args)
 {
+	RUNE_SCOPE_CYCLE_COUNTER(STAT_RuneSpawnTangibleAgent, "URuneUtils::SpawnTangibleAgent");
+	LLM_SCOPE_BYTAG(RuneSystem);
+	RUNE_SCOPE_PROFILE_PHASE(SPAWN_TANGIBLE_AGENT);
+
 	UClass* TClass = T::StaticClass();
 	if (!TClass->IsChildOf(ARuneTangibleAgent::StaticClass()) && TClass != ARuneTangibleAgent::StaticClass())
 	{
@@ -87,15 +121,36 @@ static T* URuneUtils::SpawnTangibleAgent(const URuneBehaviour& behaviour, UClass
 		}
 	}
 
-	ARuneTangibleAgent* agent = world->SpawnActor<ARuneTangibleAgent>(InClass, spawnInfo);
+	// poolable agents are reused instead of spawned
+	URuneAgentPool* agentPool = world->GetSubsystem<URuneAgentPool>();
+	ARuneTangibleAgent* agent = agentPool != nullptr ? agentPool->AcquireTangibleAgent(InClass, 0) : nullptr;
+	const bool isReused = agent != nullptr;
+	if (isReused)
+	{
+		agent->SetOwner(spawnInfo.Owner);
+		agent->SetInstigator(spawnInfo.Instigator);
+	}
+	else
+	{
+		agent = world->SpawnActor<ARuneTangibleAgent>(InClass, spawnInfo);
+	}
+
 	if (agent != nullptr)
 	{
 		behaviour.onTangibleAgentSpawnBegin.Broadcast(agent);
 
-		agent->SetAttachedRuneEffects(behaviour.onApplyPulse.GetAllObjects());
-		agent->FinishSpawning(std::forward<Args>(args)...);
+		agent->AttachRuneEffects(behaviour.GetLinkedEffects());
+		if (isReused)
+		{
+			agent->ReactivateAgent(GetSpawnTransform(args...));
+		}
+		else
+		{
+			agent->FinishSpawning(std::forward<Args>(args)...);
+		}
 
 		behaviour.onTangibleAgentSpawnEnd.Broadcast(agent);
+		RUNE_ADD_AGENT_SPAWNED(behaviour.costOwner);
 	}
 	return CastChecked<T>(agent, ECastCheckedType::NullAllowed);
 }
@@ -103,6 +158,10 @@ static T* URuneUtils::SpawnTangibleAgent(const URuneBehaviour& behaviour, UClass
 template <class T, typename... Args>
 static T* URuneUtils::SpawnTangibleAgent(const URuneBehaviour& behaviour, const FRuneTangibleAgentTemplate& agentTemplate, Args... args)
 {
+	RUNE_SCOPE_CYCLE_COUNTER(STAT_RuneSpawnTangibleAgent, "URuneUtils::SpawnTangibleAgent");
+	LLM_SCOPE_BYTAG(RuneSystem);
+	RUNE_SCOPE_PROFILE_PHASE(SPAWN_TANGIBLE_AGENT);
+
 	UClass* TClass = T::StaticClass();
 	if (!TClass->IsChildOf(ARuneTangibleAgent::StaticClass()) && TClass != ARuneTangibleAgent::StaticClass())
 	{
@@ -133,25 +192,43 @@ static T* URuneUtils::SpawnTangibleAgent(const URuneBehaviour& behaviour, const
 		}
 	}
 
-	ARuneTangibleAgent* agent = world->SpawnActor<ARuneTangibleAgent>(agentTemplate.agentClass, spawnInfo);
+	// poolable agents are reused instead of spawned, per template properties
+	URuneAgentPool* agentPool = world->GetSubsystem<URuneAgentPool>();
+	const uint32 templateHash = URuneAgentPool::IsPoolable(agentTemplate.agentClass) ? URuneAgentPool::GetTemplateHash(agentTemplate) : 0;
+	ARuneTangibleAgent* agent = agentPool != nullptr ? agentPool->AcquireTangibleAgent(agentTemplate.agentClass, templateHash) : nullptr;
+	const bool isReused = agent != nullptr;
+	if (isReused)
+	{
+		agent->SetOwner(spawnInfo.Owner);
+		agent->SetInstigator(spawnInfo.Instigator);
+	}
+	else
+	{
+		agent = world->SpawnActor<ARuneTangibleAgent>(agentTemplate.agentClass, spawnInfo);
+	}
+
 	if (agent != nullptr)
 	{
-		// initialize templated properties
-		for (auto& propPair : agentTemplate.properties)
-		{
-			FProperty* prop = FindFProperty<FProperty>(agent->GetClass(), propPair.Key);
-			if (prop == nullptr) continue;
+		agent->templateHash = templateHash;
 
-			prop->ImportText(*propPair.Value, prop->ContainerPtrToValuePtr<uint8>(agent, 0), PPF_None, agent);
-		}
+		// initialize templated properties (reused agents could have modified them)
+		agentTemplate.ApplyProperties(*agent);
 
 		// invoked after setting properties to have consitent data
 		behaviour.onTangibleAgentSpawnBegin.Broadcast(agent);
 
-		agent->SetAttachedRuneEffects(behaviour.onApplyPulse.GetAllObjects());
-		agent->FinishSpawning(std::forward<Args>(args)...);
+		agent->AttachRuneEffects(behaviour.GetLinkedEffects());
+		if (isReused)
+		{
+			agent->ReactivateAgent(GetSpawnTransform(args...));
+		}
+		else
+		{
+			agent->FinishSpawning(std::forward<Args>(args)...);
+		}
 
 		behaviour.onTangibleAgentSpawnEnd.Broadcast(agent);
+		RUNE_ADD_AGENT_SPAWNED(behaviour.costOwner);
 	}
 
 	return CastChecked<T>(agent, ECastCheckedType::NullAllowed);
@@ -160,6 +237,9 @@ static T* URuneUtils::SpawnTangibleAgent(const URuneBehaviour& behaviour, const
 template<class T, typename ...Args>
 inline T* URuneUtils::SpawnPreviewAgent(const URuneBehaviour& behaviour, UClass* InClass, Args ...args)
 {
+	RUNE_SCOPE_CYCLE_COUNTER(STAT_RuneSpawnPreviewAgent, "URuneUtils::SpawnPreviewAgent");
+	RUNE_SCOPE_PROFILE_PHASE(SPAWN_PREVIEW_AGENT);
+
 	UClass* TClass = T::StaticClass();
 	if (!TClass->IsChildOf(ARunePreviewAgent::StaticClass()) && TClass != ARunePreviewAgent::StaticClass())
 	{
@@ -179,34 +259,37 @@ inline T* URuneUtils::SpawnPreviewAgent(const URuneBehaviour& behaviour, UClass*
 		return nullptr;
 	}
 
-	ARunePreviewAgent* previewAgent = world->SpawnActorDeferred<ARunePreviewAgent>(InClass, std::forward<Args>(args)...);
-	if (previewAgent != nullptr)
+	// preview agents hidden by the behaviour are reused instead of spawned
+	URuneAgentPool* agentPool = world->GetSubsystem<URuneAgentPool>();
+	ARunePreviewAgent* previewAgent = agentPool != nullptr ? agentPool->AcquirePreviewAgent(behaviour, InClass) : nullptr;
+	const bool isReused = previewAgent != nullptr;
+	if (isReused)
 	{
-		UObject* tangibleAgent = InClass->GetDefaultObject();
-		// set tangibleagent defaults then override them with the properties
-		for (TFieldIterator<FProperty> PropIt(InClass, EFieldIteratorFlags::IncludeSuper); PropIt; ++PropIt)
-		{
-			FProperty* Property = *PropIt;
-
-			if (Property->HasAnyPropertyFlags(CPF_Edit)
-				&& !Property->HasAnyPropertyFlags(CPF_EditConst | CPF_DisableEditOnTemplate | CPF_DisableEditOnInstance))
-			{
-				FProperty* prop = FindFProperty<FProperty>(previewAgent->GetClass(), Property->GetFName());
-				if (prop == nullptr) continue;
-
-				FString serializedData;
-				Property->ExportText_InContainer(0, serializedData, tangibleAgent, tangibleAgent, Property->GetOwnerUObject(), PPF_None);
+		previewAgent->SetActorTransform(GetSpawnTransform(args...));
+	}
+	else
+	{
+		previewAgent = world->SpawnActorDeferred<ARunePreviewAgent>(InClass, std::forward<Args>(args)...);
+	}
 
-				prop->ImportText(*serializedData, prop->ContainerPtrToValuePtr<uint8>(previewAgent, 0), PPF_None, previewAgent);
-			}
-		}
+	if (previewAgent != nullptr)
+	{
+		// set defaults through the cached copy plan
+		GetPreviewCopyPlan(InClass, previewAgent->GetClass()).Apply(*previewAgent, InClass->GetDefaultObject());
 
 		previewAgent->isInitializedHidden ? previewAgent->Hide() : previewAgent->Show();
 
 		// invoked after setting properties to have consitent data
 		behaviour.onPreviewAgentSpawnBegin.Broadcast(previewAgent);
 
-		previewAgent->FinishSpawning(std::forward<Args>(args)...);
+		if (!isReused)
+		{
+			previewAgent->FinishSpawning(std::forward<Args>(args)...);
+		}
+		if (agentPool != nullptr)
+		{
+			agentPool->TrackPreviewAgent(behaviour, *previewAgent);
+		}
 
 		behaviour.onPreviewAgentSpawnBegin.Broadcast(previewAgent);
 	}
@@ -216,6 +299,9 @@ inline T* URuneUtils::SpawnPreviewAgent(const URuneBehaviour& behaviour, UClass*
 template<class T, typename ...Args>
 inline T* URuneUtils::SpawnPreviewAgent(const URuneBehaviour& behaviour, const FRuneTangibleAgentTemplate& agentTemplate, Args ...args)
 {
+	RUNE_SCOPE_CYCLE_COUNTER(STAT_RuneSpawnPreviewAgent, "URuneUtils::SpawnPreviewAgent");
+	RUNE_SCOPE_PROFILE_PHASE(SPAWN_PREVIEW_AGENT);
+
 	UClass* TClass = T::StaticClass();
 	if (!TClass->IsChildOf(ARunePreviewAgent::StaticClass()) && TClass != ARunePreviewAgent::StaticClass())
 	{
@@ -277,46 +363,41 @@ inline T* URuneUtils::SpawnPreviewAgent(const URuneBehaviour& behaviour, const F
 		return nullptr;
 	}
 
-	FActorSpawnParameters spawnInfo;
-	spawnInfo.bDeferConstruction = true;
+	// preview agents hidden by the behaviour are reused instead of spawned
+	URuneAgentPool* agentPool = world->GetSubsystem<URuneAgentPool>();
+	ARunePreviewAgent* previewAgent = agentPool != nullptr ? agentPool->AcquirePreviewAgent(behaviour, previewClass) : nullptr;
+	const bool isReused = previewAgent != nullptr;
+	if (isReused)
+	{
+		previewAgent->SetActorTransform(GetSpawnTransform(args...));
+	}
+	else
+	{
+		FActorSpawnParameters spawnInfo;
+		spawnInfo.bDeferConstruction = true;
+
+		previewAgent = world->SpawnActor<ARunePreviewAgent>(previewClass, spawnInfo);
+	}
 
-	ARunePreviewAgent* previewAgent = world->SpawnActor<ARunePreviewAgent>(previewClass, spawnInfo);
 	if (previewAgent != nullptr)
 	{
-		UObject* tangibleAgent = agentTemplate.agentClass->GetDefaultObject();
 		// set tangibleagent defaults then override them with the properties
-		for (TFieldIterator<FProperty> PropIt(agentTemplate.agentClass, EFieldIteratorFlags::IncludeSuper); PropIt; ++PropIt)
-		{
-			FProperty* Property = *PropIt;
-
-			if (Property->HasAnyPropertyFlags(CPF_Edit)
-				&& !Property->HasAnyPropertyFlags(CPF_EditConst | CPF_DisableEditOnTemplate | CPF_DisableEditOnInstance))
-			{
-				FProperty* prop = FindFProperty<FProperty>(previewAgent->GetClass(), Property->GetFName());
-				if (prop == nullptr) continue;
-
-				FString serializedData;
-				Property->ExportText_InContainer(0, serializedData, tangibleAgent, tangibleAgent, Property->GetOwnerUObject(), PPF_None);
-
-				prop->ImportText(*serializedData, prop->ContainerPtrToValuePtr<uint8>(previewAgent, 0), PPF_None, previewAgent);
-			}
-		}
-
-		// initialize templated properties
-		for (auto& propPair : agentTemplate.properties)
-		{
-			FProperty* prop = FindFProperty<FProperty>(previewAgent->GetClass(), propPair.Key);
-			if (prop == nullptr) continue;
-
-			prop->ImportText(*propPair.Value, prop->ContainerPtrToValuePtr<uint8>(previewAgent, 0), PPF_None, previewAgent);
-		}
+		GetPreviewCopyPlan(agentTemplate.agentClass, previewAgent->GetClass()).Apply(*previewAgent, agentTemplate.agentClass->GetDefaultObject());
+		agentTemplate.ApplyPreviewProperties(*previewAgent);
 
 		previewAgent->isInitializedHidden ? previewAgent->Hide() : previewAgent->Show();
 
 		// invoked after setting properties to have consitent data
 		behaviour.onPreviewAgentSpawnBegin.Broadcast(previewAgent);
 
-		previewAgent->FinishSpawning(std::forward<Args>(args)...);
+		if (!isReused)
+		{
+			previewAgent->FinishSpawning(std::forward<Args>(args)...);
+		}
+		if (agentPool != nullptr)
+		{
+			agentPool->TrackPreviewAgent(behaviour, *previewAgent);
+		}
 
 		behaviour.onPreviewAgentSpawnEnd.Broadcast(previewAgent);
 	}
@@ -444,3 +525,115 @@ public:
 
 #define EXTEND_ENUM(BaseEnum, Enum)	template <> \
 									struct EnumExtension<BaseEnum> { using ExtensionType = Enum; };
+
+// ----------------------------
+// Extended Enum Dispatch Tables
+// ----------------------------
+
+template <ExtendableEnumConcept BaseEnum>
+consteval auto Get_ExtendedEnumLast()
+{
+	//Last value of the last link in the extension chain
+	using NextExtension = EnumExtensionT<BaseEnum>;
+	if constexpr (std::is_same_v<NextExtension, void>)
+		return to_underlying(BaseEnum::LAST_ENUM);
+	else
+	{
+		static_assert(Can_ExtendEnum<BaseEnum, NextExtension>(), "Enum extension overlaps the range of the enum it extends");
+		return Get_ExtendedEnumLast<NextExtension>();
+	}
+}
+
+/**
+ * Dense table mapping every value of an extended enum (base enum plus its extensions) to a handler.
+ *
+ * Values are stored contiguously from BaseEnum::FIRST_ENUM to the LAST_ENUM of the last extension,
+ * so dispatching a value is a single range check and an indexed load instead of chained comparisons.
+ * Tables are meant to be built at compile time, and assigning a value out of the range does not compile.
+ *
+ * Example:
+ *	static constexpr auto table = TExtendedEnumDispatchTable<ERuneTaskValue, FHandler>(&OnDefault)
+ *		.With<ERuneTaskValue::SUCCESS>(&OnSuccess)
+ *		.With<EUserDefinedRuneTaskReturnValue::SECOND>(&OnSecond);
+ *	table[activeRuneTask->taskValue](...);
+ *
+ * @tparam BaseEnum Enum being extended
+ * @tparam HandlerType Mapped type, usually a function pointer or an enum of actions
+ */
+template <ExtendableEnumConcept BaseEnum, typename HandlerType>
+class TExtendedEnumDispatchTable
+{
+public:
+	using DataType = std::underlying_type_t<BaseEnum>;
+
+	static constexpr DataType First = to_underlying(BaseEnum::FIRST_ENUM);
+	static constexpr DataType Last = Get_ExtendedEnumLast<BaseEnum>();
+	static constexpr int32 Num = static_cast<int32>(Last) - static_cast<int32>(First) + 1;
+
+	static_assert(First <= Last, "Extended enum range is empty");
+
+	/**
+	 * Creates a table mapping every value to the same handler.
+	 *
+	 * @param inDefaultHandler Handler of the values without one, and of the values out of range
+	 */
+	constexpr explicit TExtendedEnumDispatchTable(HandlerType inDefaultHandler) : defaultHandler(inDefaultHandler), handlers()
+	{
+		for (int32 i = 0; i < Num; ++i)
+		{
+			handlers[i] = inDefaultHandler;
+		}
+	}
+
+	/**
+	 * Whether a value is in the range of the extended enum.
+	 *
+	 * @param value Underlying value
+	 * @return If true, the value has its own entry in the table
+	 */
+	static constexpr bool IsInRange(DataType value) { return value >= First && value <= Last; }
+
+	/**
+	 * Gets a copy of the table mapping a value to a handler.
+	 *
+	 * @tparam Value Value of the base enum or of one of its extensions, in range
+	 * @param handler Handler of the value
+	 * @return Table with the value mapped
+	 */
+	template <auto Value>
+	constexpr TExtendedEnumDispatchTable With(HandlerType handler) const
+		requires (ExtendableEnumConcept<decltype(Value)> && ExtendedEnum<BaseEnum>::template Is_Storable<decltype(Value)>())
+	{
+		static_assert(IsInRange(to_underlying(Value)), "Value is out of the range of the extended enum");
+
+		TExtendedEnumDispatchTable result = *this;
+		result.handlers[to_underlying(Value) - First] = handler;
+		return result;
+	}
+
+	/**
+	 * Gets the handler of a value.
+	 *
+	 * @param value Underlying value
+	 * @return Handler of the value, the default handler if out of range
+	 */
+	constexpr HandlerType Get(DataType value) const
+	{
+		// values below First wrap around, so a single comparison checks both bounds
+		const uint32 index = static_cast<uint32>(value) - static_cast<uint32>(First);
+		return index < static_cast<uint32>(Num) ? handlers[index] : defaultHandler;
+	}
+
+	constexpr HandlerType operator[](const ExtendedEnum<BaseEnum>& value) const { return Get(value.Get()); }
+
+	template <ExtendableEnumConcept EnumType>
+	constexpr HandlerType operator[](EnumType value) const
+		requires (ExtendedEnum<BaseEnum>::template Is_Storable<EnumType>())
+	{
+		return Get(to_underlying(value));
+	}
+
+private:
+	HandlerType defaultHandler;
+	HandlerType handlers[Num];
+};
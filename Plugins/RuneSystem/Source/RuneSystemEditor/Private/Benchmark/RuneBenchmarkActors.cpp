@@ -0,0 +1,236 @@
+
+
+#include "RuneBenchmarkActors.h"
+#include "Components/SceneComponent.h"
+#include "UObject/UObjectHash.h"
+
+
+// ----------------------------
+// Filter
+// ----------------------------
+
+namespace RuneBenchmarkActors
+{
+	/** Name shared by the generated tags, told apart by their number */
+	const FName TagBaseName(TEXT("RuneBenchmarkTag"));
+
+	/**
+	 * Gets native, concrete classes derived from a base class, sorted by name to be the same every run.
+	 *
+	 * @param baseClass Base class
+	 * @param num Maximum number of classes
+	 * @param outClasses Found classes
+	 */
+	template <typename T>
+	void GetBenchmarkClasses(UClass* baseClass, int32 num, TArray<TSubclassOf<T>>& outClasses)
+	{
+		TArray<UClass*> derivedClasses;
+		GetDerivedClasses(baseClass, derivedClasses);
+		derivedClasses.RemoveAll([](const UClass* derivedClass)
+		{
+			return !derivedClass->HasAnyClassFlags(CLASS_Native) || derivedClass->HasAnyClassFlags(CLASS_Abstract | CLASS_Deprecated);
+		});
+		derivedClasses.Sort([](const UClass& a, const UClass& b) { return a.GetFName().LexicalLess(b.GetFName()); });
+
+		for (int32 i = 0; i < derivedClasses.Num() && outClasses.Num() < num; ++i)
+		{
+			outClasses.Add(derivedClasses[i]);
+		}
+	}
+
+	void SetupTagFilter(FRuneFilterData& filterData, int32 numEntries)
+	{
+		filterData.filterType |= static_cast<uint8>(ERuneFilterType::TAGS);
+		for (int32 i = 0; i < numEntries; ++i)
+		{
+			filterData.factionBTagsFilter.Add(URuneBenchmarkFilter::GetBenchmarkTag(i));
+		}
+	}
+
+	void SetupClassFilter(FRuneFilterData& filterData, int32 numEntries)
+	{
+		filterData.filterType |= static_cast<uint8>(ERuneFilterType::ACTOR_CLASS) | static_cast<uint8>(ERuneFilterType::COMPONENT_CLASS);
+		GetBenchmarkClasses(AActor::StaticClass(), numEntries, filterData.factionBActorClassFilter);
+		GetBenchmarkClasses(UActorComponent::StaticClass(), numEntries, filterData.factionBComponentClassFilter);
+	}
+}
+
+void URuneBenchmarkFilter::Setup(ERuneBenchmarkFilterShape shape, int32 numEntries, TSubclassOf<URuneEffect> effectClass)
+{
+	runeFilterData = FRuneFilterData();
+	runeFilterDataOverrides.Reset();
+
+	switch (shape)
+	{
+	case ERuneBenchmarkFilterShape::TAG_HEAVY:
+		RuneBenchmarkActors::SetupTagFilter(runeFilterData, numEntries);
+		break;
+	case ERuneBenchmarkFilterShape::CLASS_HEAVY:
+		RuneBenchmarkActors::SetupClassFilter(runeFilterData, numEntries);
+		break;
+	case ERuneBenchmarkFilterShape::MANY_OVERRIDES:
+	{
+		RuneBenchmarkActors::SetupTagFilter(runeFilterData, numEntries);
+
+		// one override per effect class, the benchmark one included
+		TArray<TSubclassOf<URuneEffect>> effectClasses;
+		RuneBenchmarkActors::GetBenchmarkClasses(URuneEffect::StaticClass(), numEntries, effectClasses);
+		effectClasses.AddUnique(effectClass);
+		for (const TSubclassOf<URuneEffect>& overriddenClass : effectClasses)
+		{
+			FRuneFilterData& filterDataOverride = runeFilterDataOverrides.Add(overriddenClass);
+			RuneBenchmarkActors::SetupTagFilter(filterDataOverride, numEntries);
+			RuneBenchmarkActors::SetupClassFilter(filterDataOverride, numEntries);
+		}
+		break;
+	}
+	default:
+		break;
+	}
+
+	Compile();
+}
+
+FName URuneBenchmarkFilter::GetBenchmarkTag(int32 index)
+{
+	return FName(RuneBenchmarkActors::TagBaseName, index);
+}
+
+// ----------------------------
+// Target
+// ----------------------------
+
+ARuneBenchmarkTarget::ARuneBenchmarkTarget()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+}
+
+// ----------------------------
+// Caster
+// ----------------------------
+
+ARuneBenchmarkCaster::ARuneBenchmarkCaster() :
+	runeFilter(nullptr),
+	runeInput()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+}
+
+const FRuneInput& ARuneBenchmarkCaster::GetRuneInput()
+{
+	runeInput.aimDirection = GetActorForwardVector();
+	runeInput.inputDirection = GetActorForwardVector();
+	runeInput.originLocation = GetActorLocation();
+	runeInput.isMaxMagnitudeNormalized = true;
+	runeInput.lockedTarget = nullptr;
+	return runeInput;
+}
+
+// ----------------------------
+// Agent
+// ----------------------------
+
+TArray<AActor*> ARuneBenchmarkAgent::targets;
+float ARuneBenchmarkAgent::lifetime = 1.0f;
+
+ARuneBenchmarkAgent::ARuneBenchmarkAgent() :
+	speed(1000.0f),
+	timeAlive(0.0f),
+	hasHit(false)
+{
+	isPoolable = true;
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+}
+
+void ARuneBenchmarkAgent::SetupScenario(TConstArrayView<AActor*> inTargets, float inLifetime)
+{
+	targets = inTargets;
+	lifetime = inLifetime;
+}
+
+void ARuneBenchmarkAgent::BeginPlay()
+{
+	duration = lifetime;
+
+	Super::BeginPlay();
+}
+
+void ARuneBenchmarkAgent::ActivateAgent()
+{
+	Super::ActivateAgent();
+
+	timeAlive = 0.0f;
+	hasHit = false;
+}
+
+void ARuneBenchmarkAgent::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	AddActorWorldOffset(GetActorForwardVector() * speed * DeltaTime);
+
+	// hits halfway through its life, as an area of effect
+	timeAlive += DeltaTime;
+	if (!hasHit && timeAlive >= lifetime * 0.5f)
+	{
+		hasHit = true;
+		TryApplyEffectsBatch(targets);
+	}
+}
+
+// ----------------------------
+// Behaviour
+// ----------------------------
+
+TArray<AActor*> URuneBenchmarkBehaviour::targets;
+
+URuneBenchmarkBehaviour::URuneBenchmarkBehaviour() :
+	mode(ERuneBenchmarkBehaviourMode::PULSE_TARGETS),
+	agentsPerActivation(1)
+{
+}
+
+void URuneBenchmarkBehaviour::SetTargets(TConstArrayView<AActor*> inTargets)
+{
+	targets = inTargets;
+}
+
+void URuneBenchmarkBehaviour::ActivateBehaviour()
+{
+	switch (mode)
+	{
+	case ERuneBenchmarkBehaviourMode::SPAWN_AGENTS:
+	{
+		const FTransform transform = GetOwner() != nullptr ? GetOwner()->GetActorTransform() : FTransform::Identity;
+		for (int32 i = 0; i < agentsPerActivation; ++i)
+		{
+			SpawnTangibleAgent(ARuneBenchmarkAgent::StaticClass(), transform);
+		}
+		break;
+	}
+	case ERuneBenchmarkBehaviourMode::PULSE_TARGETS:
+		for (AActor* target : targets)
+		{
+			BroadcastApplyPulse(target);
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+// ----------------------------
+// Effect
+// ----------------------------
+
+uint64 URuneBenchmarkEffect::numApplications = 0;
+
+void URuneBenchmarkEffect::Apply(AController* instigator, AActor* causer, AActor* target)
+{
+	++numApplications;
+}
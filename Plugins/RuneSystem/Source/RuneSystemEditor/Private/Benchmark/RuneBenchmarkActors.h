@@ -0,0 +1,217 @@
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "RuneBehaviour.h"
+#include "RuneCompatible.h"
+#include "RuneEffect.h"
+#include "RuneFilter.h"
+#include "RuneTangibleAgent.h"
+#include "Utils/RuneTypes.h"
+#include "RuneBenchmarkActors.generated.h"
+
+
+UENUM()
+enum class ERuneBenchmarkFilterShape : uint8
+{
+	/** No filter, every target is affected */
+	NONE = 0,
+
+	/** Filtered by many tags */
+	TAG_HEAVY,
+
+	/** Filtered by many actor and component classes */
+	CLASS_HEAVY,
+
+	/** Filtered by tags and classes, with an override per effect class */
+	MANY_OVERRIDES
+};
+
+/**
+ * Filter whose data is generated by the benchmark instead of authored.
+ */
+UCLASS(NotBlueprintable, Transient)
+class URuneBenchmarkFilter : public URuneFilter
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Fills the filter data with a given shape and compiles it.
+	 *
+	 * @param shape Shape of the filter
+	 * @param numEntries Tags or classes per faction
+	 * @param effectClass Effect class overridden by MANY_OVERRIDES
+	 */
+	void Setup(ERuneBenchmarkFilterShape shape, int32 numEntries, TSubclassOf<URuneEffect> effectClass);
+
+	/**
+	 * Gets one of the tags listed by the filters, so that targets can match them.
+	 *
+	 * @param index Index of the tag, filters list the first numEntries ones
+	 * @return Tag
+	 */
+	static FName GetBenchmarkTag(int32 index);
+};
+
+/**
+ * Target of the benchmark pulses, tagged so that filters have something to match.
+ */
+UCLASS(NotBlueprintable, Transient)
+class ARuneBenchmarkTarget : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	ARuneBenchmarkTarget();
+};
+
+/**
+ * Rune owner of the benchmark, aiming forward with no controller.
+ */
+UCLASS(NotBlueprintable, Transient)
+class ARuneBenchmarkCaster : public AActor, public IRuneCompatible
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	ARuneBenchmarkCaster();
+
+	virtual const FRuneInput& GetRuneInput() override;
+	virtual const URuneFilter* GetRuneFilter() const override { return runeFilter; };
+	virtual AController* GetController() const override { return nullptr; };
+
+public:
+	/** Filter of the caster, used by effects without a custom filter */
+	UPROPERTY()
+	TObjectPtr<URuneFilter> runeFilter;
+
+private:
+	FRuneInput runeInput;
+};
+
+/**
+ * Projectile of the benchmark, moving forward until its duration expires.
+ * Applies its effects to every target at once, some time after being spawned.
+ */
+UCLASS(NotBlueprintable, Transient)
+class ARuneBenchmarkAgent : public ARuneTangibleAgent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	ARuneBenchmarkAgent();
+
+	virtual void Tick(float DeltaTime) override;
+
+	/**
+	 * Sets the targets hit by the agents, shared by every agent. Cleared once the scenario ends.
+	 *
+	 * @param inTargets Targets of the scenario
+	 * @param inLifetime Time - in seconds - agents live before being released
+	 */
+	static void SetupScenario(TConstArrayView<AActor*> inTargets, float inLifetime);
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void ActivateAgent() override;
+
+public:
+	/** Speed - in centimeters per second - of the agent. Set by the templates of the micro-benchmarks */
+	UPROPERTY(EditAnywhere)
+	float speed;
+
+private:
+	/** Targets hit by every agent */
+	static TArray<AActor*> targets;
+
+	/** Time - in seconds - every agent lives before being released */
+	static float lifetime;
+
+	/** Time - in seconds - since the agent was spawned or reused */
+	float timeAlive;
+
+	/** Whether the agent has already hit the targets */
+	bool hasHit;
+};
+
+UENUM()
+enum class ERuneBenchmarkBehaviourMode : uint8
+{
+	/** Spawns agents, which apply the effects */
+	SPAWN_AGENTS = 0,
+
+	/** Applies the effects to every target at once */
+	PULSE_TARGETS
+};
+
+/**
+ * Behaviour of the benchmark, either spawning agents or pulsing targets when activated.
+ */
+UCLASS(NotBlueprintable, Transient)
+class URuneBenchmarkBehaviour : public URuneBehaviour
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	URuneBenchmarkBehaviour();
+
+	/**
+	 * Sets the targets pulsed by the behaviours, shared by every behaviour. Cleared once the scenario ends.
+	 *
+	 * @param inTargets Targets of the scenario
+	 */
+	static void SetTargets(TConstArrayView<AActor*> inTargets);
+
+	/**
+	 * Applies the linked effects to a target, as an activation would.
+	 *
+	 * @param target Actor affected by the pulse
+	 * @return If true, at least one effect has been applied
+	 */
+	bool PulseTarget(AActor* target) const { return BroadcastApplyPulse(target); };
+
+	/**
+	 * Spawns an agent from a template, as a behaviour would.
+	 *
+	 * @param agentTemplate Template containing the spawned class
+	 * @param transform Transform of the agent
+	 * @return Spawned or reused agent, nullptr if it could not be spawned
+	 */
+	ARuneTangibleAgent* SpawnAgent(const FRuneTangibleAgentTemplate& agentTemplate, const FTransform& transform) { return SpawnTangibleAgent(agentTemplate, transform); };
+
+protected:
+	virtual void ActivateBehaviour() override;
+
+public:
+	/** What the behaviour does when activated */
+	ERuneBenchmarkBehaviourMode mode;
+
+	/** Agents spawned per activation */
+	int32 agentsPerActivation;
+
+private:
+	/** Targets pulsed by every behaviour */
+	static TArray<AActor*> targets;
+};
+
+/**
+ * Effect of the benchmark, counting its applications natively.
+ */
+UCLASS(NotBlueprintable, Transient)
+class URuneBenchmarkEffect : public URuneEffect
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Apply(AController* instigator, AActor* causer, AActor* target) override;
+
+	/** Applications of every benchmark effect since the last reset */
+	static uint64 numApplications;
+};
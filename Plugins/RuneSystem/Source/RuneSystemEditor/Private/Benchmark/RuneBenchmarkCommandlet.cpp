@@ -0,0 +1,513 @@
+
+
+#include "RuneBenchmarkCommandlet.h"
+#include "RuneBenchmarkMalloc.h"
+#include "RuneBenchmarkWorld.h"
+#include "RuneMicroBenchmarks.h"
+#include "RuneBaseComponent.h"
+#include "Utils/RuneStats.h"
+#include "Algo/AllOf.h"
+#include "Engine/World.h"
+#include "Dom/JsonObject.h"
+#include "HAL/FileManager.h"
+#include "JsonObjectConverter.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+
+FRuneBenchmarkScenario::FRuneBenchmarkScenario() :
+	name(),
+	numCasters(1),
+	numRunesPerCaster(1),
+	behaviourMode(ERuneBenchmarkBehaviourMode::PULSE_TARGETS),
+	agentsPerCast(1),
+	agentLifetime(1.0f),
+	numEffects(1),
+	applicationType(EApplicationType::IMMEDIATE),
+	effectDuration(0.0f),
+	effectTicks(0),
+	numTargets(1),
+	filterShape(ERuneBenchmarkFilterShape::NONE),
+	filterEntries(0),
+	castInterval(30),
+	warmupFrames(60),
+	frames(600)
+{
+}
+
+namespace RuneBenchmarkCommandlet
+{
+	/** Seed of the random streams when none is given */
+	constexpr int32 DefaultSeed = 0x52554E45;
+
+	/** Distance - in centimeters - between spawned actors */
+	constexpr float ActorSpacing = 200.0f;
+
+	/** Per-frame samples of a measured value */
+	struct FMetric
+	{
+		FString name;
+		FString unit;
+		TArray<double> samples;
+	};
+
+	/** Summary of a metric over every measured frame */
+	struct FMetricSummary
+	{
+		FString name;
+		FString unit;
+		double mean = 0.0;
+		double p50 = 0.0;
+		double p99 = 0.0;
+	};
+
+	/** Results of a scenario */
+	struct FScenarioReport
+	{
+		FString name;
+		int32 frames = 0;
+		uint64 effectApplications = 0;
+		TArray<FMetricSummary> metrics;
+
+		/** Whether the effect applications have been timed by the EFFECT_APPLY phase */
+		bool isEffectApplyTimed = true;
+	};
+
+	TArray<FRuneBenchmarkScenario> GetBuiltInScenarios()
+	{
+		TArray<FRuneBenchmarkScenario> scenarios;
+
+		// many casters, each one with a few runes pulsing a handful of targets
+		FRuneBenchmarkScenario& castersByRunes = scenarios.AddDefaulted_GetRef();
+		castersByRunes.name = TEXT("CastersByRunes");
+		castersByRunes.numCasters = 64;
+		castersByRunes.numRunesPerCaster = 4;
+		castersByRunes.numTargets = 8;
+		castersByRunes.castInterval = 10;
+
+		// every cast spawns projectiles, which are pooled and hit every target once
+		FRuneBenchmarkScenario& projectileStorm = scenarios.AddDefaulted_GetRef();
+		projectileStorm.name = TEXT("ProjectileStorm");
+		projectileStorm.numCasters = 32;
+		projectileStorm.numRunesPerCaster = 2;
+		projectileStorm.behaviourMode = ERuneBenchmarkBehaviourMode::SPAWN_AGENTS;
+		projectileStorm.agentsPerCast = 4;
+		projectileStorm.agentLifetime = 1.0f;
+		projectileStorm.numTargets = 16;
+		projectileStorm.castInterval = 6;
+
+		// long effects over time stacking on many targets
+		FRuneBenchmarkScenario& dotSaturation = scenarios.AddDefaulted_GetRef();
+		dotSaturation.name = TEXT("DoTSaturation");
+		dotSaturation.numCasters = 16;
+		dotSaturation.numRunesPerCaster = 2;
+		dotSaturation.numEffects = 4;
+		dotSaturation.applicationType = EApplicationType::OVER_TIME;
+		dotSaturation.effectDuration = 5.0f;
+		dotSaturation.effectTicks = 10;
+		dotSaturation.numTargets = 64;
+		dotSaturation.castInterval = 30;
+		dotSaturation.warmupFrames = 300;
+
+		// areas of effect over many targets, with filters as expensive as they get
+		FRuneBenchmarkScenario& filterHeavyAoE = scenarios.AddDefaulted_GetRef();
+		filterHeavyAoE.name = TEXT("FilterHeavyAoE");
+		filterHeavyAoE.numCasters = 16;
+		filterHeavyAoE.numRunesPerCaster = 2;
+		filterHeavyAoE.numEffects = 4;
+		filterHeavyAoE.numTargets = 128;
+		filterHeavyAoE.filterShape = ERuneBenchmarkFilterShape::MANY_OVERRIDES;
+		filterHeavyAoE.filterEntries = 32;
+		filterHeavyAoE.castInterval = 15;
+
+		return scenarios;
+	}
+
+	bool LoadScenarios(const FString& path, TArray<FRuneBenchmarkScenario>& outScenarios)
+	{
+		FString json;
+		if (!FFileHelper::LoadFileToString(json, *path))
+		{
+			UE_LOG(LogTemp, Error, TEXT("[URuneBenchmarkCommandlet] LoadScenarios(): could not read %s"), *path);
+			return false;
+		}
+
+		if (!FJsonObjectConverter::JsonArrayStringToUStruct(json, &outScenarios))
+		{
+			UE_LOG(LogTemp, Error, TEXT("[URuneBenchmarkCommandlet] LoadScenarios(): %s is not an array of scenarios"), *path);
+			return false;
+		}
+
+		return true;
+	}
+
+	FMetricSummary Summarize(const FMetric& metric)
+	{
+		FMetricSummary summary;
+		summary.name = metric.name;
+		summary.unit = metric.unit;
+
+		const int32 numSamples = metric.samples.Num();
+		if (numSamples == 0) return summary;
+
+		TArray<double> sortedSamples = metric.samples;
+		sortedSamples.Sort();
+
+		double sum = 0.0;
+		for (double sample : sortedSamples)
+		{
+			sum += sample;
+		}
+
+		// nearest rank percentiles
+		auto getPercentile = [&sortedSamples, numSamples](double percentile)
+		{
+			return sortedSamples[FMath::Clamp(FMath::CeilToInt32(percentile * numSamples) - 1, 0, numSamples - 1)];
+		};
+
+		summary.mean = sum / numSamples;
+		summary.p50 = getPercentile(0.5);
+		summary.p99 = getPercentile(0.99);
+		return summary;
+	}
+
+	/**
+	 * Spawns the targets and the casters of a scenario in a grid.
+	 *
+	 * @param world World of the benchmark
+	 * @param scenario Spawned scenario
+	 * @param outRunes Runes of every caster, in spawn order
+	 * @param outTargets Spawned targets
+	 */
+	void SpawnScenario(UWorld& world, const FRuneBenchmarkScenario& scenario, TArray<URuneBaseComponent*>& outRunes, TArray<AActor*>& outTargets)
+	{
+		FActorSpawnParameters spawnParameters;
+		spawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		// half of the targets match the tags listed by the filters
+		const int32 numTags = FMath::Max(scenario.filterEntries, 1) * 2;
+		const int32 targetsPerRow = FMath::Max(FMath::CeilToInt32(FMath::Sqrt(static_cast<float>(scenario.numTargets))), 1);
+		for (int32 i = 0; i < scenario.numTargets; ++i)
+		{
+			const FVector location((i / targetsPerRow) * ActorSpacing, (i % targetsPerRow) * ActorSpacing, 0.0f);
+			ARuneBenchmarkTarget* target = world.SpawnActor<ARuneBenchmarkTarget>(location, FRotator::ZeroRotator, spawnParameters);
+			target->Tags.Add(URuneBenchmarkFilter::GetBenchmarkTag(i % numTags));
+			outTargets.Add(target);
+		}
+
+		ARuneBenchmarkAgent::SetupScenario(outTargets, scenario.agentLifetime);
+		URuneBenchmarkBehaviour::SetTargets(outTargets);
+
+		// casters share a filter, as characters of the same faction would
+		URuneBenchmarkFilter* runeFilter = NewObject<URuneBenchmarkFilter>(&world);
+		runeFilter->Setup(scenario.filterShape, scenario.filterEntries, URuneBenchmarkEffect::StaticClass());
+
+		for (int32 i = 0; i < scenario.numCasters; ++i)
+		{
+			const FVector location(-ActorSpacing, i * ActorSpacing, 0.0f);
+			ARuneBenchmarkCaster* caster = world.SpawnActor<ARuneBenchmarkCaster>(location, FRotator::ZeroRotator, spawnParameters);
+			caster->runeFilter = runeFilter;
+			for (int32 j = 0; j < scenario.numRunesPerCaster; ++j)
+			{
+				outRunes.Add(RuneBenchmarkWorld::CreateRune(*caster, scenario));
+			}
+		}
+	}
+
+	/**
+	 * Presses and releases the runes that cast in a frame. Runes are staggered by their index.
+	 *
+	 * @param runes Runes of the scenario
+	 * @param frame Frame, warmup included
+	 * @param castInterval Frames between two casts of the same rune
+	 */
+	void DriveRunes(TConstArrayView<URuneBaseComponent*> runes, int32 frame, int32 castInterval)
+	{
+		for (int32 i = 0; i < runes.Num(); ++i)
+		{
+			const int32 castFrame = (frame + i) % castInterval;
+			if (castFrame == 0)
+			{
+				runes[i]->Press();
+			}
+			else if (castFrame == 1)
+			{
+				runes[i]->Release();
+			}
+		}
+	}
+
+	FScenarioReport RunScenario(const FRuneBenchmarkScenario& scenario, int32 seed)
+	{
+		UE_LOG(LogTemp, Display, TEXT("[URuneBenchmarkCommandlet] RunScenario(): %s, %d frames"), *scenario.name, scenario.frames);
+
+		FMath::RandInit(seed);
+		FMath::SRandInit(seed);
+
+		UWorld* world = RuneBenchmarkWorld::CreateWorld();
+
+		TArray<URuneBaseComponent*> runes;
+		TArray<AActor*> targets;
+		SpawnScenario(*world, scenario, runes, targets);
+
+		// a press and a release are needed per cast
+		const int32 castInterval = FMath::Max(scenario.castInterval, 2);
+		int32 frame = 0;
+		for (; frame < scenario.warmupFrames; ++frame)
+		{
+			DriveRunes(runes, frame, castInterval);
+			RuneBenchmarkWorld::TickWorld(*world);
+		}
+
+		FMetric frameMetric{ TEXT("Frame"), TEXT("ms") };
+		FMetric phaseMetrics[FRuneProfiler::NumPhases];
+		for (int32 i = 0; i < FRuneProfiler::NumPhases; ++i)
+		{
+			phaseMetrics[i].name = FRuneProfiler::GetPhaseName(static_cast<ERuneProfilePhase>(i));
+			phaseMetrics[i].unit = TEXT("ms");
+		}
+		FMetric allocationsMetric{ TEXT("Allocations"), TEXT("count") };
+		FMetric allocatedBytesMetric{ TEXT("AllocatedBytes"), TEXT("bytes") };
+
+		FRuneProfiler::Reset();
+		FRuneProfiler::SetEnabled(true);
+		URuneBenchmarkEffect::numApplications = 0;
+		{
+			FRuneScopedBenchmarkMalloc countingMalloc;
+			uint64 lastCycles[FRuneProfiler::NumPhases] = {};
+			for (int32 i = 0; i < scenario.frames; ++i, ++frame)
+			{
+				const uint64 numAllocations = countingMalloc.Get().GetNumAllocations();
+				const uint64 allocatedBytes = countingMalloc.Get().GetAllocatedBytes();
+				const uint64 startCycles = FPlatformTime::Cycles64();
+
+				DriveRunes(runes, frame, castInterval);
+				RuneBenchmarkWorld::TickWorld(*world);
+
+				frameMetric.samples.Add(FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - startCycles));
+				allocationsMetric.samples.Add(static_cast<double>(countingMalloc.Get().GetNumAllocations() - numAllocations));
+				allocatedBytesMetric.samples.Add(static_cast<double>(countingMalloc.Get().GetAllocatedBytes() - allocatedBytes));
+				for (int32 j = 0; j < FRuneProfiler::NumPhases; ++j)
+				{
+					const uint64 cycles = FRuneProfiler::GetCycles(static_cast<ERuneProfilePhase>(j));
+					phaseMetrics[j].samples.Add(FPlatformTime::ToMilliseconds64(cycles - lastCycles[j]));
+					lastCycles[j] = cycles;
+				}
+			}
+		}
+		FRuneProfiler::SetEnabled(false);
+
+		FScenarioReport report;
+		report.name = scenario.name;
+		report.frames = scenario.frames;
+		report.effectApplications = URuneBenchmarkEffect::numApplications;
+
+		// every way of applying effects should be instrumented, or the phase would read ~0 ms
+		report.isEffectApplyTimed = report.effectApplications == 0 || FRuneProfiler::GetCycles(ERuneProfilePhase::EFFECT_APPLY) > 0;
+		if (!report.isEffectApplyTimed)
+		{
+			UE_LOG(LogTemp, Error, TEXT("[URuneBenchmarkCommandlet] RunScenario(): %s applied %llu effects outside of the EffectApply phase"), *scenario.name, report.effectApplications);
+		}
+		report.metrics.Add(Summarize(frameMetric));
+		for (const FMetric& phaseMetric : phaseMetrics)
+		{
+			report.metrics.Add(Summarize(phaseMetric));
+		}
+		report.metrics.Add(Summarize(allocationsMetric));
+		report.metrics.Add(Summarize(allocatedBytesMetric));
+
+		ARuneBenchmarkAgent::SetupScenario({}, scenario.agentLifetime);
+		URuneBenchmarkBehaviour::SetTargets({});
+		RuneBenchmarkWorld::DestroyWorld(world);
+
+		return report;
+	}
+
+	bool WriteCsv(const FString& path, TConstArrayView<FScenarioReport> reports)
+	{
+		FString csv = TEXT("Scenario,Metric,Unit,Mean,P50,P99\n");
+		for (const FScenarioReport& report : reports)
+		{
+			for (const FMetricSummary& metric : report.metrics)
+			{
+				csv += FString::Printf(TEXT("%s,%s,%s,%.6f,%.6f,%.6f\n"), *report.name, *metric.name, *metric.unit, metric.mean, metric.p50, metric.p99);
+			}
+		}
+		return FFileHelper::SaveStringToFile(csv, *path);
+	}
+
+	bool WriteJson(const FString& path, TConstArrayView<FScenarioReport> reports, int32 seed)
+	{
+		FString json;
+		TSharedRef<TJsonWriter<>> writer = TJsonWriterFactory<>::Create(&json);
+		writer->WriteObjectStart();
+		writer->WriteValue(TEXT("seed"), seed);
+		writer->WriteValue(TEXT("deltaTime"), RuneBenchmarkWorld::FixedDeltaTime);
+		writer->WriteArrayStart(TEXT("scenarios"));
+		for (const FScenarioReport& report : reports)
+		{
+			writer->WriteObjectStart();
+			writer->WriteValue(TEXT("name"), report.name);
+			writer->WriteValue(TEXT("frames"), report.frames);
+			writer->WriteValue(TEXT("effectApplications"), static_cast<int64>(report.effectApplications));
+			writer->WriteArrayStart(TEXT("metrics"));
+			for (const FMetricSummary& metric : report.metrics)
+			{
+				writer->WriteObjectStart();
+				writer->WriteValue(TEXT("name"), metric.name);
+				writer->WriteValue(TEXT("unit"), metric.unit);
+				writer->WriteValue(TEXT("mean"), metric.mean);
+				writer->WriteValue(TEXT("p50"), metric.p50);
+				writer->WriteValue(TEXT("p99"), metric.p99);
+				writer->WriteObjectEnd();
+			}
+			writer->WriteArrayEnd();
+			writer->WriteObjectEnd();
+		}
+		writer->WriteArrayEnd();
+		writer->WriteObjectEnd();
+		writer->Close();
+
+		return FFileHelper::SaveStringToFile(json, *path);
+	}
+
+	/**
+	 * Runs the micro-benchmarks, then compares them with a baseline if there is one.
+	 *
+	 * @param Params Parameters of the commandlet
+	 * @param outputDirectory Where the results are written
+	 * @return Exit code, 1 if any micro-benchmark regressed
+	 */
+	int32 RunMicroBenchmarks(const FString& Params, const FString& outputDirectory)
+	{
+		int32 opsPerBatch = FRuneMicroBenchmarks::DefaultOpsPerBatch;
+		FParse::Value(*Params, TEXT("ops="), opsPerBatch);
+		int32 numBatches = FRuneMicroBenchmarks::DefaultNumBatches;
+		FParse::Value(*Params, TEXT("batches="), numBatches);
+
+		const TArray<FRuneMicroBenchmarkResult> results = FRuneMicroBenchmarks(opsPerBatch, numBatches).RunAll();
+
+		IFileManager::Get().MakeDirectory(*outputDirectory, true);
+		const FString resultsPath = outputDirectory / TEXT("RuneMicroBenchmarks.json");
+		if (!FRuneMicroBenchmarks::SaveResults(resultsPath, results))
+		{
+			UE_LOG(LogTemp, Error, TEXT("[URuneBenchmarkCommandlet] RunMicroBenchmarks(): could not write the results to %s"), *resultsPath);
+			return 1;
+		}
+		UE_LOG(LogTemp, Display, TEXT("[URuneBenchmarkCommandlet] RunMicroBenchmarks(): results written to %s"), *resultsPath);
+
+		FString baselinePath;
+		if (!FParse::Value(*Params, TEXT("baseline="), baselinePath)) return 0;
+
+		// the current results become the baseline of the next runs
+		if (FParse::Param(*Params, TEXT("updatebaseline")))
+		{
+			if (!FRuneMicroBenchmarks::SaveResults(baselinePath, results))
+			{
+				UE_LOG(LogTemp, Error, TEXT("[URuneBenchmarkCommandlet] RunMicroBenchmarks(): could not write the baseline to %s"), *baselinePath);
+				return 1;
+			}
+			UE_LOG(LogTemp, Display, TEXT("[URuneBenchmarkCommandlet] RunMicroBenchmarks(): baseline written to %s"), *baselinePath);
+			return 0;
+		}
+
+		TArray<FRuneMicroBenchmarkResult> baseline;
+		if (!FRuneMicroBenchmarks::LoadResults(baselinePath, baseline))
+		{
+			UE_LOG(LogTemp, Error, TEXT("[URuneBenchmarkCommandlet] RunMicroBenchmarks(): could not read the baseline %s"), *baselinePath);
+			return 1;
+		}
+
+		double threshold = FRuneMicroBenchmarks::DefaultRegressionThreshold;
+		FParse::Value(*Params, TEXT("threshold="), threshold);
+
+		const int32 numRegressions = FRuneMicroBenchmarks::CompareWithBaseline(results, baseline, threshold);
+		if (numRegressions > 0)
+		{
+			UE_LOG(LogTemp, Error, TEXT("[URuneBenchmarkCommandlet] RunMicroBenchmarks(): %d regressions over %.0f%% against %s"), numRegressions, threshold * 100.0, *baselinePath);
+			return 1;
+		}
+
+		UE_LOG(LogTemp, Display, TEXT("[URuneBenchmarkCommandlet] RunMicroBenchmarks(): no regression over %.0f%% against %s"), threshold * 100.0, *baselinePath);
+		return 0;
+	}
+}
+
+URuneBenchmarkCommandlet::URuneBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+	ShowErrorCount = true;
+}
+
+int32 URuneBenchmarkCommandlet::Main(const FString& Params)
+{
+	using namespace RuneBenchmarkCommandlet;
+
+	FString outputDirectory = FPaths::ProjectSavedDir() / TEXT("RuneBenchmark");
+	FParse::Value(*Params, TEXT("output="), outputDirectory);
+
+	if (FParse::Param(*Params, TEXT("micro"))) return RunMicroBenchmarks(Params, outputDirectory);
+
+	TArray<FRuneBenchmarkScenario> scenarios;
+	FString scenariosPath;
+	if (FParse::Value(*Params, TEXT("scenarios="), scenariosPath))
+	{
+		if (!LoadScenarios(scenariosPath, scenarios)) return 1;
+	}
+	else
+	{
+		scenarios = GetBuiltInScenarios();
+	}
+
+	FString scenarioNames;
+	if (FParse::Value(*Params, TEXT("scenario="), scenarioNames))
+	{
+		TArray<FString> selectedNames;
+		scenarioNames.ParseIntoArray(selectedNames, TEXT("+"));
+		scenarios.RemoveAll([&selectedNames](const FRuneBenchmarkScenario& scenario) { return !selectedNames.Contains(scenario.name); });
+	}
+
+	int32 frames = 0;
+	if (FParse::Value(*Params, TEXT("frames="), frames) && frames > 0)
+	{
+		for (FRuneBenchmarkScenario& scenario : scenarios)
+		{
+			scenario.frames = frames;
+		}
+	}
+
+	int32 seed = DefaultSeed;
+	FParse::Value(*Params, TEXT("seed="), seed);
+
+	if (scenarios.IsEmpty())
+	{
+		UE_LOG(LogTemp, Error, TEXT("[URuneBenchmarkCommandlet] Main(): no scenario to run"));
+		return 1;
+	}
+
+	TArray<FScenarioReport> reports;
+	for (const FRuneBenchmarkScenario& scenario : scenarios)
+	{
+		reports.Add(RunScenario(scenario, seed));
+	}
+
+	IFileManager::Get().MakeDirectory(*outputDirectory, true);
+	const FString csvPath = outputDirectory / TEXT("RuneBenchmark.csv");
+	const FString jsonPath = outputDirectory / TEXT("RuneBenchmark.json");
+	if (!WriteCsv(csvPath, reports) || !WriteJson(jsonPath, reports, seed))
+	{
+		UE_LOG(LogTemp, Error, TEXT("[URuneBenchmarkCommandlet] Main(): could not write the reports to %s"), *outputDirectory);
+		return 1;
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("[URuneBenchmarkCommandlet] Main(): reports written to %s and %s"), *csvPath, *jsonPath);
+
+	// phases missing applications make the reports misleading
+	const bool areEffectAppliesTimed = Algo::AllOf(reports, [](const FScenarioReport& report) { return report.isEffectApplyTimed; });
+	return areEffectAppliesTimed ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "RuneEffect.h"
+#include "RuneBenchmarkActors.h"
+#include "RuneBenchmarkCommandlet.generated.h"
+
+
+/**
+ * Scripted scenario of the rune benchmark.
+ * Can be read from a JSON file, as an array of scenarios with the same field names.
+ */
+USTRUCT()
+struct FRuneBenchmarkScenario
+{
+	GENERATED_BODY()
+
+	FRuneBenchmarkScenario();
+
+	/** Name of the scenario, used to select it and in the reports */
+	UPROPERTY()
+	FString name;
+
+	/** Actors casting runes */
+	UPROPERTY()
+	int32 numCasters;
+
+	/** Runes of every caster */
+	UPROPERTY()
+	int32 numRunesPerCaster;
+
+	/** What the behaviours of the runes do when cast */
+	UPROPERTY()
+	ERuneBenchmarkBehaviourMode behaviourMode;
+
+	/** Agents spawned per cast, by SPAWN_AGENTS behaviours */
+	UPROPERTY()
+	int32 agentsPerCast;
+
+	/** Time - in seconds - agents live before being released */
+	UPROPERTY()
+	float agentLifetime;
+
+	/** Effects bound to every behaviour */
+	UPROPERTY()
+	int32 numEffects;
+
+	/** Type of application of the effects */
+	UPROPERTY()
+	EApplicationType applicationType;
+
+	/** Duration - in seconds - of OVER_TIME and STATUS effects */
+	UPROPERTY()
+	float effectDuration;
+
+	/** Ticks of OVER_TIME effects */
+	UPROPERTY()
+	int32 effectTicks;
+
+	/** Actors the effects are applied to */
+	UPROPERTY()
+	int32 numTargets;
+
+	/** Shape of the filter of the casters */
+	UPROPERTY()
+	ERuneBenchmarkFilterShape filterShape;
+
+	/** Tags or classes per faction of the filter */
+	UPROPERTY()
+	int32 filterEntries;
+
+	/** Frames between two casts of the same rune. Runes are staggered so that they do not all cast at once */
+	UPROPERTY()
+	int32 castInterval;
+
+	/** Frames run before measuring, to fill the agent pools and the effect subsystems */
+	UPROPERTY()
+	int32 warmupFrames;
+
+	/** Frames measured */
+	UPROPERTY()
+	int32 frames;
+};
+
+/**
+ * Runs rune scenarios headlessly for a fixed number of frames, with a fixed delta time and seed,
+ * and reports the time spent in each phase of the rune pipeline and the allocations made per frame.
+ *
+ * Usage: UnrealEditor-Cmd <Project> -run=RuneBenchmark -nullrhi -unattended
+ *   -scenario=<Name>[+<Name>...]	Runs some of the scenarios only. Runs all of them by default.
+ *   -scenarios=<File.json>			Reads the scenarios from a file instead of the built-in ones.
+ *   -output=<Directory>			Where the CSV and JSON reports are written. Saved/RuneBenchmark by default.
+ *   -frames=<N>					Overrides the measured frames of every scenario.
+ *   -seed=<N>						Seed of the random streams, fixed by default.
+ * Fails if a scenario applies effects outside of the EffectApply phase, which would then read ~0 ms.
+ *
+ * With -micro, runs the micro-benchmarks of FRuneMicroBenchmarks instead, reporting ns/op and allocs/op:
+ *   -ops=<N> -batches=<N>			Operations per timed batch, and timed batches. 1000 and 50 by default.
+ *   -baseline=<File.json>			Compares the results with a baseline, failing on regressions.
+ *   -threshold=<Ratio>				Ratio over the baseline allowed before regressing. 0.1 by default.
+ *   -updatebaseline				Writes the results to the baseline instead of comparing them.
+ * The RuneSystem.Benchmark.Micro.RunAll automation test compares them with the baseline set in rune.Benchmark.Micro.Baseline as well.
+ */
+UCLASS()
+class URuneBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	URuneBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
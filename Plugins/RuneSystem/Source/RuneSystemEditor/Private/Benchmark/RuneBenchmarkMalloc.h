@@ -0,0 +1,116 @@
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/MemoryBase.h"
+#include <atomic>
+
+
+/**
+ * Allocator forwarding to GMalloc while counting allocations and allocated bytes.
+ * Installed in GMalloc only while a benchmark runs. Memory can be freed by either allocator,
+ * as both end up in the same one.
+ */
+class FRuneBenchmarkMalloc final : public FMalloc
+{
+public:
+	explicit FRuneBenchmarkMalloc(FMalloc* inInnerMalloc) :
+		innerMalloc(inInnerMalloc),
+		numAllocations(0),
+		allocatedBytes(0)
+	{
+	}
+
+	virtual void* Malloc(SIZE_T count, uint32 alignment) override
+	{
+		Count(count);
+		return innerMalloc->Malloc(count, alignment);
+	}
+
+	virtual void* TryMalloc(SIZE_T count, uint32 alignment) override
+	{
+		Count(count);
+		return innerMalloc->TryMalloc(count, alignment);
+	}
+
+	virtual void* Realloc(void* original, SIZE_T count, uint32 alignment) override
+	{
+		// only growing an allocation, or creating one, allocates
+		if (IsGrowing(original, count))
+		{
+			Count(count);
+		}
+		return innerMalloc->Realloc(original, count, alignment);
+	}
+
+	virtual void* TryRealloc(void* original, SIZE_T count, uint32 alignment) override
+	{
+		if (IsGrowing(original, count))
+		{
+			Count(count);
+		}
+		return innerMalloc->TryRealloc(original, count, alignment);
+	}
+
+	virtual void Free(void* original) override { innerMalloc->Free(original); };
+	virtual SIZE_T QuantizeSize(SIZE_T count, uint32 alignment) override { return innerMalloc->QuantizeSize(count, alignment); };
+	virtual bool GetAllocationSize(void* original, SIZE_T& sizeOut) override { return innerMalloc->GetAllocationSize(original, sizeOut); };
+	virtual void Trim(bool trimThreadCaches) override { innerMalloc->Trim(trimThreadCaches); };
+	virtual void SetupTLSCachesOnCurrentThread() override { innerMalloc->SetupTLSCachesOnCurrentThread(); };
+	virtual void ClearAndDisableTLSCachesOnCurrentThread() override { innerMalloc->ClearAndDisableTLSCachesOnCurrentThread(); };
+	virtual void InitializeStatsMetadata() override { innerMalloc->InitializeStatsMetadata(); };
+	virtual void GetAllocatorStats(FGenericMemoryStats& outStats) override { innerMalloc->GetAllocatorStats(outStats); };
+	virtual void DumpAllocatorStats(FOutputDevice& ar) override { innerMalloc->DumpAllocatorStats(ar); };
+	virtual bool IsInternallyThreadSafe() const override { return innerMalloc->IsInternallyThreadSafe(); };
+	virtual bool ValidateHeap() override { return innerMalloc->ValidateHeap(); };
+	virtual const TCHAR* GetDescriptiveName() override { return TEXT("RuneBenchmarkMalloc"); };
+
+	/** Allocations since installed, from every thread */
+	uint64 GetNumAllocations() const { return numAllocations.load(std::memory_order_relaxed); };
+
+	/** Bytes requested since installed, from every thread */
+	uint64 GetAllocatedBytes() const { return allocatedBytes.load(std::memory_order_relaxed); };
+
+	FMalloc* GetInnerMalloc() const { return innerMalloc; };
+
+private:
+	bool IsGrowing(void* original, SIZE_T count) const
+	{
+		SIZE_T size = 0;
+		return original == nullptr || !innerMalloc->GetAllocationSize(original, size) || count > size;
+	}
+
+	void Count(SIZE_T count)
+	{
+		numAllocations.fetch_add(1, std::memory_order_relaxed);
+		allocatedBytes.fetch_add(count, std::memory_order_relaxed);
+	}
+
+	/** Allocator everything is forwarded to */
+	FMalloc* innerMalloc;
+
+	std::atomic<uint64> numAllocations;
+	std::atomic<uint64> allocatedBytes;
+};
+
+/** Installs a counting allocator in GMalloc until going out of scope */
+class FRuneScopedBenchmarkMalloc
+{
+public:
+	FRuneScopedBenchmarkMalloc() :
+		countingMalloc(GMalloc)
+	{
+		GMalloc = &countingMalloc;
+	}
+
+	~FRuneScopedBenchmarkMalloc()
+	{
+		GMalloc = countingMalloc.GetInnerMalloc();
+	}
+
+	const FRuneBenchmarkMalloc& Get() const { return countingMalloc; };
+
+private:
+	FRuneBenchmarkMalloc countingMalloc;
+};
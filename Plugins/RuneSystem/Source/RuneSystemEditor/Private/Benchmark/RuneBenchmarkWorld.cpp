@@ -0,0 +1,71 @@
+
+
+#include "RuneBenchmarkWorld.h"
+#include "RuneBenchmarkActors.h"
+#include "RuneBenchmarkCommandlet.h"
+#include "RuneBaseComponent.h"
+#include "CastStateMachines/RuneNativeCastStateMachines.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "UObject/UObjectGlobals.h"
+
+
+UWorld* RuneBenchmarkWorld::CreateWorld()
+{
+	UWorld* world = UWorld::CreateWorld(EWorldType::Game, false, TEXT("RuneBenchmark"));
+	FWorldContext& worldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	worldContext.SetCurrentWorld(world);
+
+	const FURL url;
+	world->SetGameMode(url);
+	world->InitializeActorsForPlay(url);
+	world->BeginPlay();
+	return world;
+}
+
+void RuneBenchmarkWorld::DestroyWorld(UWorld* world)
+{
+	world->EndPlay(EEndPlayReason::Quit);
+	GEngine->DestroyWorldContext(world);
+	world->DestroyWorld(false);
+
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+}
+
+void RuneBenchmarkWorld::TickWorld(UWorld& world)
+{
+	world.Tick(LEVELTICK_All, FixedDeltaTime);
+	++GFrameCounter;
+}
+
+URuneBaseComponent* RuneBenchmarkWorld::CreateRune(ARuneBenchmarkCaster& caster, const FRuneBenchmarkScenario& scenario)
+{
+	URuneInstantCastStateMachine* castStateMachine = NewObject<URuneInstantCastStateMachine>(&caster);
+	castStateMachine->RegisterComponent();
+
+	URuneBenchmarkBehaviour* behaviour = NewObject<URuneBenchmarkBehaviour>(&caster);
+	behaviour->mode = scenario.behaviourMode;
+	behaviour->agentsPerActivation = scenario.agentsPerCast;
+	behaviour->RegisterComponent();
+
+	FRuneBehaviourWithEffects behaviourWithEffects;
+	behaviourWithEffects.runeBehaviour = behaviour;
+	for (int32 i = 0; i < scenario.numEffects; ++i)
+	{
+		URuneBenchmarkEffect* effect = NewObject<URuneBenchmarkEffect>(&caster);
+		effect->applicationType = scenario.applicationType;
+		effect->duration = scenario.effectDuration;
+		effect->ticks = FMath::Max(scenario.effectTicks, 0);
+		behaviourWithEffects.runeEffects.Add(effect);
+	}
+
+	// configured and validated once registered
+	URuneBaseComponent* rune = NewObject<URuneBaseComponent>(&caster);
+	FRuneConfiguration& runeConfiguration = rune->runeConfigurations.AddDefaulted_GetRef();
+	runeConfiguration.runeCastStateMachine = castStateMachine;
+	runeConfiguration.runeBehavioursWithEffects.Add(behaviourWithEffects);
+	rune->runeTasks.Add(nullptr);
+	rune->SetOwner(&caster);
+	rune->RegisterComponent();
+	return rune;
+}
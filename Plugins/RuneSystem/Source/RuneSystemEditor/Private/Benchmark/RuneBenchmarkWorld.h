@@ -0,0 +1,50 @@
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class ARuneBenchmarkCaster;
+class URuneBaseComponent;
+struct FRuneBenchmarkScenario;
+
+
+/**
+ * World and rune setup shared by the benchmark scenarios and micro-benchmarks.
+ */
+namespace RuneBenchmarkWorld
+{
+	/** Delta time - in seconds - of every frame, so that runs are deterministic */
+	constexpr float FixedDeltaTime = 1.0f / 60.0f;
+
+	/**
+	 * Creates a game world with no map, already begun play.
+	 *
+	 * @return Created world, to be destroyed with DestroyWorld()
+	 */
+	UWorld* CreateWorld();
+
+	/**
+	 * Destroys a world created by CreateWorld(), then collects garbage.
+	 *
+	 * @param world Destroyed world
+	 */
+	void DestroyWorld(UWorld* world);
+
+	/**
+	 * Ticks a world for a frame of FixedDeltaTime.
+	 *
+	 * @param world Ticked world
+	 */
+	void TickWorld(UWorld& world);
+
+	/**
+	 * Creates a rune with a single instant cast configuration, following the scenario settings.
+	 * Its cast state machine, behaviour and effects are created in the caster as well.
+	 *
+	 * @param caster Owner of the rune, with its filter already set
+	 * @param scenario Settings of the behaviour and the effects
+	 * @return Created rune, already registered
+	 */
+	URuneBaseComponent* CreateRune(ARuneBenchmarkCaster& caster, const FRuneBenchmarkScenario& scenario);
+}
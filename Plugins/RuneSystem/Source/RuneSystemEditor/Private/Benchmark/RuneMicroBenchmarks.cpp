@@ -0,0 +1,319 @@
+
+
+#include "RuneMicroBenchmarks.h"
+#include "RuneBenchmarkActors.h"
+#include "RuneBenchmarkCommandlet.h"
+#include "RuneBenchmarkMalloc.h"
+#include "RuneBenchmarkWorld.h"
+#include "RuneBaseComponent.h"
+#include "Engine/World.h"
+#include "Dom/JsonObject.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+
+namespace RuneMicroBenchmarks
+{
+	/** Tags or classes per faction of the benchmarked filters */
+	constexpr int32 FilterEntries = 32;
+
+	/** Targets the filters are run against, half of them matching */
+	constexpr int32 NumFilterTargets = 64;
+
+	/** Linked effects of every pulse micro-benchmark */
+	constexpr int32 PulseEffectCounts[] = { 1, 2, 4, 8, 16, 32 };
+
+	/** Effects attached by the attachment micro-benchmark */
+	constexpr int32 NumAttachedEffects = 8;
+
+	/** Allocations per operation always allowed over the baseline, so that rare allocations do not regress */
+	constexpr double AllocsTolerance = 0.01;
+
+	/**
+	 * Spawns a caster with a single rune.
+	 *
+	 * @param world World of the micro-benchmark
+	 * @param shape Shape of the filter of the caster
+	 * @param numEffects Effects linked to the behaviour of the rune
+	 * @return Behaviour of the rune
+	 */
+	URuneBenchmarkBehaviour* SpawnCaster(UWorld& world, ERuneBenchmarkFilterShape shape, int32 numEffects)
+	{
+		URuneBenchmarkFilter* runeFilter = NewObject<URuneBenchmarkFilter>(&world);
+		runeFilter->Setup(shape, FilterEntries, URuneBenchmarkEffect::StaticClass());
+
+		ARuneBenchmarkCaster* caster = world.SpawnActor<ARuneBenchmarkCaster>();
+		caster->runeFilter = runeFilter;
+
+		FRuneBenchmarkScenario scenario;
+		scenario.numEffects = numEffects;
+		const URuneBaseComponent* rune = RuneBenchmarkWorld::CreateRune(*caster, scenario);
+		return CastChecked<URuneBenchmarkBehaviour>(rune->runeConfigurations[0].runeBehavioursWithEffects[0].runeBehaviour);
+	}
+
+	/** Sets a boolean console variable for the lifetime of the scope, restoring its value afterwards */
+	class FScopedConsoleVariable
+	{
+	public:
+		FScopedConsoleVariable(const TCHAR* name, bool value) :
+			variable(IConsoleManager::Get().FindConsoleVariable(name)),
+			previousValue(variable != nullptr && variable->GetBool())
+		{
+			if (variable != nullptr)
+			{
+				variable->Set(value, ECVF_SetByCode);
+			}
+		}
+
+		~FScopedConsoleVariable()
+		{
+			if (variable != nullptr)
+			{
+				variable->Set(previousValue, ECVF_SetByCode);
+			}
+		}
+
+	private:
+		IConsoleVariable* variable;
+		bool previousValue;
+	};
+
+	TSharedRef<FJsonObject> ToJson(const FRuneMicroBenchmarkResult& result)
+	{
+		TSharedRef<FJsonObject> jsonObject = MakeShared<FJsonObject>();
+		jsonObject->SetStringField(TEXT("name"), result.name);
+		jsonObject->SetNumberField(TEXT("nsPerOp"), result.nsPerOp);
+		jsonObject->SetNumberField(TEXT("allocsPerOp"), result.allocsPerOp);
+		return jsonObject;
+	}
+}
+
+FRuneMicroBenchmarks::FRuneMicroBenchmarks(int32 inOpsPerBatch, int32 inNumBatches) :
+	opsPerBatch(FMath::Max(inOpsPerBatch, 1)),
+	numBatches(FMath::Max(inNumBatches, 1))
+{
+}
+
+TArray<FRuneMicroBenchmarkResult> FRuneMicroBenchmarks::RunAll() const
+{
+	TArray<FRuneMicroBenchmarkResult> results;
+	RunFilterBenchmarks(results);
+	RunPulseBenchmarks(results);
+	RunAttachEffectsBenchmark(results);
+	RunSpawnBenchmark(results);
+	return results;
+}
+
+template <typename OpType>
+FRuneMicroBenchmarkResult FRuneMicroBenchmarks::Measure(const FString& name, OpType&& op) const
+{
+	// warms up caches and pools
+	for (int32 i = 0; i < opsPerBatch; ++i)
+	{
+		op(i);
+	}
+
+	TArray<double> batchNsPerOp;
+	batchNsPerOp.Reserve(numBatches);
+
+	FRuneMicroBenchmarkResult result;
+	result.name = name;
+	{
+		FRuneScopedBenchmarkMalloc countingMalloc;
+		for (int32 batch = 0; batch < numBatches; ++batch)
+		{
+			const uint64 startCycles = FPlatformTime::Cycles64();
+			for (int32 i = 0; i < opsPerBatch; ++i)
+			{
+				op(i);
+			}
+			const double batchSeconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - startCycles);
+			batchNsPerOp.Add(batchSeconds * 1e9 / opsPerBatch);
+		}
+		result.allocsPerOp = static_cast<double>(countingMalloc.Get().GetNumAllocations()) / (static_cast<double>(numBatches) * opsPerBatch);
+	}
+
+	// the median ignores batches interrupted by the OS
+	batchNsPerOp.Sort();
+	result.nsPerOp = batchNsPerOp[batchNsPerOp.Num() / 2];
+
+	UE_LOG(LogTemp, Display, TEXT("[FRuneMicroBenchmarks] Measure(): %s %.1f ns/op, %.2f allocs/op"), *result.name, result.nsPerOp, result.allocsPerOp);
+	return result;
+}
+
+void FRuneMicroBenchmarks::RunFilterBenchmarks(TArray<FRuneMicroBenchmarkResult>& outResults) const
+{
+	using namespace RuneMicroBenchmarks;
+
+	// every operation filters the same targets again, cached verdicts would only measure cache hits
+	const FScopedConsoleVariable disableFilterCache(TEXT("rune.FilterCache.Enabled"), false);
+
+	UWorld* world = RuneBenchmarkWorld::CreateWorld();
+
+	TArray<const AActor*> targets;
+	for (int32 i = 0; i < NumFilterTargets; ++i)
+	{
+		ARuneBenchmarkTarget* target = world->SpawnActor<ARuneBenchmarkTarget>();
+		target->Tags.Add(URuneBenchmarkFilter::GetBenchmarkTag(i % (FilterEntries * 2)));
+		targets.Add(target);
+	}
+
+	const ERuneBenchmarkFilterShape shapes[] = { ERuneBenchmarkFilterShape::TAG_HEAVY, ERuneBenchmarkFilterShape::CLASS_HEAVY, ERuneBenchmarkFilterShape::MANY_OVERRIDES };
+	for (ERuneBenchmarkFilterShape shape : shapes)
+	{
+		URuneBenchmarkFilter* runeFilter = NewObject<URuneBenchmarkFilter>(world);
+		runeFilter->Setup(shape, FilterEntries, URuneBenchmarkEffect::StaticClass());
+
+		const FString name = FString::Printf(TEXT("Filter.%s"), *StaticEnum<ERuneBenchmarkFilterShape>()->GetNameStringByValue(static_cast<int64>(shape)));
+		outResults.Add(Measure(name, [runeFilter, &targets](int32 i)
+		{
+			runeFilter->Filter(*targets[i % targets.Num()], URuneBenchmarkEffect::StaticClass());
+		}));
+	}
+
+	RuneBenchmarkWorld::DestroyWorld(world);
+}
+
+void FRuneMicroBenchmarks::RunPulseBenchmarks(TArray<FRuneMicroBenchmarkResult>& outResults) const
+{
+	using namespace RuneMicroBenchmarks;
+
+	UWorld* world = RuneBenchmarkWorld::CreateWorld();
+	AActor* target = world->SpawnActor<ARuneBenchmarkTarget>();
+
+	for (int32 numEffects : PulseEffectCounts)
+	{
+		const URuneBenchmarkBehaviour* behaviour = SpawnCaster(*world, ERuneBenchmarkFilterShape::NONE, numEffects);
+
+		const FString name = FString::Printf(TEXT("BroadcastApplyPulse.%dEffects"), numEffects);
+		outResults.Add(Measure(name, [behaviour, target](int32 i)
+		{
+			behaviour->PulseTarget(target);
+		}));
+	}
+
+	RuneBenchmarkWorld::DestroyWorld(world);
+}
+
+void FRuneMicroBenchmarks::RunAttachEffectsBenchmark(TArray<FRuneMicroBenchmarkResult>& outResults) const
+{
+	using namespace RuneMicroBenchmarks;
+
+	UWorld* world = RuneBenchmarkWorld::CreateWorld();
+	const URuneBenchmarkBehaviour* behaviour = SpawnCaster(*world, ERuneBenchmarkFilterShape::NONE, NumAttachedEffects);
+	ARuneBenchmarkAgent* agent = world->SpawnActor<ARuneBenchmarkAgent>();
+
+	// as passed from a blueprint
+	TArray<UObject*> runeEffects;
+	for (URuneEffect* runeEffect : behaviour->GetLinkedEffects())
+	{
+		runeEffects.Add(runeEffect);
+	}
+
+	const FString name = FString::Printf(TEXT("SetAttachedRuneEffects.%dEffects"), NumAttachedEffects);
+	outResults.Add(Measure(name, [agent, &runeEffects](int32 i)
+	{
+		agent->ClearAttachedRuneEffects();
+		agent->SetAttachedRuneEffects(runeEffects);
+	}));
+
+	RuneBenchmarkWorld::DestroyWorld(world);
+}
+
+void FRuneMicroBenchmarks::RunSpawnBenchmark(TArray<FRuneMicroBenchmarkResult>& outResults) const
+{
+	using namespace RuneMicroBenchmarks;
+
+	UWorld* world = RuneBenchmarkWorld::CreateWorld();
+	URuneBenchmarkBehaviour* behaviour = SpawnCaster(*world, ERuneBenchmarkFilterShape::NONE, 1);
+
+	FRuneTangibleAgentTemplate agentTemplate;
+	agentTemplate.agentClass = ARuneBenchmarkAgent::StaticClass();
+	agentTemplate.properties.Add(GET_MEMBER_NAME_CHECKED(ARuneBenchmarkAgent, speed), TEXT("1500.0"));
+	agentTemplate.InvalidatePropertyPlan();
+
+	// released right away, so that every spawn after the warmup reuses a pooled agent
+	const FTransform transform = FTransform::Identity;
+	outResults.Add(Measure(TEXT("SpawnTangibleAgent.Template"), [behaviour, &agentTemplate, &transform](int32 i)
+	{
+		ARuneTangibleAgent* agent = behaviour->SpawnAgent(agentTemplate, transform);
+		if (agent != nullptr)
+		{
+			agent->ReleaseAgent();
+		}
+	}));
+
+	RuneBenchmarkWorld::DestroyWorld(world);
+}
+
+int32 FRuneMicroBenchmarks::CompareWithBaseline(TConstArrayView<FRuneMicroBenchmarkResult> results, TConstArrayView<FRuneMicroBenchmarkResult> baseline, double threshold)
+{
+	int32 numRegressions = 0;
+	for (const FRuneMicroBenchmarkResult& result : results)
+	{
+		const FRuneMicroBenchmarkResult* baselineResult = baseline.FindByPredicate([&result](const FRuneMicroBenchmarkResult& other) { return other.name == result.name; });
+		if (baselineResult == nullptr)
+		{
+			UE_LOG(LogTemp, Display, TEXT("[FRuneMicroBenchmarks] CompareWithBaseline(): %s is not in the baseline, skipping it"), *result.name);
+			continue;
+		}
+
+		const double maxNsPerOp = baselineResult->nsPerOp * (1.0 + threshold);
+		const double maxAllocsPerOp = baselineResult->allocsPerOp * (1.0 + threshold) + RuneMicroBenchmarks::AllocsTolerance;
+		if (result.nsPerOp > maxNsPerOp)
+		{
+			UE_LOG(LogTemp, Error, TEXT("[FRuneMicroBenchmarks] CompareWithBaseline(): %s regressed, %.1f ns/op against %.1f in the baseline"), *result.name, result.nsPerOp, baselineResult->nsPerOp);
+			++numRegressions;
+		}
+		if (result.allocsPerOp > maxAllocsPerOp)
+		{
+			UE_LOG(LogTemp, Error, TEXT("[FRuneMicroBenchmarks] CompareWithBaseline(): %s regressed, %.2f allocs/op against %.2f in the baseline"), *result.name, result.allocsPerOp, baselineResult->allocsPerOp);
+			++numRegressions;
+		}
+	}
+	return numRegressions;
+}
+
+bool FRuneMicroBenchmarks::LoadResults(const FString& path, TArray<FRuneMicroBenchmarkResult>& outResults)
+{
+	FString json;
+	if (!FFileHelper::LoadFileToString(json, *path)) return false;
+
+	TSharedPtr<FJsonObject> jsonObject;
+	if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(json), jsonObject) || !jsonObject.IsValid()) return false;
+
+	const TArray<TSharedPtr<FJsonValue>>* jsonResults = nullptr;
+	if (!jsonObject->TryGetArrayField(TEXT("results"), jsonResults)) return false;
+
+	for (const TSharedPtr<FJsonValue>& jsonResult : *jsonResults)
+	{
+		const TSharedPtr<FJsonObject>* resultObject = nullptr;
+		if (!jsonResult->TryGetObject(resultObject)) continue;
+
+		FRuneMicroBenchmarkResult& result = outResults.AddDefaulted_GetRef();
+		(*resultObject)->TryGetStringField(TEXT("name"), result.name);
+		(*resultObject)->TryGetNumberField(TEXT("nsPerOp"), result.nsPerOp);
+		(*resultObject)->TryGetNumberField(TEXT("allocsPerOp"), result.allocsPerOp);
+	}
+	return true;
+}
+
+bool FRuneMicroBenchmarks::SaveResults(const FString& path, TConstArrayView<FRuneMicroBenchmarkResult> results)
+{
+	TArray<TSharedPtr<FJsonValue>> jsonResults;
+	for (const FRuneMicroBenchmarkResult& result : results)
+	{
+		jsonResults.Add(MakeShared<FJsonValueObject>(RuneMicroBenchmarks::ToJson(result)));
+	}
+
+	TSharedRef<FJsonObject> jsonObject = MakeShared<FJsonObject>();
+	jsonObject->SetArrayField(TEXT("results"), jsonResults);
+
+	FString json;
+	if (!FJsonSerializer::Serialize(jsonObject, TJsonWriterFactory<>::Create(&json))) return false;
+
+	return FFileHelper::SaveStringToFile(json, *path);
+}
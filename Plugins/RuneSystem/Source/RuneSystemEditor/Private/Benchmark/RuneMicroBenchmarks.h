@@ -0,0 +1,102 @@
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+/** Cost of a single operation of a micro-benchmark */
+struct FRuneMicroBenchmarkResult
+{
+	/** Name of the micro-benchmark, unique among them */
+	FString name;
+
+	/** Median time - in nanoseconds - per operation, over every batch */
+	double nsPerOp = 0.0;
+
+	/** Mean allocations per operation, over every batch */
+	double allocsPerOp = 0.0;
+};
+
+/**
+ * Micro-benchmarks of the hot paths of the rune pipeline:
+ * - URuneFilter::Filter(), for every filter shape, with the filter cache disabled.
+ * - URuneBehaviour::BroadcastApplyPulse(), with 1 to 32 linked effects.
+ * - ARuneTangibleAgent::SetAttachedRuneEffects().
+ * - URuneBehaviour::SpawnTangibleAgent() from a template, released right away to be reused.
+ *
+ * Every operation is run in batches, timed as a whole so that the timer does not weigh in.
+ * Run by the benchmark commandlet (-micro) and by the RuneSystem.Benchmark.Micro automation tests.
+ */
+class FRuneMicroBenchmarks
+{
+public:
+	/** Operations per timed batch when none is given */
+	static constexpr int32 DefaultOpsPerBatch = 1000;
+
+	/** Timed batches when none is given */
+	static constexpr int32 DefaultNumBatches = 50;
+
+	/** Ratio over the baseline allowed before regressing when none is given */
+	static constexpr double DefaultRegressionThreshold = 0.1;
+
+	/**
+	 * @param inOpsPerBatch Operations timed together
+	 * @param inNumBatches Batches measured, after a batch of warmup
+	 */
+	FRuneMicroBenchmarks(int32 inOpsPerBatch, int32 inNumBatches);
+
+	/**
+	 * Runs every micro-benchmark in its own world.
+	 *
+	 * @return Results, in run order
+	 */
+	TArray<FRuneMicroBenchmarkResult> RunAll() const;
+
+	/**
+	 * Compares results with a baseline, logging every regression.
+	 *
+	 * @param results Results of the current run
+	 * @param baseline Results of the baseline, micro-benchmarks missing from it are skipped
+	 * @param threshold Ratio over the baseline allowed before regressing (i.e. 0.1 for 10%)
+	 * @return Number of regressions
+	 */
+	static int32 CompareWithBaseline(TConstArrayView<FRuneMicroBenchmarkResult> results, TConstArrayView<FRuneMicroBenchmarkResult> baseline, double threshold);
+
+	/**
+	 * Reads results written by SaveResults().
+	 *
+	 * @param path Path of the JSON file
+	 * @param outResults Read results
+	 * @return If false, the file could not be read
+	 */
+	static bool LoadResults(const FString& path, TArray<FRuneMicroBenchmarkResult>& outResults);
+
+	/**
+	 * Writes results to a JSON file, to be used as a baseline.
+	 *
+	 * @param path Path of the JSON file
+	 * @param results Written results
+	 * @return If false, the file could not be written
+	 */
+	static bool SaveResults(const FString& path, TConstArrayView<FRuneMicroBenchmarkResult> results);
+
+private:
+	/**
+	 * Times an operation.
+	 *
+	 * @param name Name of the micro-benchmark
+	 * @param op Operation, called with its index in the batch
+	 * @return Cost of the operation
+	 */
+	template <typename OpType>
+	FRuneMicroBenchmarkResult Measure(const FString& name, OpType&& op) const;
+
+	void RunFilterBenchmarks(TArray<FRuneMicroBenchmarkResult>& outResults) const;
+	void RunPulseBenchmarks(TArray<FRuneMicroBenchmarkResult>& outResults) const;
+	void RunAttachEffectsBenchmark(TArray<FRuneMicroBenchmarkResult>& outResults) const;
+	void RunSpawnBenchmark(TArray<FRuneMicroBenchmarkResult>& outResults) const;
+
+	int32 opsPerBatch;
+	int32 numBatches;
+};
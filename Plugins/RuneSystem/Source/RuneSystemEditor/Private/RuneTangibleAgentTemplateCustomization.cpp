@@ -164,6 +164,9 @@ void FRuneTangibleAgentTemplateCustomization::OnAgentClassChanged(TSharedPtr<IPr
 				data->properties.Empty();
 			}
 
+			// templated properties are resolved against the agent class
+			data->InvalidatePropertyPlan();
+
 			if (prevObject != nullptr)
 			{
 				prevObject->Destroy();
@@ -200,6 +203,9 @@ void FRuneTangibleAgentTemplateCustomization::OnTemplatePropertyChanged(TSharedP
 	{
 		data->properties.Remove(inProperty->GetFName());
 	}
+
+	// compiled on next spawn
+	data->InvalidatePropertyPlan();
 }
 
 FRuneTangibleAgentTemplate* FRuneTangibleAgentTemplateCustomization::GetData()
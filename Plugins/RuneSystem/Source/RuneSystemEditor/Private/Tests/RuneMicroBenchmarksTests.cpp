@@ -0,0 +1,140 @@
+#include "Benchmark/RuneMicroBenchmarks.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+static TAutoConsoleVariable<FString> CVarRuneMicroBenchmarksBaseline(
+	TEXT("rune.Benchmark.Micro.Baseline"),
+	TEXT(""),
+	TEXT("Baseline the RuneSystem.Benchmark.Micro.RunAll test compares the micro-benchmarks with, as written by -run=RuneBenchmark -micro -updatebaseline. Relative to the project directory. If empty, results are not compared."));
+
+static TAutoConsoleVariable<float> CVarRuneMicroBenchmarksThreshold(
+	TEXT("rune.Benchmark.Micro.Threshold"),
+	static_cast<float>(FRuneMicroBenchmarks::DefaultRegressionThreshold),
+	TEXT("Ratio over the baseline allowed to each micro-benchmark before the RuneSystem.Benchmark.Micro.RunAll test fails."));
+
+namespace RuneMicroBenchmarksTests
+{
+	constexpr int32 TestFlags = EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter;
+
+	FRuneMicroBenchmarkResult MakeResult(const TCHAR* name, double nsPerOp, double allocsPerOp)
+	{
+		FRuneMicroBenchmarkResult result;
+		result.name = name;
+		result.nsPerOp = nsPerOp;
+		result.allocsPerOp = allocsPerOp;
+		return result;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRuneMicroBenchmarksCompareTest, "RuneSystem.Benchmark.Micro.CompareWithBaseline", RuneMicroBenchmarksTests::TestFlags)
+
+bool FRuneMicroBenchmarksCompareTest::RunTest(const FString& Parameters)
+{
+	using namespace RuneMicroBenchmarksTests;
+
+	const FRuneMicroBenchmarkResult baseline[] = { MakeResult(TEXT("Op"), 100.0, 1.0) };
+
+	const FRuneMicroBenchmarkResult withinThreshold[] = { MakeResult(TEXT("Op"), 105.0, 1.0) };
+	TestEqual(TEXT("Time within the threshold does not regress"), FRuneMicroBenchmarks::CompareWithBaseline(withinThreshold, baseline, 0.1), 0);
+
+	const FRuneMicroBenchmarkResult slower[] = { MakeResult(TEXT("Op"), 120.0, 1.0) };
+	TestEqual(TEXT("Time over the threshold regresses"), FRuneMicroBenchmarks::CompareWithBaseline(slower, baseline, 0.1), 1);
+
+	const FRuneMicroBenchmarkResult moreAllocs[] = { MakeResult(TEXT("Op"), 100.0, 2.0) };
+	TestEqual(TEXT("Allocations over the threshold regress"), FRuneMicroBenchmarks::CompareWithBaseline(moreAllocs, baseline, 0.1), 1);
+
+	const FRuneMicroBenchmarkResult slowerWithMoreAllocs[] = { MakeResult(TEXT("Op"), 120.0, 2.0) };
+	TestEqual(TEXT("Time and allocations regress separately"), FRuneMicroBenchmarks::CompareWithBaseline(slowerWithMoreAllocs, baseline, 0.1), 2);
+
+	const FRuneMicroBenchmarkResult missing[] = { MakeResult(TEXT("Other"), 1000.0, 10.0) };
+	TestEqual(TEXT("Results missing from the baseline are skipped"), FRuneMicroBenchmarks::CompareWithBaseline(missing, baseline, 0.1), 0);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRuneMicroBenchmarksSaveLoadTest, "RuneSystem.Benchmark.Micro.SaveAndLoadResults", RuneMicroBenchmarksTests::TestFlags)
+
+bool FRuneMicroBenchmarksSaveLoadTest::RunTest(const FString& Parameters)
+{
+	using namespace RuneMicroBenchmarksTests;
+
+	const FRuneMicroBenchmarkResult results[] = { MakeResult(TEXT("First"), 12.5, 0.0), MakeResult(TEXT("Second"), 250.0, 3.25) };
+	const FString path = FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("RuneMicroBenchmarksTest.json"));
+
+	if (!TestTrue(TEXT("Results are saved"), FRuneMicroBenchmarks::SaveResults(path, results))) return false;
+
+	TArray<FRuneMicroBenchmarkResult> loadedResults;
+	const bool isLoaded = FRuneMicroBenchmarks::LoadResults(path, loadedResults);
+	IFileManager::Get().Delete(*path);
+
+	if (!TestTrue(TEXT("Results are loaded"), isLoaded)) return false;
+	if (!TestEqual(TEXT("Every result is loaded"), loadedResults.Num(), static_cast<int32>(UE_ARRAY_COUNT(results)))) return false;
+
+	for (int32 i = 0; i < loadedResults.Num(); ++i)
+	{
+		TestEqual(TEXT("Name is kept"), loadedResults[i].name, results[i].name);
+		TestEqual(TEXT("Time is kept"), loadedResults[i].nsPerOp, results[i].nsPerOp);
+		TestEqual(TEXT("Allocations are kept"), loadedResults[i].allocsPerOp, results[i].allocsPerOp);
+	}
+
+	TArray<FRuneMicroBenchmarkResult> missingResults;
+	TestFalse(TEXT("Missing files are not loaded"), FRuneMicroBenchmarks::LoadResults(path, missingResults));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRuneMicroBenchmarksRunAllTest, "RuneSystem.Benchmark.Micro.RunAll", RuneMicroBenchmarksTests::TestFlags)
+
+bool FRuneMicroBenchmarksRunAllTest::RunTest(const FString& Parameters)
+{
+	TArray<FRuneMicroBenchmarkResult> baseline;
+	const FString baselinePath = CVarRuneMicroBenchmarksBaseline.GetValueOnGameThread();
+	if (!baselinePath.IsEmpty())
+	{
+		const FString fullBaselinePath = FPaths::IsRelative(baselinePath) ? FPaths::Combine(FPaths::ProjectDir(), baselinePath) : baselinePath;
+		if (!TestTrue(FString::Printf(TEXT("Baseline %s is loaded"), *fullBaselinePath), FRuneMicroBenchmarks::LoadResults(fullBaselinePath, baseline))) return false;
+	}
+
+	// results are only comparable with a baseline measured the same way, otherwise a few operations are enough to go through every hot path
+	const bool hasBaseline = baseline.Num() > 0;
+	const FRuneMicroBenchmarks microBenchmarks(hasBaseline ? FRuneMicroBenchmarks::DefaultOpsPerBatch : 8, hasBaseline ? FRuneMicroBenchmarks::DefaultNumBatches : 2);
+	const TArray<FRuneMicroBenchmarkResult> results = microBenchmarks.RunAll();
+
+	if (!TestTrue(TEXT("Micro-benchmarks have results"), results.Num() > 0)) return false;
+
+	TSet<FString> names;
+	for (const FRuneMicroBenchmarkResult& result : results)
+	{
+		bool isAlreadyInSet = false;
+		names.Add(result.name, &isAlreadyInSet);
+		TestFalse(FString::Printf(TEXT("%s has a unique name"), *result.name), isAlreadyInSet);
+		TestTrue(FString::Printf(TEXT("%s has a time"), *result.name), result.nsPerOp >= 0.0);
+		TestTrue(FString::Printf(TEXT("%s has an allocation count"), *result.name), result.allocsPerOp >= 0.0);
+	}
+
+	if (!hasBaseline)
+	{
+		AddWarning(TEXT("No baseline set in rune.Benchmark.Micro.Baseline, results are not compared."));
+		return true;
+	}
+
+	const double threshold = CVarRuneMicroBenchmarksThreshold.GetValueOnGameThread();
+	for (const FRuneMicroBenchmarkResult& result : results)
+	{
+		if (!baseline.ContainsByPredicate([&result](const FRuneMicroBenchmarkResult& baselineResult) { return baselineResult.name == result.name; }))
+		{
+			AddWarning(FString::Printf(TEXT("%s is missing from the baseline, it is not compared."), *result.name));
+			continue;
+		}
+
+		TestEqual(FString::Printf(TEXT("%s does not regress over the baseline"), *result.name), FRuneMicroBenchmarks::CompareWithBaseline(MakeArrayView(&result, 1), baseline, threshold), 0);
+	}
+
+	return true;
+}
+
+#endif
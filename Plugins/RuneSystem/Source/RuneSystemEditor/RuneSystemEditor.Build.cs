@@ -10,7 +10,7 @@ public class RuneSystemEditor : ModuleRules
 	
 		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore" });
 
-		PrivateDependencyModuleNames.AddRange(new string[] { "RuneSystem", "UnrealEd", "Slate", "SlateCore", "PropertyEditor", "EditorStyle" });
+		PrivateDependencyModuleNames.AddRange(new string[] { "RuneSystem", "UnrealEd", "Slate", "SlateCore", "PropertyEditor", "EditorStyle", "Json", "JsonUtilities" });
 
 		PrivateIncludePaths.Add( "RuneSystemEditor" );
 
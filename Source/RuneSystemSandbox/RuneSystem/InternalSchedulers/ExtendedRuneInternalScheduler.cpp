@@ -7,61 +7,35 @@
 
 bool UExtendedRuneInternalScheduler::ScheduledRuneConfig(const URuneTask* activeRuneTask)
 {
+	using FTaskValueHandler = bool (UExtendedRuneInternalScheduler::*)();
+
+	// base and user defined task values share a single table, built at compile time
+	static constexpr auto handlers = TExtendedEnumDispatchTable<ERuneTaskValue, FTaskValueHandler>(&UExtendedRuneInternalScheduler::KeepRuneConfig)
+		.With<ERuneTaskValue::HOLD>(&UExtendedRuneInternalScheduler::HoldRuneConfig)
+		.With<ERuneTaskValue::FAILURE>(&UExtendedRuneInternalScheduler::ResetRuneConfig)
+		.With<ERuneTaskValue::SUCCESS>(&UExtendedRuneInternalScheduler::NextRuneConfig)
+		.With<EUserDefinedRuneTaskReturnValue::SECOND>(&UExtendedRuneInternalScheduler::HoldRuneConfig)
+		.With<EUserDefinedRuneTaskReturnValue::THIRD>(&UExtendedRuneInternalScheduler::ResetRuneConfig)
+		.With<EUserDefinedRuneTaskReturnValue::FOURTH>(&UExtendedRuneInternalScheduler::NextRuneConfig);
+
 	bool shouldScheduleTick = IsValid();
 
 	if (shouldScheduleTick && activeRuneTask != nullptr)
 	{
-		switch (activeRuneTask->GetTaskValue())
-		{
-		case ERuneTaskValue::RUNNING:
-			break;
-		case ERuneTaskValue::HOLD:
-			shouldScheduleTick = false;
-			break;
-		case ERuneTaskValue::FAILURE:
-			scheduledRuneConfigIndex = 0;
-			break;
-		case ERuneTaskValue::SUCCESS:
-			scheduledRuneConfigIndex++;
-			scheduledRuneConfigIndex %= maxRuneConfigIndex;
-			break;
-		default:
-			break;
-		}
-#if 1
-		if (activeRuneTask->taskValue == EUserDefinedRuneTaskReturnValue::SECOND)
-		{
-			shouldScheduleTick = false;
-		}
-		else if (activeRuneTask->taskValue == EUserDefinedRuneTaskReturnValue::THIRD)
-		{
-			scheduledRuneConfigIndex = 0;
-		}
-		else if (activeRuneTask->taskValue == EUserDefinedRuneTaskReturnValue::FOURTH)
-		{
-			scheduledRuneConfigIndex++;
-			scheduledRuneConfigIndex %= maxRuneConfigIndex;
-		}
-#else
-		switch (activeRuneTask->taskValue.Get<EUserDefinedRuneTaskReturnValue>())
-		{
-		case EUserDefinedRuneTaskReturnValue::FIRST:
-			break;
-		case EUserDefinedRuneTaskReturnValue::SECOND:
-			shouldScheduleTick = false;
-			break;
-		case EUserDefinedRuneTaskReturnValue::THIRD:
-			scheduledRuneConfigIndex = 0;
-			break;
-		case  EUserDefinedRuneTaskReturnValue::FOURTH:
-			scheduledRuneConfigIndex++;
-			scheduledRuneConfigIndex %= maxRuneConfigIndex;
-			break;
-		default:
-			break;
-		}
-#endif
-
+		shouldScheduleTick = (this->*handlers[activeRuneTask->taskValue])();
 	}
 	return shouldScheduleTick;
 }
+
+bool UExtendedRuneInternalScheduler::ResetRuneConfig()
+{
+	scheduledRuneConfigIndex = 0;
+	return true;
+}
+
+bool UExtendedRuneInternalScheduler::NextRuneConfig()
+{
+	scheduledRuneConfigIndex++;
+	scheduledRuneConfigIndex %= maxRuneConfigIndex;
+	return true;
+}
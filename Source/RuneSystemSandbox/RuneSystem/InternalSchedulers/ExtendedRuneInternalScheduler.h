@@ -16,4 +16,16 @@ class RUNESYSTEMSANDBOX_API UExtendedRuneInternalScheduler : public URuneInterna
 
 	virtual bool ScheduledRuneConfig(const URuneTask* activeRuneTask) override;
 
+	/** Keeps ticking the scheduled configuration */
+	bool KeepRuneConfig() { return true; };
+
+	/** Does not tick the scheduled configuration */
+	bool HoldRuneConfig() { return false; };
+
+	/** Goes back to the first configuration */
+	bool ResetRuneConfig();
+
+	/** Goes to the next configuration, wrapping around after the last one */
+	bool NextRuneConfig();
+
 };